@@ -34,7 +34,8 @@ public class Clock: Applet
     private Interval exp_interval;
     private int exp_count;
     private string? prev_clock_val;
-    private uint timer;
+    private uint task;
+    private uint task_period;
     private Window calendar;
     internal string clock_format {get; set;}
     internal string tooltip_format {get; set;}
@@ -65,12 +66,10 @@ public class Clock: Applet
                 style_set_class(clock,get_css(),"-vala-panel-font-weight",false);
             else
             {
-                if (timer != 0) Source.remove(timer);
                 prev_clock_val = null;
                 exp_count = 0;
                 exp_interval = Interval.AWAITING_FIRST_CHANGE;
-                DateTime now = new DateTime.now_local();
-                timer_set(now);
+                timer_set();
                 if (calendar != null)
                 {
                     calendar.destroy();
@@ -78,10 +77,28 @@ public class Clock: Applet
                 }
             }
         });
+        toplevel.notify["visibility"].connect(on_visibility_changed);
         clock.show();
         this.add(clock);
         this.show();
     }
+    public override void dispose()
+    {
+        toplevel.notify["visibility"].disconnect(on_visibility_changed);
+        if (task != 0)
+            Scheduler.get_default().remove(task);
+        task = 0;
+        base.dispose();
+    }
+    /* Nobody reads the clock on a hidden panel. Stop ticking, and show
+     * the current time at once when the panel comes back. */
+    private void on_visibility_changed()
+    {
+        if (toplevel.visibility == ValaPanel.Visibility.VISIBLE)
+            update_display();
+        else
+            timer_set();
+    }
     public override Widget get_settings_ui()
     {
         string[] names = {
@@ -194,18 +211,12 @@ public class Clock: Applet
         /* Return the widget. */
         return win;
     }
-    /* Periodic timer callback.
-     * Also used during initialization and configuration change to do a redraw. */
-    private bool update_display()
+    /* Periodic scheduler callback. */
+    private void update_display()
     {
         /* Determine the current time. */
         var now = new DateTime.now_local();
 
-        if (MainContext.current_source().is_destroyed())
-            return false;
-
-        timer_set(now);
-
         /* Determine the content of the clock label and tooltip. */
         string label = now.format(clock_format);
         string tooltip = now.format(tooltip_format);
@@ -252,26 +263,29 @@ public class Clock: Applet
             }
         }
 
-        /* Reset the timer and return. */
-        return false;
+        /* Reset the timer if the experiment changed the interval. */
+        timer_set();
     }
-    /* Set the timer. */
-    private void timer_set(DateTime current_time)
+    /* Set the timer. The scheduler runs it on second or minute boundaries,
+     * together with other periodic work of the panel. */
+    private void timer_set()
     {
-        uint microseconds = 1000000;
-        /* Compute number of microseconds until next second boundary. */
-        microseconds = 1000000 - (current_time.get_microsecond());
-        /* If the expiration interval is the minute boundary,
-        * add number of milliseconds after that until next minute boundary. */
-        if (exp_interval == Interval.ONE_MINUTE)
+        if (toplevel.visibility != ValaPanel.Visibility.VISIBLE)
         {
-            uint seconds = 60 - current_time.get_second();
-            microseconds += seconds * 1000000;
+            if (task != 0)
+                Scheduler.get_default().remove(task);
+            task = 0;
+            return;
         }
-        /* Be defensive, and set the timer. */
-        if (microseconds <= 0)
-            microseconds = 1000000;
-        timer = Timeout.add(microseconds/1000,update_display);
+        uint period = (exp_interval == Interval.ONE_MINUTE) ? 60 : 1;
+        if (task != 0 && period == task_period)
+            return;
+        if (task != 0)
+            Scheduler.get_default().remove(task);
+        task_period = period;
+        /* No tolerance: the display has to flip on the boundary itself,
+         * tolerant tasks like the sampler join this wakeup instead. */
+        task = Scheduler.get_default().add(period, 0, update_display);
     }
 } // End class
 
@@ -26,235 +26,196 @@
 
 #include "cpu.h"
 
-#define BORDER_SIZE 2
+#define PER_CORE "per-core"
+#define FAST_SAMPLING "fast-sampling"
 
-typedef struct
-{                                          /* Value from /proc/stat */
-	long long unsigned int u, n, s, i; /* User, nice, system, idle */
-} cpu_stat;
+/* Empty color follows the theme */
+static const char *state_colors[VALA_PANEL_CPU_N_STATES] = {
+	"user-color", "nice-color",  "system-color",
+	"irq-color",  "steal-color", "iowait-color",
+};
+
+static const char *state_names[VALA_PANEL_CPU_N_STATES] = {
+	N_("User"), N_("Nice"), N_("System"), N_("Interrupts"), N_("Steal"), N_("I/O wait"),
+};
 
 /* Private context for CPU applet. */
 struct _CpuApplet
 {
 	ValaPanelApplet parent;
-	GdkRGBA foreground_color; /* Foreground color for drawing area */
-	cairo_surface_t *pixmap;  /* Pixmap to be drawn on drawing area */
-
-	uint timer;       /* Timer for periodic update */
-	float *stats_cpu; /* Ring buffer of CPU utilization values as saved CPU utilization value as
-	                       0.0..1.0*/
-	uint ring_cursor; /* Cursor for ring buffer */
-	uint pixmap_width;  /* Width of drawing area pixmap; also size of ring buffer; does not
-	                       include border size */
-	uint pixmap_height; /* Height of drawing area pixmap; does not include border size */
-	cpu_stat previous_cpu_stat; /* Previous value of cpu_stat */
+	ValaPanelGraph *graph;                /* Stacked history of CPU states as 0.0..1.0 */
+	uint sampler_id;                      /* Subscription to shared sampler */
+	ValaPanelCpuSample previous_cpu_stat; /* Previous value of CPU sample */
+	bool per_core;                        /* Heatmap with a row per core */
+	bool fast;                            /* Sample ten times per second, draw envelope */
+	ValaPanelCpuSample *previous_cores;   /* Previous samples of every core */
+	double *core_values;                  /* Column of heatmap, reused between ticks */
+	uint n_cores;                         /* Rows of heatmap */
 };
 
-#define cpu_applet_from_da(da) VALA_PANEL_CPU_APPLET(gtk_widget_get_parent(GTK_WIDGET(da)))
-#define cpu_applet_get_da(p) GTK_DRAWING_AREA(gtk_bin_get_child(GTK_BIN(p)))
-
 G_DEFINE_DYNAMIC_TYPE(CpuApplet, cpu_applet, vala_panel_applet_get_type())
 
-/* Redraw after timer callback or resize. */
-static void redraw_pixmap(CpuApplet *c)
-{
-	cairo_t *cr              = cairo_create(c->pixmap);
-	GtkStyleContext *context = gtk_widget_get_style_context(GTK_WIDGET(c));
-	GtkStateFlags flags      = gtk_widget_get_state_flags(GTK_WIDGET(c));
-	g_autoptr(GdkRGBA) background_color;
-	gtk_style_context_get(context,
-	                      flags,
-	                      GTK_STYLE_PROPERTY_BACKGROUND_COLOR,
-	                      &background_color,
-	                      NULL);
-	cairo_set_line_width(cr, 1.0);
-	/* Erase pixmap. */
-	cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
-	cairo_rectangle(cr, 0, 0, c->pixmap_width, c->pixmap_height);
-	gdk_cairo_set_source_rgba(cr, background_color);
-	cairo_fill(cr);
+static void cpu_rebuild_graph(CpuApplet *c, uint n_series);
 
-	/* Recompute pixmap. */
-	uint i;
-	uint drawing_cursor = c->ring_cursor;
-	gdk_cairo_set_source_rgba(cr, &c->foreground_color);
-	for (i = 0; i < c->pixmap_width; i++)
+/*
+ * Per-core mode: one pass over all cores, without allocation while their count is stable.
+ * Returns whether graph got a new column.
+ */
+static bool cpu_update_cores(CpuApplet *c, const ValaPanelSnapshot *snapshot)
+{
+	if (snapshot->n_cores != c->n_cores)
 	{
-		/* Draw one bar of the CPU usage graph. */
-		if (c->stats_cpu[drawing_cursor] != 0.0)
-		{
-			cairo_move_to(cr, i + 0.5, c->pixmap_height);
-			cairo_line_to(cr,
-			              i + 0.5,
-			              c->pixmap_height -
-			                  c->stats_cpu[drawing_cursor] * c->pixmap_height);
-			cairo_stroke(cr);
-		}
-
-		/* Increment and wrap drawing cursor. */
-		drawing_cursor += 1;
-		if (drawing_cursor >= c->pixmap_width)
-			drawing_cursor = 0;
+		/* Cores went online or offline, start over with a heatmap of right height */
+		c->n_cores        = snapshot->n_cores;
+		c->previous_cores = g_renew(ValaPanelCpuSample, c->previous_cores, c->n_cores);
+		c->core_values    = g_renew(double, c->core_values, c->n_cores);
+		memcpy(c->previous_cores, snapshot->cores, c->n_cores * sizeof(ValaPanelCpuSample));
+		cpu_rebuild_graph(c, c->n_cores);
+		return true;
 	}
-
-	/* check_cairo_status(cr); */
-	cairo_destroy(cr);
-
-	/* Redraw pixmap. */
-	gtk_widget_queue_draw(GTK_WIDGET(cpu_applet_get_da(c)));
+	for (uint i = 0; i < c->n_cores; i++)
+		c->core_values[i] =
+		    vala_panel_cpu_sample_load(&snapshot->cores[i], &c->previous_cores[i], NULL);
+	memcpy(c->previous_cores, snapshot->cores, c->n_cores * sizeof(ValaPanelCpuSample));
+	return vala_panel_graph_push_at(c->graph, c->core_values, snapshot->time);
 }
 
-/* Periodic timer callback. */
-static int cpu_update(CpuApplet *c)
+static void cpu_update_tooltip(CpuApplet *c, double load, const double *states)
 {
-	if (g_source_is_destroyed(g_main_current_source()))
-		return false;
-	if ((c->stats_cpu != NULL) && (c->pixmap != NULL))
-	{
-		/* Open statistics file and scan out CPU usage. */
-		cpu_stat cpu;
-		FILE *stat = fopen("/proc/stat", "r");
-		if (stat == NULL)
-			return true;
-		int fscanf_result =
-		    fscanf(stat, "cpu %llu %llu %llu %llu", &cpu.u, &cpu.n, &cpu.s, &cpu.i);
-		fclose(stat);
-
-		/* Ensure that fscanf succeeded. */
-		if (fscanf_result == 4)
-		{
-			/* Compute delta from previous statistics. */
-			cpu_stat cpu_delta;
-			cpu_delta.u = cpu.u - c->previous_cpu_stat.u;
-			cpu_delta.n = cpu.n - c->previous_cpu_stat.n;
-			cpu_delta.s = cpu.s - c->previous_cpu_stat.s;
-			cpu_delta.i = cpu.i - c->previous_cpu_stat.i;
-
-			/* Copy current to previous. */
-			memcpy(&c->previous_cpu_stat, &cpu, sizeof(cpu_stat));
+	g_autoptr(GString) text = g_string_new(NULL);
+	g_string_printf(text, _("CPU usage: %.1f%%"), load * 100);
+	for (uint i = 0; i < VALA_PANEL_CPU_N_STATES; i++)
+		g_string_append_printf(text, "\n%s: %.1f%%", _(state_names[i]), states[i] * 100);
+	gtk_widget_set_tooltip_text(GTK_WIDGET(c->graph), text->str);
+}
 
-			/* Compute user+nice+system as a fraction of total.
-			 * Introduce this sample to ring buffer, increment and wrap ring buffer
-			 * cursor. */
-			float cpu_uns                = cpu_delta.u + cpu_delta.n + cpu_delta.s;
-			c->stats_cpu[c->ring_cursor] = cpu_uns / (cpu_uns + cpu_delta.i);
-			c->ring_cursor += 1;
-			if (c->ring_cursor >= c->pixmap_width)
-				c->ring_cursor = 0;
+/* Periodic sampler callback. */
+static void cpu_update(const ValaPanelSnapshot *snapshot, void *data)
+{
+	CpuApplet *c = VALA_PANEL_CPU_APPLET(data);
+	if (!(snapshot->valid & VALA_PANEL_SAMPLE_CPU))
+		return;
+
+	/* Compute share of every state and add them to graph. */
+	double states[VALA_PANEL_CPU_N_STATES];
+	double load = vala_panel_cpu_sample_load(&snapshot->cpu, &c->previous_cpu_stat, states);
+	bool column = false;
+	/* Copy current to previous. */
+	memcpy(&c->previous_cpu_stat, &snapshot->cpu, sizeof(ValaPanelCpuSample));
+	if (c->per_core && (snapshot->valid & VALA_PANEL_SAMPLE_CPU_CORES))
+		column = cpu_update_cores(c, snapshot);
+	else if (!c->per_core)
+		column = vala_panel_graph_push_at(c->graph, states, snapshot->time);
+	/* Last, as cpu_update_cores() may have replaced the graph. With fast
+	 * sampling, tooltip is set once per column, not on every sample. */
+	if (column)
+		cpu_update_tooltip(c, load, states);
+}
 
-			/* Redraw with the new sample. */
-			redraw_pixmap(c);
-		}
-	}
-	return G_SOURCE_CONTINUE;
+static void on_visibility_change(GObject *owner, G_GNUC_UNUSED GParamSpec *pspec, void *data)
+{
+	CpuApplet *self = VALA_PANEL_CPU_APPLET(data);
+	vala_panel_sampler_follow_visibility(vala_panel_sampler_get_default(),
+	                                     self->sampler_id,
+	                                     VALA_PANEL_TOPLEVEL(owner));
 }
 
-/* Handler for configure_event on drawing area. */
-static bool configure_event(GtkWidget *widget, G_GNUC_UNUSED GdkEventConfigure *event, CpuApplet *c)
+static void on_height_change(GObject *owner, G_GNUC_UNUSED GParamSpec *pspec, void *data)
 {
-	GtkAllocation allocation;
+	CpuApplet *c = VALA_PANEL_CPU_APPLET(data);
+	uint height;
+	g_object_get(owner, VALA_PANEL_KEY_HEIGHT, &height, NULL);
+	gtk_widget_set_size_request(GTK_WIDGET(c->graph), height > 40 ? height : 40, height);
+}
 
-	gtk_widget_get_allocation(widget, &allocation);
-	/* Allocate pixmap and statistics buffer without border pixels. */
-	uint new_pixmap_width  = (uint)MAX(allocation.width - BORDER_SIZE * 2, 0);
-	uint new_pixmap_height = (uint)MAX(allocation.height - BORDER_SIZE * 2, 0);
-	if ((new_pixmap_width > 0) && (new_pixmap_height > 0))
+static void cpu_apply_colors(CpuApplet *c)
+{
+	GSettings *settings         = vala_panel_applet_get_settings(VALA_PANEL_APPLET(c));
+	ValaPanelToplevel *toplevel = vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(c));
+	GtkStyleContext *context    = gtk_widget_get_style_context(GTK_WIDGET(toplevel));
+	GtkStateFlags flags         = gtk_widget_get_state_flags(GTK_WIDGET(toplevel));
+	GdkRGBA foreground_color;
+	gtk_style_context_get_color(context, flags, &foreground_color);
+	/* Heatmap is drawn with the color of user time */
+	uint n_series = c->per_core ? 1 : VALA_PANEL_CPU_N_STATES;
+	for (uint i = 0; i < n_series; i++)
 	{
-		/* If statistics buffer does not exist or it changed size, reallocate and preserve
-		 * existing data. */
-		if ((c->stats_cpu == NULL) || (new_pixmap_width != c->pixmap_width))
-		{
-			float *new_stats_cpu = g_new0(float, new_pixmap_width);
-			if (c->stats_cpu != NULL)
-			{
-				if (new_pixmap_width > c->pixmap_width)
-				{
-					/* New allocation is larger.
-					 * Introduce new "oldest" samples of zero following the
-					 * cursor. */
-					memcpy(&new_stats_cpu[0],
-					       &c->stats_cpu[0],
-					       c->ring_cursor * sizeof(float));
-					memcpy(&new_stats_cpu[new_pixmap_width - c->pixmap_width +
-					                      c->ring_cursor],
-					       &c->stats_cpu[c->ring_cursor],
-					       (c->pixmap_width - c->ring_cursor) * sizeof(float));
-				}
-				else if (c->ring_cursor <= new_pixmap_width)
-				{
-					/* New allocation is smaller, but still larger than the ring
-					 * buffer cursor.
-					 * Discard the oldest samples following the cursor. */
-					memcpy(&new_stats_cpu[0],
-					       &c->stats_cpu[0],
-					       c->ring_cursor * sizeof(float));
-					memcpy(&new_stats_cpu[c->ring_cursor],
-					       &c->stats_cpu[c->pixmap_width - new_pixmap_width +
-					                     c->ring_cursor],
-					       (new_pixmap_width - c->ring_cursor) * sizeof(float));
-				}
-				else
-				{
-					/* New allocation is smaller, and also smaller than the ring
-					 * buffer cursor.
-					 * Discard all oldest samples following the ring buffer
-					 * cursor and additional samples at the beginning of the
-					 * buffer. */
-					memcpy(&new_stats_cpu[0],
-					       &c->stats_cpu[c->ring_cursor - new_pixmap_width],
-					       new_pixmap_width * sizeof(float));
-					c->ring_cursor = 0;
-				}
-				g_free(c->stats_cpu);
-			}
-			c->stats_cpu = new_stats_cpu;
-		}
-
-		/* Allocate or reallocate pixmap. */
-		c->pixmap_width  = new_pixmap_width;
-		c->pixmap_height = new_pixmap_height;
-		if (c->pixmap)
-			cairo_surface_destroy(c->pixmap);
-		c->pixmap = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
-		                                       c->pixmap_width,
-		                                       c->pixmap_height);
-		/* check_cairo_surface_status(&c->pixmap); */
-
-		/* Redraw pixmap at the new size. */
-		redraw_pixmap(c);
+		g_autofree char *spec = g_settings_get_string(settings, state_colors[i]);
+		GdkRGBA color;
+		if (!gdk_rgba_parse(&color, spec))
+			color = foreground_color;
+		vala_panel_graph_set_color(c->graph, i, &color);
 	}
-	return true;
 }
 
-/* Handler for draw on drawing area. */
-static bool draw(G_GNUC_UNUSED GtkWidget *widget, cairo_t *cr, CpuApplet *c)
+/* Graph is recreated for a different number of series, which is construct-only */
+static void cpu_rebuild_graph(CpuApplet *c, uint n_series)
 {
-	/* Draw the requested part of the pixmap onto the drawing area.
-	 * Translate it in both x and y by the border size. */
-	if (c->pixmap != NULL)
+	ValaPanelToplevel *toplevel = vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(c));
+	if (c->graph != NULL)
+		gtk_widget_destroy(GTK_WIDGET(c->graph));
+	/* Allocate graph as a child of top level widget. */
+	c->graph = vala_panel_graph_new(n_series);
+	gtk_widget_add_events(GTK_WIDGET(c->graph),
+	                      GDK_BUTTON_PRESS_MASK | GDK_BUTTON_RELEASE_MASK |
+	                          GDK_BUTTON_MOTION_MASK);
+	on_height_change(G_OBJECT(toplevel), NULL, c);
+	gtk_container_add(GTK_CONTAINER(c), GTK_WIDGET(c->graph));
+	cpu_apply_colors(c);
+	/* Heatmap already shows the hottest core, an envelope would not fit into its rows */
+	vala_panel_graph_set_envelope(c->graph, c->fast && !c->per_core);
+	if (c->per_core)
 	{
-		GtkStyleContext *context = gtk_widget_get_style_context(GTK_WIDGET(c));
-		GtkStateFlags flags      = gtk_widget_get_state_flags(GTK_WIDGET(c));
-		g_autoptr(GdkRGBA) background_color;
-		gtk_style_context_get(context,
-		                      flags,
-		                      GTK_STYLE_PROPERTY_BACKGROUND_COLOR,
-		                      &background_color,
-		                      NULL);
-		gdk_cairo_set_source_rgba(cr, background_color);
-		cairo_set_source_surface(cr, c->pixmap, BORDER_SIZE, BORDER_SIZE);
-		cairo_paint(cr);
-		/* check_cairo_status(cr); */
+		/* No history here: a file per core would be hundreds of megabytes on big hosts */
+		vala_panel_graph_set_style(c->graph, VALA_PANEL_GRAPH_HEATMAP);
 	}
-	return false;
+	else
+	{
+		vala_panel_graph_set_style(c->graph, VALA_PANEL_GRAPH_STACKED);
+		/* Keep history across panel restarts, scrolling over graph changes time scale */
+		const char *uuid         = vala_panel_applet_get_uuid(VALA_PANEL_APPLET(c));
+		g_autofree char *history = g_strdup_printf("%s-cpu", uuid);
+		vala_panel_graph_set_history(c->graph, history);
+	}
+	gtk_widget_show(GTK_WIDGET(c->graph));
 }
 
-static void on_height_change(GObject *owner, G_GNUC_UNUSED GParamSpec *pspec, void *data)
+/* Subscribe to the sampler to refresh the statistics. */
+static void cpu_resubscribe(CpuApplet *c)
 {
-	GtkWidget *da = GTK_WIDGET(data);
-	uint height;
-	g_object_get(owner, VALA_PANEL_KEY_HEIGHT, &height, NULL);
-	gtk_widget_set_size_request(da, height > 40 ? height : 40, height);
+	ValaPanelSampler *sampler = vala_panel_sampler_get_default();
+	if (c->sampler_id)
+		vala_panel_sampler_unsubscribe(sampler, c->sampler_id);
+	c->sampler_id =
+	    vala_panel_sampler_subscribe(sampler,
+	                                 c->per_core ? VALA_PANEL_SAMPLE_CPU_CORES
+	                                             : VALA_PANEL_SAMPLE_CPU,
+	                                 cpu_update,
+	                                 c);
+	vala_panel_sampler_set_fast(sampler, c->sampler_id, c->fast);
+	on_visibility_change(G_OBJECT(vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(c))),
+	                     NULL,
+	                     c);
+}
+
+static void on_settings_changed(GSettings *settings, char *key, gpointer user_data)
+{
+	CpuApplet *c = VALA_PANEL_CPU_APPLET(user_data);
+	if (!g_strcmp0(key, PER_CORE))
+	{
+		c->per_core = g_settings_get_boolean(settings, PER_CORE);
+		c->n_cores  = 0;
+		cpu_rebuild_graph(c, c->per_core ? 1 : VALA_PANEL_CPU_N_STATES);
+		cpu_resubscribe(c);
+	}
+	else if (!g_strcmp0(key, FAST_SAMPLING))
+	{
+		c->fast = g_settings_get_boolean(settings, FAST_SAMPLING);
+		vala_panel_graph_set_envelope(c->graph, c->fast && !c->per_core);
+		cpu_resubscribe(c);
+	}
+	else if (g_str_has_suffix(key, "-color"))
+		cpu_apply_colors(c);
 }
 
 static void cpu_applet_constructed(GObject *obj)
@@ -262,44 +223,77 @@ static void cpu_applet_constructed(GObject *obj)
 	G_OBJECT_CLASS(cpu_applet_parent_class)->constructed(obj);
 	CpuApplet *c                = VALA_PANEL_CPU_APPLET(obj);
 	ValaPanelToplevel *toplevel = vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(c));
-	/* Allocate drawing area as a child of top level widget. */
-	GtkDrawingArea *da = GTK_DRAWING_AREA(gtk_drawing_area_new());
-	gtk_widget_add_events(GTK_WIDGET(da),
-	                      GDK_BUTTON_PRESS_MASK | GDK_BUTTON_RELEASE_MASK |
-	                          GDK_BUTTON_MOTION_MASK);
-	on_height_change(G_OBJECT(toplevel), NULL, da);
-	gtk_container_add(GTK_CONTAINER(c), GTK_WIDGET(da));
-	GtkStyleContext *context = gtk_widget_get_style_context(GTK_WIDGET(toplevel));
-	GtkStateFlags flags      = gtk_widget_get_state_flags(GTK_WIDGET(toplevel));
-	gtk_style_context_get_color(context, flags, &c->foreground_color);
+	GSettings *settings         = vala_panel_applet_get_settings(VALA_PANEL_APPLET(c));
+	GActionMap *map = G_ACTION_MAP(vala_panel_applet_get_action_group(VALA_PANEL_APPLET(c)));
+	g_simple_action_set_enabled(
+	    G_SIMPLE_ACTION(g_action_map_lookup_action(map, VALA_PANEL_APPLET_ACTION_CONFIGURE)),
+	    true);
+	c->per_core = g_settings_get_boolean(settings, PER_CORE);
+	c->fast     = g_settings_get_boolean(settings, FAST_SAMPLING);
+	/* Heatmap gets its rows with the first sample */
+	cpu_rebuild_graph(c, c->per_core ? 1 : VALA_PANEL_CPU_N_STATES);
 
 	/* Connect signals. */
 	g_signal_connect(G_OBJECT(toplevel),
 	                 "notify::" VALA_PANEL_KEY_HEIGHT,
 	                 G_CALLBACK(on_height_change),
-	                 (gpointer)da);
-	g_signal_connect(G_OBJECT(da), "configure-event", G_CALLBACK(configure_event), (gpointer)c);
-	g_signal_connect(G_OBJECT(da), "draw", G_CALLBACK(draw), (gpointer)c);
-	/* Show the widget.  Connect a timer to refresh the statistics. */
-	gtk_widget_show(GTK_WIDGET(da));
-	c->timer = g_timeout_add(1500, (GSourceFunc)cpu_update, (gpointer)c);
+	                 c);
+	g_signal_connect(G_OBJECT(toplevel),
+	                 "notify::" VALA_PANEL_KEY_VISIBILITY,
+	                 G_CALLBACK(on_visibility_change),
+	                 c);
+	g_signal_connect(settings, "changed", G_CALLBACK(on_settings_changed), c);
+	/* Show the widget. */
+	cpu_resubscribe(c);
 	gtk_widget_show(GTK_WIDGET(c));
 }
 
+static GtkWidget *cpu_get_settings_ui(ValaPanelApplet *base)
+{
+	return vala_panel_generic_cfg_widgetv(vala_panel_applet_get_settings(base),
+	                                      _("Show every core as a heatmap row"),
+	                                      PER_CORE,
+	                                      CONF_BOOL,
+	                                      _("Sample ten times per second, showing bursts"),
+	                                      FAST_SAMPLING,
+	                                      CONF_BOOL,
+	                                      _("User color"),
+	                                      state_colors[VALA_PANEL_CPU_USER],
+	                                      CONF_STR,
+	                                      _("Nice color"),
+	                                      state_colors[VALA_PANEL_CPU_NICE],
+	                                      CONF_STR,
+	                                      _("System color"),
+	                                      state_colors[VALA_PANEL_CPU_SYSTEM],
+	                                      CONF_STR,
+	                                      _("Interrupts color"),
+	                                      state_colors[VALA_PANEL_CPU_IRQ],
+	                                      CONF_STR,
+	                                      _("Steal color"),
+	                                      state_colors[VALA_PANEL_CPU_STEAL],
+	                                      CONF_STR,
+	                                      _("I/O wait color"),
+	                                      state_colors[VALA_PANEL_CPU_IOWAIT],
+	                                      CONF_STR,
+	                                      NULL);
+}
+
 /* Plugin destructor. */
 static void cpu_applet_dispose(GObject *user_data)
 {
-	CpuApplet *c = VALA_PANEL_CPU_APPLET(user_data);
-	/* Disconnect the timer. */
-	if (c->timer)
+	CpuApplet *c                = VALA_PANEL_CPU_APPLET(user_data);
+	ValaPanelToplevel *toplevel = vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(c));
+	g_signal_handlers_disconnect_by_data(toplevel, c);
+	g_signal_handlers_disconnect_by_data(vala_panel_applet_get_settings(VALA_PANEL_APPLET(c)),
+	                                     c);
+	/* Disconnect from the sampler. */
+	if (c->sampler_id)
 	{
-		g_source_remove(c->timer);
-		c->timer = 0;
+		vala_panel_sampler_unsubscribe(vala_panel_sampler_get_default(), c->sampler_id);
+		c->sampler_id = 0;
 	}
-
-	/* Deallocate memory. */
-	g_clear_pointer(&c->pixmap, cairo_surface_destroy);
-	g_clear_pointer(&c->stats_cpu, g_free);
+	g_clear_pointer(&c->previous_cores, g_free);
+	g_clear_pointer(&c->core_values, g_free);
 	G_OBJECT_CLASS(cpu_applet_parent_class)->dispose(user_data);
 }
 
@@ -309,8 +303,9 @@ static void cpu_applet_init(G_GNUC_UNUSED CpuApplet *self)
 
 static void cpu_applet_class_init(CpuAppletClass *klass)
 {
-	G_OBJECT_CLASS(klass)->constructed = cpu_applet_constructed;
-	G_OBJECT_CLASS(klass)->dispose     = cpu_applet_dispose;
+	G_OBJECT_CLASS(klass)->constructed              = cpu_applet_constructed;
+	G_OBJECT_CLASS(klass)->dispose                  = cpu_applet_dispose;
+	VALA_PANEL_APPLET_CLASS(klass)->get_settings_ui = cpu_get_settings_ui;
 }
 
 static void cpu_applet_class_finalize(G_GNUC_UNUSED CpuAppletClass *klass)
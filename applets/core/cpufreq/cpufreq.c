@@ -0,0 +1,343 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib/gi18n.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cpufreq.h"
+
+#define PER_CORE "per-core"
+#define FAST_SAMPLING "fast-sampling"
+#define CLOCK_COLOR "clock-color"
+#define TEMPERATURE_COLOR "temperature-color"
+
+/* Lines of the graph, both as shares of their limits */
+enum
+{
+	CPUFREQ_CLOCK       = 0, /* Average clock over maximum clock */
+	CPUFREQ_TEMPERATURE = 1, /* Hottest sensor over its critical temperature */
+	CPUFREQ_N_SERIES
+};
+
+/* Empty color follows the theme */
+static const char *series_colors[CPUFREQ_N_SERIES] = { CLOCK_COLOR, TEMPERATURE_COLOR };
+
+/* Private context for CPU frequency applet. */
+struct _CpufreqApplet
+{
+	ValaPanelApplet parent;
+	ValaPanelGraph *graph; /* History of clock and temperature as 0.0..1.0 */
+	uint sampler_id;       /* Subscription to shared sampler */
+	bool per_core;         /* Heatmap of clocks with a row per core */
+	bool fast;             /* Sample ten times per second, draw envelope */
+	double *core_values;   /* Column of heatmap, reused between ticks */
+	uint n_cores;          /* Rows of heatmap */
+};
+
+G_DEFINE_DYNAMIC_TYPE(CpufreqApplet, cpufreq_applet, vala_panel_applet_get_type())
+
+static void cpufreq_rebuild_graph(CpufreqApplet *c, uint n_series);
+
+static inline double cpufreq_share(const ValaPanelFreqSample *freq)
+{
+	return freq->max_khz > 0 ? MIN((double)freq->khz / freq->max_khz, 1.0) : 0.0;
+}
+
+/* Cores without cpufreq are left out of the average, not counted as idle */
+static double cpufreq_average(const ValaPanelSnapshot *snapshot, guint64 *khz)
+{
+	guint64 sum = 0, max_sum = 0;
+	uint n      = 0;
+	for (uint i = 0; i < snapshot->n_freqs; i++)
+	{
+		if (snapshot->freqs[i].max_khz == 0)
+			continue;
+		sum += snapshot->freqs[i].khz;
+		max_sum += snapshot->freqs[i].max_khz;
+		n++;
+	}
+	*khz = n > 0 ? sum / n : 0;
+	return max_sum > 0 ? MIN((double)sum / max_sum, 1.0) : 0.0;
+}
+
+static double cpufreq_hottest(const ValaPanelSnapshot *snapshot)
+{
+	double hottest = 0.0;
+	for (uint i = 0; i < snapshot->n_temps; i++)
+		hottest = MAX(hottest, snapshot->temps[i].celsius / snapshot->temps[i].critical);
+	return CLAMP(hottest, 0.0, 1.0);
+}
+
+/* Per-core mode: returns whether graph got a new column */
+static bool cpufreq_update_cores(CpufreqApplet *c, const ValaPanelSnapshot *snapshot)
+{
+	if (snapshot->n_freqs != c->n_cores)
+	{
+		/* Cores were hotplugged, start over with a heatmap of right height */
+		c->n_cores     = snapshot->n_freqs;
+		c->core_values = g_renew(double, c->core_values, c->n_cores);
+		cpufreq_rebuild_graph(c, MAX(c->n_cores, 1));
+	}
+	for (uint i = 0; i < c->n_cores; i++)
+		c->core_values[i] = cpufreq_share(&snapshot->freqs[i]);
+	return c->n_cores > 0 && vala_panel_graph_push_at(c->graph, c->core_values, snapshot->time);
+}
+
+static void cpufreq_update_tooltip(CpufreqApplet *c, const ValaPanelSnapshot *snapshot,
+                                   guint64 khz)
+{
+	g_autoptr(GString) text = g_string_new(NULL);
+	if (snapshot->n_freqs > 0)
+		g_string_printf(text, _("Average clock: %.0f MHz"), khz / 1000.0);
+	for (uint i = 0; i < snapshot->n_freqs; i++)
+	{
+		if (snapshot->freqs[i].max_khz == 0)
+			continue;
+		double mhz = snapshot->freqs[i].khz / 1000.0;
+		g_string_append_c(text, '\n');
+		g_string_append_printf(text, _("CPU %u: %.0f MHz"), i, mhz);
+	}
+	for (uint i = 0; i < snapshot->n_temps; i++)
+		g_string_append_printf(text,
+		                       "%s%s: %.1f °C",
+		                       text->len > 0 ? "\n" : "",
+		                       snapshot->temps[i].label,
+		                       snapshot->temps[i].celsius);
+	gtk_widget_set_tooltip_text(GTK_WIDGET(c->graph), text->str);
+}
+
+/* Periodic sampler callback. */
+static void cpufreq_update(const ValaPanelSnapshot *snapshot, void *data)
+{
+	CpufreqApplet *c = VALA_PANEL_CPUFREQ_APPLET(data);
+	if (!(snapshot->valid & VALA_PANEL_SAMPLE_SENSORS))
+		return;
+
+	double values[CPUFREQ_N_SERIES];
+	guint64 khz;
+	bool column;
+	values[CPUFREQ_CLOCK]       = cpufreq_average(snapshot, &khz);
+	values[CPUFREQ_TEMPERATURE] = cpufreq_hottest(snapshot);
+	if (c->per_core)
+		column = cpufreq_update_cores(c, snapshot);
+	else
+		column = vala_panel_graph_push_at(c->graph, values, snapshot->time);
+	/* With fast sampling, tooltip is set once per column, not on every sample */
+	if (column)
+		cpufreq_update_tooltip(c, snapshot, khz);
+}
+
+static void on_visibility_change(GObject *owner, G_GNUC_UNUSED GParamSpec *pspec, void *data)
+{
+	CpufreqApplet *self = VALA_PANEL_CPUFREQ_APPLET(data);
+	vala_panel_sampler_follow_visibility(vala_panel_sampler_get_default(),
+	                                     self->sampler_id,
+	                                     VALA_PANEL_TOPLEVEL(owner));
+}
+
+static void on_height_change(GObject *owner, G_GNUC_UNUSED GParamSpec *pspec, void *data)
+{
+	CpufreqApplet *c = VALA_PANEL_CPUFREQ_APPLET(data);
+	uint height;
+	g_object_get(owner, VALA_PANEL_KEY_HEIGHT, &height, NULL);
+	gtk_widget_set_size_request(GTK_WIDGET(c->graph), height > 40 ? height : 40, height);
+}
+
+static void cpufreq_apply_colors(CpufreqApplet *c)
+{
+	GSettings *settings         = vala_panel_applet_get_settings(VALA_PANEL_APPLET(c));
+	ValaPanelToplevel *toplevel = vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(c));
+	GtkStyleContext *context    = gtk_widget_get_style_context(GTK_WIDGET(toplevel));
+	GtkStateFlags flags         = gtk_widget_get_state_flags(GTK_WIDGET(toplevel));
+	GdkRGBA foreground_color;
+	gtk_style_context_get_color(context, flags, &foreground_color);
+	/* Heatmap is drawn with the clock color */
+	uint n_series = c->per_core ? 1 : CPUFREQ_N_SERIES;
+	for (uint i = 0; i < n_series; i++)
+	{
+		g_autofree char *spec = g_settings_get_string(settings, series_colors[i]);
+		GdkRGBA color;
+		if (!gdk_rgba_parse(&color, spec))
+			color = foreground_color;
+		vala_panel_graph_set_color(c->graph, i, &color);
+	}
+}
+
+/* Graph is recreated for a different number of series, which is construct-only */
+static void cpufreq_rebuild_graph(CpufreqApplet *c, uint n_series)
+{
+	ValaPanelToplevel *toplevel = vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(c));
+	if (c->graph != NULL)
+		gtk_widget_destroy(GTK_WIDGET(c->graph));
+	c->graph = vala_panel_graph_new(n_series);
+	gtk_widget_add_events(GTK_WIDGET(c->graph),
+	                      GDK_BUTTON_PRESS_MASK | GDK_BUTTON_RELEASE_MASK |
+	                          GDK_BUTTON_MOTION_MASK);
+	on_height_change(G_OBJECT(toplevel), NULL, c);
+	gtk_container_add(GTK_CONTAINER(c), GTK_WIDGET(c->graph));
+	cpufreq_apply_colors(c);
+	vala_panel_graph_set_envelope(c->graph, c->fast && !c->per_core);
+	if (c->per_core)
+		vala_panel_graph_set_style(c->graph, VALA_PANEL_GRAPH_HEATMAP);
+	else
+	{
+		vala_panel_graph_set_style(c->graph, VALA_PANEL_GRAPH_LINES);
+		/* Keep history across panel restarts, scrolling over graph changes time scale */
+		const char *uuid         = vala_panel_applet_get_uuid(VALA_PANEL_APPLET(c));
+		g_autofree char *history = g_strdup_printf("%s-cpufreq", uuid);
+		vala_panel_graph_set_history(c->graph, history);
+	}
+	gtk_widget_show(GTK_WIDGET(c->graph));
+}
+
+/* Subscribe to the sampler to refresh the statistics. */
+static void cpufreq_resubscribe(CpufreqApplet *c)
+{
+	ValaPanelSampler *sampler = vala_panel_sampler_get_default();
+	if (c->sampler_id)
+		vala_panel_sampler_unsubscribe(sampler, c->sampler_id);
+	c->sampler_id =
+	    vala_panel_sampler_subscribe(sampler, VALA_PANEL_SAMPLE_SENSORS, cpufreq_update, c);
+	vala_panel_sampler_set_fast(sampler, c->sampler_id, c->fast);
+	on_visibility_change(G_OBJECT(vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(c))),
+	                     NULL,
+	                     c);
+}
+
+static void on_settings_changed(GSettings *settings, char *key, gpointer user_data)
+{
+	CpufreqApplet *c = VALA_PANEL_CPUFREQ_APPLET(user_data);
+	if (!g_strcmp0(key, PER_CORE))
+	{
+		c->per_core = g_settings_get_boolean(settings, PER_CORE);
+		c->n_cores  = 0;
+		cpufreq_rebuild_graph(c, c->per_core ? 1 : CPUFREQ_N_SERIES);
+		cpufreq_resubscribe(c);
+	}
+	else if (!g_strcmp0(key, FAST_SAMPLING))
+	{
+		c->fast = g_settings_get_boolean(settings, FAST_SAMPLING);
+		vala_panel_graph_set_envelope(c->graph, c->fast && !c->per_core);
+		cpufreq_resubscribe(c);
+	}
+	else if (g_str_has_suffix(key, "-color"))
+		cpufreq_apply_colors(c);
+}
+
+static void cpufreq_applet_constructed(GObject *obj)
+{
+	G_OBJECT_CLASS(cpufreq_applet_parent_class)->constructed(obj);
+	CpufreqApplet *c            = VALA_PANEL_CPUFREQ_APPLET(obj);
+	ValaPanelToplevel *toplevel = vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(c));
+	GSettings *settings         = vala_panel_applet_get_settings(VALA_PANEL_APPLET(c));
+	GActionMap *map = G_ACTION_MAP(vala_panel_applet_get_action_group(VALA_PANEL_APPLET(c)));
+	g_simple_action_set_enabled(
+	    G_SIMPLE_ACTION(g_action_map_lookup_action(map, VALA_PANEL_APPLET_ACTION_CONFIGURE)),
+	    true);
+	c->per_core = g_settings_get_boolean(settings, PER_CORE);
+	c->fast     = g_settings_get_boolean(settings, FAST_SAMPLING);
+	/* Heatmap gets its rows with the first sample */
+	cpufreq_rebuild_graph(c, c->per_core ? 1 : CPUFREQ_N_SERIES);
+
+	/* Connect signals. */
+	g_signal_connect(G_OBJECT(toplevel),
+	                 "notify::" VALA_PANEL_KEY_HEIGHT,
+	                 G_CALLBACK(on_height_change),
+	                 c);
+	g_signal_connect(G_OBJECT(toplevel),
+	                 "notify::" VALA_PANEL_KEY_VISIBILITY,
+	                 G_CALLBACK(on_visibility_change),
+	                 c);
+	g_signal_connect(settings, "changed", G_CALLBACK(on_settings_changed), c);
+	/* Show the widget. */
+	cpufreq_resubscribe(c);
+	gtk_widget_show(GTK_WIDGET(c));
+}
+
+static GtkWidget *cpufreq_get_settings_ui(ValaPanelApplet *base)
+{
+	return vala_panel_generic_cfg_widgetv(vala_panel_applet_get_settings(base),
+	                                      _("Show clock of every core as a heatmap row"),
+	                                      PER_CORE,
+	                                      CONF_BOOL,
+	                                      _("Sample ten times per second, showing bursts"),
+	                                      FAST_SAMPLING,
+	                                      CONF_BOOL,
+	                                      _("Clock color"),
+	                                      CLOCK_COLOR,
+	                                      CONF_STR,
+	                                      _("Temperature color"),
+	                                      TEMPERATURE_COLOR,
+	                                      CONF_STR,
+	                                      NULL);
+}
+
+/* Plugin destructor. */
+static void cpufreq_applet_dispose(GObject *user_data)
+{
+	CpufreqApplet *c            = VALA_PANEL_CPUFREQ_APPLET(user_data);
+	ValaPanelToplevel *toplevel = vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(c));
+	g_signal_handlers_disconnect_by_data(toplevel, c);
+	g_signal_handlers_disconnect_by_data(vala_panel_applet_get_settings(VALA_PANEL_APPLET(c)),
+	                                     c);
+	/* Disconnect from the sampler. */
+	if (c->sampler_id)
+	{
+		vala_panel_sampler_unsubscribe(vala_panel_sampler_get_default(), c->sampler_id);
+		c->sampler_id = 0;
+	}
+	g_clear_pointer(&c->core_values, g_free);
+	G_OBJECT_CLASS(cpufreq_applet_parent_class)->dispose(user_data);
+}
+
+static void cpufreq_applet_init(G_GNUC_UNUSED CpufreqApplet *self)
+{
+}
+
+static void cpufreq_applet_class_init(CpufreqAppletClass *klass)
+{
+	G_OBJECT_CLASS(klass)->constructed              = cpufreq_applet_constructed;
+	G_OBJECT_CLASS(klass)->dispose                  = cpufreq_applet_dispose;
+	VALA_PANEL_APPLET_CLASS(klass)->get_settings_ui = cpufreq_get_settings_ui;
+}
+
+static void cpufreq_applet_class_finalize(G_GNUC_UNUSED CpufreqAppletClass *klass)
+{
+}
+
+/*
+ * IO Module functions
+ */
+
+void g_io_cpufreq_load(GTypeModule *module)
+{
+	g_return_if_fail(module != NULL);
+
+	cpufreq_applet_register_type(module);
+
+	g_io_extension_point_implement(VALA_PANEL_APPLET_EXTENSION_POINT,
+	                               cpufreq_applet_get_type(),
+	                               "org.valapanel.cpufreq",
+	                               10);
+}
+
+void g_io_cpufreq_unload(GIOModule *module)
+{
+	g_return_if_fail(module != NULL);
+}
@@ -22,65 +22,91 @@
  * CPU monitor functions
  */
 
-typedef struct
-{                                          /* Value from /proc/stat */
-	long long unsigned int u, n, s, i; /* User, nice, system, idle */
-} cpu_stat;
-
-G_GNUC_INTERNAL bool cpu_update(Monitor *c)
+static inline double cgroup_delta(guint64 current, guint64 previous)
 {
-	static cpu_stat previous_cpu_stat = { 0, 0, 0, 0 };
+	return current > previous ? (double)(current - previous) : 0.0;
+}
 
-	if ((c->stats != NULL) && (c->pixmap != NULL))
+/* Cgroup time is only split into user and system, against CPUs which cgroup may use */
+static bool cpu_update_cgroup(Monitor *c, const ValaPanelSnapshot *snapshot)
+{
+	ValaPanelCgroupSample sample;
+	if (!(vala_panel_cgroup_read(c->cgroup, VALA_PANEL_CGROUP_CPU, &sample) &
+	      VALA_PANEL_CGROUP_CPU))
+		return false;
+	const ValaPanelCgroupSample *old = &c->cgroup_last;
+	double seconds = (double)(snapshot->time - c->previous_time) / G_USEC_PER_SEC;
+	bool column    = false;
+	if (c->previous_time != 0 && seconds > 0)
 	{
-		/* Open statistics file and scan out CPU usage. */
-		cpu_stat cpu;
-		FILE *stat = fopen("/proc/stat", "r");
-		if (stat == NULL)
-			return true;
-		int fscanf_result =
-		    fscanf(stat, "cpu %llu %llu %llu %llu", &cpu.u, &cpu.n, &cpu.s, &cpu.i);
-		fclose(stat);
-
-		/* Ensure that fscanf succeeded. */
-		if (fscanf_result == 4)
-		{
-			/* Compute delta from previous statistics. */
-			cpu_stat cpu_delta;
-			cpu_delta.u = cpu.u - previous_cpu_stat.u;
-			cpu_delta.n = cpu.n - previous_cpu_stat.n;
-			cpu_delta.s = cpu.s - previous_cpu_stat.s;
-			cpu_delta.i = cpu.i - previous_cpu_stat.i;
+		double states[VALA_PANEL_CPU_N_STATES] = { 0 };
+		double cpus                            = g_get_num_processors();
+		if (sample.cpu_limit > 0)
+			cpus = MIN(cpus, sample.cpu_limit);
+		double capacity  = cpus * seconds * G_USEC_PER_SEC;
+		double user      = cgroup_delta(sample.user_usec, old->user_usec) / capacity;
+		double system    = cgroup_delta(sample.system_usec, old->system_usec) / capacity;
+		double periods   = cgroup_delta(sample.nr_periods, old->nr_periods);
+		double throttled = cgroup_delta(sample.nr_throttled, old->nr_throttled);
+		states[VALA_PANEL_CPU_USER]   = MIN(user, 1.0);
+		states[VALA_PANEL_CPU_SYSTEM] = MIN(system, 1.0 - states[VALA_PANEL_CPU_USER]);
+		c->throttled                  = periods > 0 ? throttled / periods : 0.0;
+		column = vala_panel_graph_push_at(c->graph, states, snapshot->time);
+	}
+	c->cgroup_last   = sample;
+	c->previous_time = snapshot->time;
+	return column;
+}
 
-			/* Copy current to previous. */
-			memcpy(&previous_cpu_stat, &cpu, sizeof(cpu_stat));
+G_GNUC_INTERNAL bool cpu_update(Monitor *c, const ValaPanelSnapshot *snapshot)
+{
+	const ValaPanelCpuSample *cpu = &snapshot->cpu;
+	/* Cgroup counters are read here, host ones are subscribed only without a cgroup */
+	if (c->cgroup != NULL)
+		return (snapshot->valid & VALA_PANEL_SAMPLE_CLOCK) &&
+		       cpu_update_cgroup(c, snapshot);
+	if (!(snapshot->valid & VALA_PANEL_SAMPLE_CPU))
+		return false;
 
-			/* Compute user+nice+system as a fraction of total.
-			 * Introduce this sample to ring buffer, increment and wrap ring buffer
-			 * cursor. */
-			float cpu_uns            = cpu_delta.u + cpu_delta.n + cpu_delta.s;
-			c->stats[c->ring_cursor] = cpu_uns / (cpu_uns + cpu_delta.i);
-			c->ring_cursor += 1;
-			if (c->ring_cursor >= c->pixmap_width)
-				c->ring_cursor = 0;
+	/* Compute share of every state since previous statistics and add them to graph. */
+	double states[VALA_PANEL_CPU_N_STATES];
+	vala_panel_cpu_sample_load(cpu, &c->previous_cpu, states);
 
-			/* Redraw with the new sample. */
-			monitor_redraw_pixmap(c);
-		}
-	}
-	return G_SOURCE_CONTINUE;
+	/* Copy current to previous. */
+	memcpy(&c->previous_cpu, cpu, sizeof(ValaPanelCpuSample));
+	return vala_panel_graph_push_at(c->graph, states, snapshot->time);
 }
 
-G_GNUC_INTERNAL void tooltip_update_cpu(Monitor *m)
+static const char *state_names[VALA_PANEL_CPU_N_STATES] = {
+	N_("User"), N_("Nice"), N_("System"), N_("Interrupts"), N_("Steal"), N_("I/O wait"),
+};
+
+G_GNUC_INTERNAL void tooltip_update_cpu(Monitor *m, const ValaPanelSnapshot *snapshot)
 {
-	if (m != NULL && m->stats != NULL)
+	if (m != NULL && m->graph != NULL)
 	{
-		int ring_pos = (m->ring_cursor == 0) ? m->pixmap_width - 1 : m->ring_cursor - 1;
-		if (m->da != NULL)
+		double states[VALA_PANEL_CPU_N_STATES], load = 0.0;
+		for (uint i = 0; i < VALA_PANEL_CPU_N_STATES; i++)
+			states[i] = vala_panel_graph_get_last(m->graph, i);
+		/* I/O wait is drawn, but CPU is idle then */
+		for (uint i = 0; i < VALA_PANEL_CPU_IOWAIT; i++)
+			load += states[i];
+		g_autoptr(GString) tooltip_txt = g_string_new(NULL);
+		g_string_printf(tooltip_txt, _("CPU usage: %.2f%%"), load * 100);
+		for (uint i = 0; i < VALA_PANEL_CPU_N_STATES; i++)
+			g_string_append_printf(tooltip_txt,
+			                       "\n%s: %.2f%%",
+			                       _(state_names[i]),
+			                       states[i] * 100);
+		if (m->cgroup != NULL)
 		{
-			g_autofree char *tooltip_txt =
-			    g_strdup_printf(_("CPU usage: %.2f%%"), m->stats[ring_pos] * 100);
-			gtk_widget_set_tooltip_text(GTK_WIDGET(m->da), tooltip_txt);
+			g_string_append_printf(tooltip_txt, "\n%s", m->cgroup->path);
+			g_string_append_c(tooltip_txt, '\n');
+			g_string_append_printf(tooltip_txt,
+			                       _("Throttled: %.0f%% of periods"),
+			                       m->throttled * 100);
 		}
+		monitor_append_top(tooltip_txt, snapshot, true);
+		gtk_widget_set_tooltip_text(GTK_WIDGET(m->graph), tooltip_txt->str);
 	}
 }
@@ -26,9 +26,14 @@ G_BEGIN_DECLS
 #define DISPLAY_CPU "display-cpu-monitor"
 #define CPU_CL "cpu-color"
 #define CPU_WIDTH "cpu-width"
+#define CPU_NICE_CL "cpu-nice-color"
+#define CPU_SYSTEM_CL "cpu-system-color"
+#define CPU_IRQ_CL "cpu-irq-color"
+#define CPU_STEAL_CL "cpu-steal-color"
+#define CPU_IOWAIT_CL "cpu-iowait-color"
 
-G_GNUC_INTERNAL bool cpu_update(Monitor *c);
-G_GNUC_INTERNAL void tooltip_update_cpu(Monitor *m);
+G_GNUC_INTERNAL bool cpu_update(Monitor *c, const ValaPanelSnapshot *snapshot);
+G_GNUC_INTERNAL void tooltip_update_cpu(Monitor *m, const ValaPanelSnapshot *snapshot);
 
 G_END_DECLS
 
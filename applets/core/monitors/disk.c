@@ -0,0 +1,103 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+
+#include "disk.h"
+
+/*
+ * Disk monitor functions
+ */
+
+#define SECTOR_SIZE 512 /* Unit of diskstats, whatever sector size device has */
+
+/* Counters start over when device is recreated with the same name */
+static double disk_delta(guint64 current, guint64 previous)
+{
+	return current > previous ? (double)(current - previous) : 0.0;
+}
+
+G_GNUC_INTERNAL bool update_disk(Monitor *m, const ValaPanelSnapshot *snapshot)
+{
+	if (!(snapshot->valid & VALA_PANEL_SAMPLE_DISK))
+		return false;
+
+	ValaPanelSampleFilter *devices   = &m->devices;
+	const ValaPanelDiskSample *disks = snapshot->disks;
+	guint digest                     = snapshot->disk_digest;
+	/* Sum over another set of devices is not comparable to the last one */
+	if (vala_panel_sample_filter_update_disks(devices, disks, snapshot->n_disks, digest))
+		m->previous_time = 0;
+	ValaPanelDiskSample sum = { 0 };
+	for (uint i = 0; i < devices->positions->len; i++)
+	{
+		uint pos                        = g_array_index(devices->positions, uint, i);
+		const ValaPanelDiskSample *disk = &disks[pos];
+		sum.reads += disk->reads;
+		sum.sectors_read += disk->sectors_read;
+		sum.writes += disk->writes;
+		sum.sectors_written += disk->sectors_written;
+		sum.io_ticks += disk->io_ticks;
+		sum.time_in_queue += disk->time_in_queue;
+	}
+	double seconds = (double)(snapshot->time - m->previous_time) / G_USEC_PER_SEC;
+	bool column    = false;
+	/* First sample only primes counters, they are counted from boot */
+	if (m->previous_time != 0 && seconds > 0)
+	{
+		const ValaPanelDiskSample *old = &m->previous_disk;
+		/* Graph gets bytes per second, it scales them only when drawing */
+		double rate     = SECTOR_SIZE / seconds;
+		double values[] = {
+			[DISK_READ]  = disk_delta(sum.sectors_read, old->sectors_read) * rate,
+			[DISK_WRITE] = disk_delta(sum.sectors_written, old->sectors_written) * rate,
+		};
+		double requests = disk_delta(sum.reads + sum.writes, old->reads + old->writes);
+		/* Queue time grows by number of requests in flight, so it also counts waiting */
+		double queued = disk_delta(sum.time_in_queue, old->time_in_queue);
+		m->latency    = requests > 0 ? queued / requests : 0.0;
+		/* Several devices are busy for their average share of time */
+		double busy = disk_delta(sum.io_ticks, old->io_ticks) / 1000 / seconds;
+		m->busy     = MIN(busy / MAX(devices->positions->len, 1), 1.0);
+		column      = vala_panel_graph_push_at(m->graph, values, snapshot->time);
+	}
+	m->previous_disk = sum;
+	m->previous_time = snapshot->time;
+	return column;
+}
+
+G_GNUC_INTERNAL void tooltip_update_disk(Monitor *m,
+                                         G_GNUC_UNUSED const ValaPanelSnapshot *snapshot)
+{
+	if (m != NULL && m->graph != NULL)
+	{
+		double read                  = vala_panel_graph_get_last(m->graph, DISK_READ);
+		double write                 = vala_panel_graph_get_last(m->graph, DISK_WRITE);
+		g_autofree char *read_txt    = g_format_size((guint64)read);
+		g_autofree char *write_txt   = g_format_size((guint64)write);
+		g_autofree char *tooltip_txt =
+		    g_strdup_printf(_("%s:\nDisk read: %s/s\nDisk write: %s/s\n"
+		                      "Request latency: %.1f ms\nBusy: %.0f%%"),
+		                    m->devices.name,
+		                    read_txt,
+		                    write_txt,
+		                    m->latency,
+		                    m->busy * 100);
+		gtk_widget_set_tooltip_text(GTK_WIDGET(m->graph), tooltip_txt);
+	}
+}
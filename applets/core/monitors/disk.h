@@ -0,0 +1,43 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DISK_H
+#define DISK_H
+
+#include "monitor.h"
+
+G_BEGIN_DECLS
+
+#define DISPLAY_DISK "display-disk-monitor"
+#define DISK_DEVICES "disk-devices"
+#define DISK_READ_CL "disk-read-color"
+#define DISK_WRITE_CL "disk-write-color"
+#define DISK_WIDTH "disk-width"
+
+#define DISK_MIN_FULL_SCALE 1048576 /* Bytes per second */
+
+/* Graph series */
+#define DISK_READ 0
+#define DISK_WRITE 1
+
+G_GNUC_INTERNAL bool update_disk(Monitor *m, const ValaPanelSnapshot *snapshot);
+G_GNUC_INTERNAL void tooltip_update_disk(Monitor *m, const ValaPanelSnapshot *snapshot);
+
+G_END_DECLS
+
+#endif // DISK_H
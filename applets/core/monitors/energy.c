@@ -0,0 +1,74 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+
+#include "energy.h"
+
+/*
+ * Power monitor functions
+ */
+
+G_GNUC_INTERNAL bool update_power(Monitor *m, const ValaPanelSnapshot *snapshot)
+{
+	if (!(snapshot->valid & VALA_PANEL_SAMPLE_POWER))
+		return false;
+
+	const ValaPanelPowerSample *power = &snapshot->power;
+	const ValaPanelPowerSample *old   = &m->last_power;
+	gint64 elapsed                    = snapshot->time - m->previous_time;
+	double seconds                    = (double)elapsed / G_USEC_PER_SEC;
+	bool column                       = false;
+	/* First sample only primes energy, and so does a sampler which counts anew */
+	if (m->previous_time != 0 && seconds > 0 && power->energy_uj >= old->energy_uj)
+	{
+		double joules = (double)(power->energy_uj - old->energy_uj) / 1e6;
+		/* Graph gets watts, it scales them only when drawing */
+		double values[] = {
+			[POWER_PACKAGE] = joules / seconds,
+			[POWER_BATTERY] = power->battery_watts,
+		};
+		column = vala_panel_graph_push_at(m->graph, values, snapshot->time);
+	}
+	m->last_power    = *power;
+	m->previous_time = snapshot->time;
+	return column;
+}
+
+G_GNUC_INTERNAL void tooltip_update_power(Monitor *m,
+                                          G_GNUC_UNUSED const ValaPanelSnapshot *snapshot)
+{
+	if (m == NULL || m->graph == NULL)
+		return;
+	const ValaPanelPowerSample *power = &m->last_power;
+	g_autoptr(GString) tooltip        = g_string_new(NULL);
+	if (power->has_energy)
+		g_string_append_printf(tooltip,
+		                       _("CPU packages: %.1f W"),
+		                       vala_panel_graph_get_last(m->graph, POWER_PACKAGE));
+	else
+		/* energy_uj is readable only by root since CVE-2020-8694 */
+		g_string_append(tooltip, _("CPU packages: no access to RAPL energy"));
+	if (power->on_battery)
+		g_string_append_printf(tooltip,
+		                       _("\nBattery discharge: %.1f W"),
+		                       vala_panel_graph_get_last(m->graph, POWER_BATTERY));
+	else if (power->has_battery)
+		g_string_append(tooltip, _("\nOn AC power"));
+	gtk_widget_set_tooltip_text(GTK_WIDGET(m->graph), tooltip->str);
+}
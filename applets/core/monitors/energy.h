@@ -0,0 +1,42 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include "monitor.h"
+
+G_BEGIN_DECLS
+
+#define DISPLAY_POWER "display-power-monitor"
+#define POWER_PACKAGE_CL "power-package-color"
+#define POWER_BATTERY_CL "power-battery-color"
+#define POWER_WIDTH "power-width"
+
+#define POWER_MIN_FULL_SCALE 10 /* Watts */
+
+/* Graph series */
+#define POWER_PACKAGE 0
+#define POWER_BATTERY 1
+
+G_GNUC_INTERNAL bool update_power(Monitor *m, const ValaPanelSnapshot *snapshot);
+G_GNUC_INTERNAL void tooltip_update_power(Monitor *m, const ValaPanelSnapshot *snapshot);
+
+G_END_DECLS
+
+#endif // ENERGY_H
@@ -16,76 +16,70 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <errno.h>
 #include <stdbool.h>
-#include <stdio.h>
 
 #include "mem.h"
 
 /*
  * Memory monitor functions
  */
-G_GNUC_INTERNAL bool update_mem(Monitor *m)
+/* Usage against memory.max, or against all memory if cgroup is not limited */
+static bool update_mem_cgroup(Monitor *m, const ValaPanelSnapshot *snapshot)
 {
-	char buf[80];
-	long mem_total = 0;
-	long mem_free  = 0;
-	uint readmask  = 0x2 | 0x1;
-	if (m->stats == NULL || m->pixmap == NULL)
-		return true;
-	FILE *meminfo = fopen("/proc/meminfo", "r");
-	if (meminfo == NULL)
-	{
-		g_warning("monitors: Could not open /proc/meminfo: %d, %s", errno, strerror(errno));
+	ValaPanelCgroupSample *cgroup = &m->cgroup_last;
+	if (!(vala_panel_cgroup_read(m->cgroup, VALA_PANEL_CGROUP_MEMORY, cgroup) &
+	      VALA_PANEL_CGROUP_MEMORY))
 		return false;
-	}
+	double limit = MIN((double)cgroup->memory_max, snapshot->mem.mem_total * 1024.0);
+	m->total     = limit / 1024;
 
-	/* Use new 3.14 MemAvailable spec */
-	while (readmask != 0 && fgets(buf, 80, meminfo) != NULL)
-	{
-		if (sscanf(buf, "MemTotal: %ld kB\n", &mem_total) == 1)
-		{
-			readmask ^= 0x1;
-			continue;
-		}
-		if (sscanf(buf, "MemAvailable: %ld kB\n", &mem_free) == 1)
-		{
-			readmask ^= 0x2;
-			continue;
-		}
-	}
-	fclose(meminfo);
+	double value = MIN(cgroup->memory_current / limit, 1.0);
+	return vala_panel_graph_push_at(m->graph, &value, snapshot->time);
+}
 
-	if (readmask != 0)
-	{
-		g_warning("monitors: Could not read all values from /proc/meminfo:\n readmask %x",
-		          readmask);
+G_GNUC_INTERNAL bool update_mem(Monitor *m, const ValaPanelSnapshot *snapshot)
+{
+	if (!(snapshot->valid & VALA_PANEL_SAMPLE_MEM))
 		return false;
-	}
+	if (m->cgroup != NULL)
+		return update_mem_cgroup(m, snapshot);
 
-	m->total                 = mem_total;
-	m->stats[m->ring_cursor] = (mem_total - mem_free) / (double)mem_total;
+	/* Use new 3.14 MemAvailable spec */
+	const ValaPanelMemSample *mem = &snapshot->mem;
+	m->total                      = mem->mem_total;
 
-	m->ring_cursor += 1;
-	if (m->ring_cursor >= m->pixmap_width)
-		m->ring_cursor = 0;
-	/* Redraw the pixmap, with the new sample */
-	monitor_redraw_pixmap(m);
-	return true;
+	double value = (mem->mem_total - mem->mem_available) / (double)mem->mem_total;
+	return vala_panel_graph_push_at(m->graph, &value, snapshot->time);
 }
 
-G_GNUC_INTERNAL void tooltip_update_mem(Monitor *m)
+G_GNUC_INTERNAL void tooltip_update_mem(Monitor *m, const ValaPanelSnapshot *snapshot)
 {
-	if (m != NULL && m->stats != NULL)
+	if (m != NULL && m->graph != NULL)
 	{
-		int ring_pos = (m->ring_cursor == 0) ? m->pixmap_width - 1 : m->ring_cursor - 1;
-		if (m->da != NULL && m->stats != NULL)
+		double value                   = vala_panel_graph_get_last(m->graph, 0);
+		g_autoptr(GString) tooltip_txt = g_string_new(NULL);
+		g_string_printf(tooltip_txt,
+		                _("RAM usage: %.1fMB (%.2f%%)"),
+		                value * m->total / 1024,
+		                value * 100);
+		if (m->cgroup != NULL)
 		{
-			g_autofree char *tooltip_txt =
-			    g_strdup_printf(_("RAM usage: %.1fMB (%.2f%%)"),
-			                    m->stats[ring_pos] * m->total / 1024,
-			                    m->stats[ring_pos] * 100);
-			gtk_widget_set_tooltip_text(GTK_WIDGET(m->da), tooltip_txt);
+			const ValaPanelCgroupSample *cgroup = &m->cgroup_last;
+			g_string_append_printf(tooltip_txt, "\n%s", m->cgroup->path);
+			/* Reclaim and OOM events mean the limit is too tight */
+			if (cgroup->memory_high + cgroup->memory_limit + cgroup->oom_kill > 0)
+			{
+				g_string_append_c(tooltip_txt, '\n');
+				g_string_append_printf(tooltip_txt,
+				                       _("Over high: %" G_GUINT64_FORMAT
+				                         ", at max: %" G_GUINT64_FORMAT
+				                         ", OOM kills: %" G_GUINT64_FORMAT),
+				                       cgroup->memory_high,
+				                       cgroup->memory_limit,
+				                       cgroup->oom_kill);
+			}
 		}
+		monitor_append_top(tooltip_txt, snapshot, false);
+		gtk_widget_set_tooltip_text(GTK_WIDGET(m->graph), tooltip_txt->str);
 	}
 }
@@ -27,8 +27,8 @@ G_BEGIN_DECLS
 #define RAM_CL "ram-color"
 #define RAM_WIDTH "ram-width"
 
-G_GNUC_INTERNAL bool update_mem(Monitor *m);
-G_GNUC_INTERNAL void tooltip_update_mem(Monitor *m);
+G_GNUC_INTERNAL bool update_mem(Monitor *m, const ValaPanelSnapshot *snapshot);
+G_GNUC_INTERNAL void tooltip_update_mem(Monitor *m, const ValaPanelSnapshot *snapshot);
 
 G_END_DECLS
 
@@ -16,161 +16,83 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <errno.h>
 #include <stdbool.h>
-#include <stdio.h>
 
 #include "monitor.h"
 
-#define BORDER_SIZE 2 /* Pixels               */
-
 /*
  * Generic monitor functions and events
  */
 
-G_GNUC_INTERNAL bool monitor_update(Monitor *mon)
-{
-	if (mon->tooltip_update != NULL && mon->da != NULL)
-		mon->tooltip_update(mon);
-	return mon->update(mon);
-}
-
-G_GNUC_INTERNAL void monitor_redraw_pixmap(Monitor *mon)
+G_GNUC_INTERNAL bool monitor_update(Monitor *mon, const ValaPanelSnapshot *snapshot)
 {
-	cairo_t *cr = cairo_create(mon->pixmap);
-	cairo_set_line_width(cr, 1.0);
-	/* Erase pixmap */
-	cairo_set_source_rgba(cr, 0, 0, 0, 0);
-	cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
-	cairo_paint(cr);
-	gdk_cairo_set_source_rgba(cr, &mon->foreground_color);
-	for (int i = 0; i < mon->pixmap_width; i++)
-	{
-		uint drawing_cursor = (mon->ring_cursor + i) % mon->pixmap_width;
-		/* Draw one bar of the graph */
-		cairo_move_to(cr, i + 0.5, mon->pixmap_height);
-		cairo_line_to(cr, i + 0.5, (1.0 - mon->stats[drawing_cursor]) * mon->pixmap_height);
-		cairo_stroke(cr);
-	}
-	cairo_status(cr);
-	cairo_destroy(cr);
-	/* Redraw pixmap */
-	gtk_widget_queue_draw(GTK_WIDGET(mon->da));
+	/* Tooltip shows the newest column, so with fast sampling it is set once per column */
+	bool column = mon->update(mon, snapshot);
+	if (column && mon->tooltip_update != NULL && mon->graph != NULL)
+		mon->tooltip_update(mon, snapshot);
+	return column;
 }
 
-G_GNUC_INTERNAL bool monitor_resize(G_GNUC_UNUSED GtkWidget *widget, Monitor *mon)
+G_GNUC_INTERNAL void monitor_append_top(GString *tooltip, const ValaPanelSnapshot *snapshot,
+                                        bool by_cpu)
 {
-	GtkAllocation allocation;
-	int new_pixmap_width, new_pixmap_height;
-	gtk_widget_get_allocation(GTK_WIDGET(mon->da), &allocation);
-	new_pixmap_width  = allocation.width - BORDER_SIZE * 2;
-	new_pixmap_height = allocation.height - BORDER_SIZE * 2;
-	if (new_pixmap_width > 0 && new_pixmap_height > 0)
+	if (!(snapshot->valid & VALA_PANEL_SAMPLE_PROCESSES))
+		return;
+	const ValaPanelProcTop *top   = snapshot->top;
+	const ValaPanelProcInfo *info = by_cpu ? top->by_cpu : top->by_rss;
+	uint n_info                   = by_cpu ? top->n_by_cpu : top->n_by_rss;
+	if (n_info > 0)
+		g_string_append_printf(tooltip, "\n\n%s", _("Top processes:"));
+	for (uint i = 0; i < n_info; i++)
 	{
-		/*
-		 * If the stats buffer does not exist (first time we get inside this
-		 * function) or its size changed, reallocate the buffer and preserve
-		 * existing data.
-		 */
-		if (mon->stats == NULL || (new_pixmap_width != mon->pixmap_width))
-		{
-			double *new_stats = g_new0(double, sizeof(double) * new_pixmap_width);
-			if (new_stats == NULL)
-				return G_SOURCE_REMOVE;
-
-			if (mon->stats != NULL)
-			{
-				/* New allocation is larger.
-				 * Add new "oldest" samples of zero following the cursor*/
-				if (new_pixmap_width > mon->pixmap_width)
-				{
-					/* Number of values between the ring cursor and the end of
-					 * the buffer */
-					int nvalues = mon->pixmap_width - mon->ring_cursor;
-					memcpy(new_stats,
-					       mon->stats,
-					       mon->ring_cursor * sizeof(double));
-					memcpy(&new_stats[nvalues],
-					       &mon->stats[mon->ring_cursor],
-					       nvalues * sizeof(double));
-				}
-				/* New allocation is smaller, but still larger than the ring
-				 * buffer cursor */
-				else if (mon->ring_cursor <= new_pixmap_width)
-				{
-					/* Numver of values that can be stored between the end of
-					 * the new buffer and the ring cursor */
-					int nvalues = new_pixmap_width - mon->ring_cursor;
-					memcpy(new_stats,
-					       mon->stats,
-					       mon->ring_cursor * sizeof(double));
-					memcpy(&new_stats[mon->ring_cursor],
-					       &mon->stats[mon->pixmap_width - nvalues],
-					       nvalues * sizeof(double));
-				}
-				/* New allocation is smaller, and also smaller than the ring
-				 * buffer cursor.  Discard all oldest samples following the ring
-				 * buffer cursor and additional samples at the beginning of the
-				 * buffer. */
-				else
-				{
-					memcpy((void *)new_stats,
-					       (void *)&mon
-					           ->stats[mon->ring_cursor - new_pixmap_width],
-					       new_pixmap_width * sizeof(double));
-				}
-			}
-			g_clear_pointer(&mon->stats, g_free);
-			mon->stats = new_stats;
-		}
-		mon->pixmap_width  = new_pixmap_width;
-		mon->pixmap_height = new_pixmap_height;
-		g_clear_pointer(&mon->pixmap, cairo_surface_destroy);
-		mon->pixmap = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
-		                                         mon->pixmap_width,
-		                                         mon->pixmap_height);
-		cairo_surface_status(mon->pixmap);
-		monitor_redraw_pixmap(mon);
+		/* Share of one CPU, like in top, so several busy threads exceed 100% */
+		g_autofree char *value = by_cpu ? g_strdup_printf("%.1f%%", info[i].cpu * 100)
+		                                : g_format_size(info[i].rss * 1024);
+		g_string_append_printf(tooltip, "\n%s (%d): %s", info[i].comm, info[i].pid, value);
 	}
-	return G_SOURCE_CONTINUE;
 }
 
-static bool configure_event(GtkWidget *widget, G_GNUC_UNUSED GdkEventConfigure *dummy,
-                            gpointer data)
+G_GNUC_INTERNAL void monitor_set_series_color(Monitor *mon, uint series, const char *color)
 {
-	Monitor *mon = (Monitor *)data;
-	return monitor_resize(widget, mon);
+	GdkRGBA foreground_color;
+	gdk_rgba_parse(&foreground_color, color);
+	vala_panel_graph_set_color(mon->graph, series, &foreground_color);
 }
 
-static bool draw(G_GNUC_UNUSED GtkWidget *widget, cairo_t *cr, Monitor *mon)
+G_GNUC_INTERNAL void monitor_set_color(Monitor *mon, const char *color)
 {
-	/* Draw the requested part of the pixmap onto the drawing area.
-	 * Translate it in both x and y by the border size. */
-	if (mon->pixmap != NULL)
-	{
-		cairo_set_source_surface(cr, mon->pixmap, BORDER_SIZE, BORDER_SIZE);
-		cairo_paint(cr);
-		cairo_status(cr);
-	}
-	return false;
+	monitor_set_series_color(mon, 0, color);
 }
 
-G_GNUC_INTERNAL void monitor_init_no_height(Monitor *mon, const char *color)
+G_GNUC_INTERNAL void monitor_init_no_height(Monitor *mon, uint n_series, const char *color)
 {
-	mon->da = GTK_DRAWING_AREA(gtk_drawing_area_new());
-	gtk_widget_add_events(GTK_WIDGET(mon->da),
+	mon->graph = vala_panel_graph_new(n_series);
+	gtk_widget_add_events(GTK_WIDGET(mon->graph),
 	                      GDK_BUTTON_PRESS_MASK | GDK_BUTTON_RELEASE_MASK |
 	                          GDK_BUTTON_MOTION_MASK);
-	gdk_rgba_parse(&mon->foreground_color, color);
-	g_signal_connect(mon->da, "configure-event", G_CALLBACK(configure_event), mon);
-	g_signal_connect(mon->da, "draw", G_CALLBACK(draw), mon);
+	monitor_set_color(mon, color);
 }
 
 G_GNUC_INTERNAL void monitor_dispose(Monitor *mon)
 {
-	if (GTK_IS_WIDGET(mon->da))
-		gtk_widget_destroy(GTK_WIDGET(mon->da));
-	g_clear_pointer(&mon->pixmap, cairo_surface_destroy);
-	g_clear_pointer(&mon->stats, g_free);
+	g_clear_pointer(&mon->stream, vala_panel_child_stream_stop);
+	if (GTK_IS_WIDGET(mon->graph))
+		gtk_widget_destroy(GTK_WIDGET(mon->graph));
+	vala_panel_sample_filter_clear(&mon->devices);
+	if (mon->cgroup != NULL)
+		vala_panel_cgroup_close(mon->cgroup);
+	g_clear_pointer(&mon->cgroup, g_free);
 	g_clear_pointer(&mon, g_free);
 }
+
+G_GNUC_INTERNAL ValaPanelCgroup *monitor_open_cgroup(const char *cgroup)
+{
+	if (cgroup == NULL || *cgroup == '\0')
+		return NULL;
+	ValaPanelCgroup *self = g_new0(ValaPanelCgroup, 1);
+	if (vala_panel_cgroup_open(self, cgroup))
+		return self;
+	g_warning("monitors: %s is not a cgroup v2 directory, showing whole system", cgroup);
+	g_free(self);
+	return NULL;
+}
@@ -23,32 +23,55 @@
 #include <gtk/gtk.h>
 #include <stdbool.h>
 
+#include "cgroup.h"
+#include "childstream.h"
+#include "sampler.h"
+#include "util-gtk.h"
+
 G_BEGIN_DECLS
 
+#define FAST_SAMPLING "fast-sampling"
+#define TOP_PROCESSES "top-processes"
+#define CGROUP "cgroup"
+
 struct mon;
 
-typedef bool (*update_func)(struct mon *);
-typedef void (*tooltip_update_func)(struct mon *);
+/* Returns whether graph got a new column */
+typedef bool (*update_func)(struct mon *, const ValaPanelSnapshot *);
+typedef void (*tooltip_update_func)(struct mon *, const ValaPanelSnapshot *);
 
 typedef struct mon
 {
-	GdkRGBA foreground_color; /* Foreground color for drawing area      */
-	GtkDrawingArea *da;       /* Drawing area                           */
-	cairo_surface_t *pixmap;  /* Pixmap to be drawn on drawing area     */
-	int pixmap_width;         /* Width and size of the buffer           */
-	int pixmap_height;        /* Does not include border size           */
-	double *stats;            /* Circular buffer of values              */
-	double total;             /* Maximum possible value, as in mem_total*/
-	int ring_cursor;          /* Cursor for ring/circular buffer        */
+	ValaPanelGraph *graph;             /* History graph, also a drawing area      */
+	double total;                      /* Maximum possible value, as in mem_total */
+	ValaPanelCpuSample previous_cpu;   /* Previous CPU sample, for deltas         */
+	ValaPanelPsiResource resource;     /* Resource of pressure monitor            */
+	ValaPanelPsiSample previous_psi;   /* Previous stall totals, for deltas       */
+	gint64 previous_time;              /* Time of previous sample, zero if unset  */
+	double full;                       /* Last share of "full" stall              */
+	ValaPanelSampleFilter devices;     /* Disks summed by disk monitor            */
+	ValaPanelDiskSample previous_disk; /* Previous sums of devices, for deltas    */
+	double latency;                    /* Milliseconds per request, last column   */
+	double busy;                       /* Share of time disks were busy           */
+	ValaPanelCgroup *cgroup;           /* Followed instead of host, or NULL       */
+	ValaPanelCgroupSample cgroup_last; /* Last cgroup counters, for deltas        */
+	double throttled;                  /* Share of cpu.max periods throttled      */
+	ValaPanelPowerSample last_power;   /* Last power sample, for deltas           */
+	ValaPanelChildStream *stream;      /* Child feeding the stream monitor        */
 	update_func update;
 	tooltip_update_func tooltip_update;
 } Monitor;
 
-G_GNUC_INTERNAL void monitor_init_no_height(Monitor *mon, const char *color);
-G_GNUC_INTERNAL void monitor_redraw_pixmap(Monitor *mon);
-G_GNUC_INTERNAL bool monitor_update(Monitor *mon);
+G_GNUC_INTERNAL void monitor_init_no_height(Monitor *mon, uint n_series, const char *color);
+G_GNUC_INTERNAL void monitor_set_color(Monitor *mon, const char *color);
+G_GNUC_INTERNAL void monitor_set_series_color(Monitor *mon, uint series, const char *color);
+G_GNUC_INTERNAL bool monitor_update(Monitor *mon, const ValaPanelSnapshot *snapshot);
+/* Lists busiest or largest processes under the tooltip, if snapshot has them */
+G_GNUC_INTERNAL void monitor_append_top(GString *tooltip, const ValaPanelSnapshot *snapshot,
+                                        bool by_cpu);
 G_GNUC_INTERNAL void monitor_dispose(Monitor *mon);
-G_GNUC_INTERNAL bool monitor_resize(GtkWidget *widget, Monitor *mon);
+/* Returns %NULL for an empty setting, or when there is no such cgroup v2 directory */
+G_GNUC_INTERNAL ValaPanelCgroup *monitor_open_cgroup(const char *cgroup);
 
 G_END_DECLS
 
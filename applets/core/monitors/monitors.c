@@ -18,20 +18,34 @@
 
 #include "monitors.h"
 #include "cpu.h"
+#include "disk.h"
+#include "energy.h"
 #include "mem.h"
 #include "monitor.h"
+#include "psi.h"
+#include "stream.h"
 #include "swap.h"
 
 #define DEFAULT_WIDTH 40 /* Pixels               */
-#define UPDATE_PERIOD 1  /* Seconds */
 
 #define ACTION "click-action"
 
+/* Series of the CPU monitor, in ValaPanelCpuState order */
+static const char *cpu_state_colors[VALA_PANEL_CPU_N_STATES] = {
+	CPU_CL, CPU_NICE_CL, CPU_SYSTEM_CL, CPU_IRQ_CL, CPU_STEAL_CL, CPU_IOWAIT_CL,
+};
+
 enum
 {
 	CPU_POS = 0,
 	RAM_POS,
 	SWAP_POS,
+	DISK_POS,
+	POWER_POS,
+	PSI_CPU_POS,
+	PSI_MEM_POS,
+	PSI_IO_POS,
+	STREAM_POS,
 	N_POS
 };
 
@@ -40,7 +54,9 @@ struct _MonitorsApplet
 	ValaPanelApplet _parent_;
 	Monitor *monitors[N_POS];
 	bool displayed_mons[N_POS];
-	uint timer;
+	bool fast;          /* Sample ten times per second and draw envelopes */
+	bool top_processes; /* List top consumers in CPU and RAM tooltips */
+	uint sampler_id;
 };
 
 G_DEFINE_DYNAMIC_TYPE(MonitorsApplet, monitors_applet, vala_panel_applet_get_type())
@@ -74,26 +90,36 @@ static void monitor_setup_size(Monitor *mon, MonitorsApplet *pl, int width)
 	             VALA_PANEL_KEY_HEIGHT,
 	             &height,
 	             NULL);
-	gtk_widget_set_size_request(GTK_WIDGET(mon->da), width, height);
-	monitor_resize(GTK_WIDGET(mon->da), mon);
+	gtk_widget_set_size_request(GTK_WIDGET(mon->graph), width, height);
 }
 
-static void monitor_init(Monitor *mon, MonitorsApplet *pl, const char *color, int width)
+static void monitor_init(Monitor *mon, MonitorsApplet *pl, uint n_series, const char *color,
+                         int width)
 {
-	monitor_init_no_height(mon, color);
+	monitor_init_no_height(mon, n_series, color);
 	monitor_setup_size(mon, pl, width);
-	g_signal_connect(mon->da, "button-release-event", G_CALLBACK(button_release_event), pl);
+	g_signal_connect(mon->graph, "button-release-event", G_CALLBACK(button_release_event), pl);
 }
 
+/* @min_scale is floor of an autoscaled graph, 0 when values are in 0..1 already */
 static Monitor *monitor_create(GtkBox *monitor_box, MonitorsApplet *pl, update_func update,
-                               tooltip_update_func tooltip_update, const char *color, int width)
+                               tooltip_update_func tooltip_update, const char *metric,
+                               uint n_series, const char *color, int width, double min_scale)
 {
 	Monitor *m = g_new0(Monitor, 1);
-	monitor_init(m, pl, color, width);
+	monitor_init(m, pl, n_series, color, width);
+	/* Scale is known before history is loaded, which converts files of older scaling */
+	if (min_scale > 0)
+		vala_panel_graph_set_autoscale(m->graph, min_scale);
+	/* History file of each monitor survives panel restarts */
+	const char *uuid         = vala_panel_applet_get_uuid(VALA_PANEL_APPLET(pl));
+	g_autofree char *history = g_strdup_printf("%s-%s", uuid, metric);
+	vala_panel_graph_set_history(m->graph, history);
+	vala_panel_graph_set_envelope(m->graph, pl->fast);
 	m->update         = update;
 	m->tooltip_update = tooltip_update;
-	gtk_box_pack_start(GTK_BOX(monitor_box), GTK_WIDGET(m->da), false, false, 0);
-	gtk_widget_show(GTK_WIDGET(m->da));
+	gtk_box_pack_start(GTK_BOX(monitor_box), GTK_WIDGET(m->graph), false, false, 0);
+	gtk_widget_show(GTK_WIDGET(m->graph));
 	return m;
 }
 
@@ -101,30 +127,64 @@ static Monitor *monitor_create(GtkBox *monitor_box, MonitorsApplet *pl, update_f
  * Applet functions
  */
 
+/* Every followed cgroup gets a history of its own, host one keeps the plain name */
+static char *monitor_cgroup_metric(const ValaPanelCgroup *cgroup, const char *metric)
+{
+	if (cgroup == NULL)
+		return g_strdup(metric);
+	return g_strdup_printf("cgroup-%s-%08x", metric, g_str_hash(cgroup->path));
+}
+
 static Monitor *create_monitor_with_pos(MonitorsApplet *self, int pos)
 {
 	GSettings *settings = vala_panel_applet_get_settings(VALA_PANEL_APPLET(self));
 	if (pos == CPU_POS)
 	{
-		g_autofree char *color = g_settings_get_string(settings, CPU_CL);
-		int width              = g_settings_get_int(settings, CPU_WIDTH);
-		return monitor_create(GTK_BOX(gtk_bin_get_child(GTK_BIN(self))),
-		                      self,
-		                      cpu_update,
-		                      tooltip_update_cpu,
-		                      color,
-		                      width);
+		g_autofree char *color  = g_settings_get_string(settings, CPU_CL);
+		g_autofree char *spec   = g_settings_get_string(settings, CGROUP);
+		int width               = g_settings_get_int(settings, CPU_WIDTH);
+		ValaPanelCgroup *cgroup = monitor_open_cgroup(spec);
+		g_autofree char *metric = monitor_cgroup_metric(cgroup, "cpu");
+
+		/* Cgroup usage is kept apart from usage of the whole system */
+		Monitor *m = monitor_create(GTK_BOX(gtk_bin_get_child(GTK_BIN(self))),
+		                            self,
+		                            cpu_update,
+		                            tooltip_update_cpu,
+		                            metric,
+		                            VALA_PANEL_CPU_N_STATES,
+		                            color,
+		                            width,
+		                            0);
+		m->cgroup = cgroup;
+		vala_panel_graph_set_style(m->graph, VALA_PANEL_GRAPH_STACKED);
+		for (uint i = VALA_PANEL_CPU_NICE; i < VALA_PANEL_CPU_N_STATES; i++)
+		{
+			g_autofree char *spec =
+			    g_settings_get_string(settings, cpu_state_colors[i]);
+			monitor_set_series_color(m, i, spec);
+		}
+		return m;
 	}
 	if (pos == RAM_POS)
 	{
-		g_autofree char *color = g_settings_get_string(settings, RAM_CL);
-		int width              = g_settings_get_int(settings, RAM_WIDTH);
-		return monitor_create(GTK_BOX(gtk_bin_get_child(GTK_BIN(self))),
-		                      self,
-		                      update_mem,
-		                      tooltip_update_mem,
-		                      color,
-		                      width);
+		g_autofree char *color  = g_settings_get_string(settings, RAM_CL);
+		g_autofree char *spec   = g_settings_get_string(settings, CGROUP);
+		int width               = g_settings_get_int(settings, RAM_WIDTH);
+		ValaPanelCgroup *cgroup = monitor_open_cgroup(spec);
+		g_autofree char *metric = monitor_cgroup_metric(cgroup, "mem");
+
+		Monitor *m = monitor_create(GTK_BOX(gtk_bin_get_child(GTK_BIN(self))),
+		                            self,
+		                            update_mem,
+		                            tooltip_update_mem,
+		                            metric,
+		                            1,
+		                            color,
+		                            width,
+		                            0);
+		m->cgroup = cgroup;
+		return m;
 	}
 	if (pos == SWAP_POS)
 	{
@@ -134,23 +194,151 @@ static Monitor *create_monitor_with_pos(MonitorsApplet *self, int pos)
 		                      self,
 		                      update_swap,
 		                      tooltip_update_swap,
+		                      "swap",
+		                      1,
 		                      color,
-		                      width);
+		                      width,
+		                      0);
+	}
+	if (pos == DISK_POS)
+	{
+		g_autofree char *color   = g_settings_get_string(settings, DISK_READ_CL);
+		g_autofree char *write   = g_settings_get_string(settings, DISK_WRITE_CL);
+		g_autofree char *devices = g_settings_get_string(settings, DISK_DEVICES);
+		int width                = g_settings_get_int(settings, DISK_WIDTH);
+
+		/* One full scale for both series keeps their curves comparable */
+		Monitor *m = monitor_create(GTK_BOX(gtk_bin_get_child(GTK_BIN(self))),
+		                            self,
+		                            update_disk,
+		                            tooltip_update_disk,
+		                            "disk",
+		                            2,
+		                            color,
+		                            width,
+		                            DISK_MIN_FULL_SCALE);
+		monitor_set_series_color(m, DISK_WRITE, write);
+		vala_panel_sample_filter_init(&m->devices, devices);
+		return m;
+	}
+	if (pos == POWER_POS)
+	{
+		g_autofree char *color   = g_settings_get_string(settings, POWER_PACKAGE_CL);
+		g_autofree char *battery = g_settings_get_string(settings, POWER_BATTERY_CL);
+		int width                = g_settings_get_int(settings, POWER_WIDTH);
+
+		Monitor *m = monitor_create(GTK_BOX(gtk_bin_get_child(GTK_BIN(self))),
+		                            self,
+		                            update_power,
+		                            tooltip_update_power,
+		                            "power",
+		                            2,
+		                            color,
+		                            width,
+		                            POWER_MIN_FULL_SCALE);
+		monitor_set_series_color(m, POWER_BATTERY, battery);
+		return m;
+	}
+	if (pos >= PSI_CPU_POS && pos <= PSI_IO_POS)
+	{
+		static const char *const keys[][3] = {
+			{ PSI_CPU_CL, PSI_CPU_WIDTH, "psi-cpu" },
+			{ PSI_MEM_CL, PSI_MEM_WIDTH, "psi-memory" },
+			{ PSI_IO_CL, PSI_IO_WIDTH, "psi-io" },
+		};
+		ValaPanelPsiResource resource = VALA_PANEL_PSI_CPU + (pos - PSI_CPU_POS);
+		g_autofree char *color        = g_settings_get_string(settings, keys[resource][0]);
+		int width                     = g_settings_get_int(settings, keys[resource][1]);
+
+		Monitor *m = monitor_create(GTK_BOX(gtk_bin_get_child(GTK_BIN(self))),
+		                            self,
+		                            update_psi,
+		                            tooltip_update_psi,
+		                            keys[resource][2],
+		                            1,
+		                            color,
+		                            width,
+		                            0);
+		m->resource = resource;
+		return m;
+	}
+	if (pos == STREAM_POS)
+	{
+		g_autofree char *color   = g_settings_get_string(settings, STREAM_CL);
+		g_autofree char *command = g_settings_get_string(settings, STREAM_COMMAND);
+		int width                = g_settings_get_int(settings, STREAM_WIDTH);
+		int full_scale           = g_settings_get_int(settings, STREAM_FULL_SCALE);
+		double min_scale         = full_scale > 0 ? 0 : STREAM_MIN_FULL_SCALE;
+		/* Samples of another command, or of another scale, are not shown */
+		g_autofree char *key    = g_strdup_printf("%d:%s", full_scale, command);
+		g_autofree char *metric = g_strdup_printf("stream-%08x", g_str_hash(key));
+
+		Monitor *m = monitor_create(GTK_BOX(gtk_bin_get_child(GTK_BIN(self))),
+		                            self,
+		                            update_stream,
+		                            tooltip_update_stream,
+		                            metric,
+		                            1,
+		                            color,
+		                            width,
+		                            min_scale);
+		stream_monitor_start(m, command, full_scale);
+		return m;
 	}
 	return NULL;
 }
 
-static int monitors_update(void *data)
+static void monitors_update(const ValaPanelSnapshot *snapshot, void *data)
 {
 	MonitorsApplet *self = VALA_PANEL_MONITORS_APPLET(data);
-	if (g_source_is_destroyed(g_main_current_source()))
-		return false;
 	for (int i = 0; i < N_POS; i++)
 	{
 		if (self->monitors[i] != NULL)
-			monitor_update(self->monitors[i]);
+			monitor_update(self->monitors[i], snapshot);
 	}
-	return true;
+}
+
+static void on_visibility_change(GObject *owner, G_GNUC_UNUSED GParamSpec *pspec, void *data)
+{
+	MonitorsApplet *self = VALA_PANEL_MONITORS_APPLET(data);
+	vala_panel_sampler_follow_visibility(vala_panel_sampler_get_default(),
+	                                     self->sampler_id,
+	                                     VALA_PANEL_TOPLEVEL(owner));
+}
+
+/* Ask the shared sampler only for sources of displayed monitors */
+static void monitors_resubscribe(MonitorsApplet *self)
+{
+	ValaPanelSampler *sampler     = vala_panel_sampler_get_default();
+	ValaPanelSampleSource sources = VALA_PANEL_SAMPLE_NONE;
+	Monitor *cpu                  = self->monitors[CPU_POS];
+	/* Cgroup CPU monitor reads its counters itself, it needs only the ticks */
+	if (self->displayed_mons[CPU_POS])
+		sources |= cpu != NULL && cpu->cgroup != NULL ? VALA_PANEL_SAMPLE_CLOCK
+		                                              : VALA_PANEL_SAMPLE_CPU;
+	if (self->displayed_mons[RAM_POS] || self->displayed_mons[SWAP_POS])
+		sources |= VALA_PANEL_SAMPLE_MEM;
+	if (self->displayed_mons[DISK_POS])
+		sources |= VALA_PANEL_SAMPLE_DISK;
+	if (self->displayed_mons[POWER_POS])
+		sources |= VALA_PANEL_SAMPLE_POWER;
+	/* Process scanner thread runs only while its results are shown somewhere */
+	if (self->top_processes && (self->displayed_mons[CPU_POS] || self->displayed_mons[RAM_POS]))
+		sources |= VALA_PANEL_SAMPLE_PROCESSES;
+	if (self->displayed_mons[PSI_CPU_POS] || self->displayed_mons[PSI_MEM_POS] ||
+	    self->displayed_mons[PSI_IO_POS])
+		sources |= VALA_PANEL_SAMPLE_PRESSURE;
+	if (self->sampler_id)
+		vala_panel_sampler_unsubscribe(sampler, self->sampler_id);
+	self->sampler_id = 0;
+	if (sources != VALA_PANEL_SAMPLE_NONE)
+		self->sampler_id =
+		    vala_panel_sampler_subscribe(sampler, sources, monitors_update, self);
+	if (self->sampler_id)
+		vala_panel_sampler_set_fast(sampler, self->sampler_id, self->fast);
+	on_visibility_change(G_OBJECT(vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(self))),
+	                     NULL,
+	                     self);
 }
 
 static void rebuild_mon(MonitorsApplet *self, int i)
@@ -159,13 +347,40 @@ static void rebuild_mon(MonitorsApplet *self, int i)
 	{
 		self->monitors[i] = create_monitor_with_pos(self, i);
 		gtk_box_reorder_child(GTK_BOX(gtk_bin_get_child(GTK_BIN(self))),
-		                      GTK_WIDGET(self->monitors[i]->da),
+		                      GTK_WIDGET(self->monitors[i]->graph),
 		                      i);
 	}
 	else if (!self->displayed_mons[i] && self->monitors[i] != NULL)
 	{
 		g_clear_pointer(&self->monitors[i], monitor_dispose);
 	}
+	monitors_resubscribe(self);
+}
+
+static void on_psi_settings_changed(MonitorsApplet *self, GSettings *settings, const char *key)
+{
+	static const char *const keys[][3] = {
+		{ DISPLAY_PSI_CPU, PSI_CPU_CL, PSI_CPU_WIDTH },
+		{ DISPLAY_PSI_MEM, PSI_MEM_CL, PSI_MEM_WIDTH },
+		{ DISPLAY_PSI_IO, PSI_IO_CL, PSI_IO_WIDTH },
+	};
+	for (int i = 0; i < VALA_PANEL_PSI_N_RESOURCES; i++)
+	{
+		int pos    = PSI_CPU_POS + i;
+		Monitor *m = self->monitors[pos];
+		if (!g_strcmp0(key, keys[i][0]))
+		{
+			self->displayed_mons[pos] = g_settings_get_boolean(settings, key);
+			rebuild_mon(self, pos);
+		}
+		else if (!g_strcmp0(key, keys[i][1]) && m != NULL)
+		{
+			g_autofree char *color = g_settings_get_string(settings, key);
+			monitor_set_color(m, color);
+		}
+		else if (!g_strcmp0(key, keys[i][2]) && m != NULL)
+			monitor_setup_size(m, self, g_settings_get_int(settings, key));
+	}
 }
 
 void on_settings_changed(GSettings *settings, char *key, gpointer user_data)
@@ -179,7 +394,7 @@ void on_settings_changed(GSettings *settings, char *key, gpointer user_data)
 	else if ((!g_strcmp0(key, CPU_CL)) && self->monitors[CPU_POS] != NULL)
 	{
 		g_autofree char *color = g_settings_get_string(settings, CPU_CL);
-		gdk_rgba_parse(&self->monitors[CPU_POS]->foreground_color, color);
+		monitor_set_color(self->monitors[CPU_POS], color);
 	}
 	else if (!g_strcmp0(key, DISPLAY_RAM))
 	{
@@ -189,7 +404,7 @@ void on_settings_changed(GSettings *settings, char *key, gpointer user_data)
 	else if ((!g_strcmp0(key, RAM_CL)) && self->monitors[RAM_POS] != NULL)
 	{
 		g_autofree char *color = g_settings_get_string(settings, RAM_CL);
-		gdk_rgba_parse(&self->monitors[RAM_POS]->foreground_color, color);
+		monitor_set_color(self->monitors[RAM_POS], color);
 	}
 	else if (!g_strcmp0(key, DISPLAY_SWAP))
 	{
@@ -199,7 +414,7 @@ void on_settings_changed(GSettings *settings, char *key, gpointer user_data)
 	else if ((!g_strcmp0(key, SWAP_CL)) && self->monitors[SWAP_POS] != NULL)
 	{
 		g_autofree char *color = g_settings_get_string(settings, SWAP_CL);
-		gdk_rgba_parse(&self->monitors[SWAP_POS]->foreground_color, color);
+		monitor_set_color(self->monitors[SWAP_POS], color);
 	}
 	else if ((!g_strcmp0(key, CPU_WIDTH)) && self->monitors[CPU_POS] != NULL)
 	{
@@ -216,6 +431,105 @@ void on_settings_changed(GSettings *settings, char *key, gpointer user_data)
 		int width = g_settings_get_int(settings, SWAP_WIDTH);
 		monitor_setup_size(self->monitors[SWAP_POS], self, width);
 	}
+	else if (!g_strcmp0(key, DISPLAY_DISK))
+	{
+		self->displayed_mons[DISK_POS] = g_settings_get_boolean(settings, DISPLAY_DISK);
+		rebuild_mon(self, DISK_POS);
+	}
+	else if (!g_strcmp0(key, DISK_DEVICES) && self->monitors[DISK_POS] != NULL)
+	{
+		/* Devices are matched again on next snapshot, which restarts the deltas */
+		g_autofree char *devices = g_settings_get_string(settings, DISK_DEVICES);
+		vala_panel_sample_filter_clear(&self->monitors[DISK_POS]->devices);
+		vala_panel_sample_filter_init(&self->monitors[DISK_POS]->devices, devices);
+	}
+	else if (!g_strcmp0(key, DISK_READ_CL) && self->monitors[DISK_POS] != NULL)
+	{
+		g_autofree char *color = g_settings_get_string(settings, DISK_READ_CL);
+		monitor_set_series_color(self->monitors[DISK_POS], DISK_READ, color);
+	}
+	else if (!g_strcmp0(key, DISK_WRITE_CL) && self->monitors[DISK_POS] != NULL)
+	{
+		g_autofree char *color = g_settings_get_string(settings, DISK_WRITE_CL);
+		monitor_set_series_color(self->monitors[DISK_POS], DISK_WRITE, color);
+	}
+	else if (!g_strcmp0(key, DISK_WIDTH) && self->monitors[DISK_POS] != NULL)
+	{
+		int width = g_settings_get_int(settings, DISK_WIDTH);
+		monitor_setup_size(self->monitors[DISK_POS], self, width);
+	}
+	else if (!g_strcmp0(key, DISPLAY_POWER))
+	{
+		self->displayed_mons[POWER_POS] = g_settings_get_boolean(settings, DISPLAY_POWER);
+		rebuild_mon(self, POWER_POS);
+	}
+	else if (!g_strcmp0(key, POWER_PACKAGE_CL) && self->monitors[POWER_POS] != NULL)
+	{
+		g_autofree char *color = g_settings_get_string(settings, POWER_PACKAGE_CL);
+		monitor_set_series_color(self->monitors[POWER_POS], POWER_PACKAGE, color);
+	}
+	else if (!g_strcmp0(key, POWER_BATTERY_CL) && self->monitors[POWER_POS] != NULL)
+	{
+		g_autofree char *color = g_settings_get_string(settings, POWER_BATTERY_CL);
+		monitor_set_series_color(self->monitors[POWER_POS], POWER_BATTERY, color);
+	}
+	else if (!g_strcmp0(key, POWER_WIDTH) && self->monitors[POWER_POS] != NULL)
+	{
+		int width = g_settings_get_int(settings, POWER_WIDTH);
+		monitor_setup_size(self->monitors[POWER_POS], self, width);
+	}
+	else if (!g_strcmp0(key, FAST_SAMPLING))
+	{
+		self->fast = g_settings_get_boolean(settings, FAST_SAMPLING);
+		for (int i = 0; i < N_POS; i++)
+			if (self->monitors[i] != NULL)
+				vala_panel_graph_set_envelope(self->monitors[i]->graph, self->fast);
+		monitors_resubscribe(self);
+	}
+	else if (!g_strcmp0(key, TOP_PROCESSES))
+	{
+		self->top_processes = g_settings_get_boolean(settings, TOP_PROCESSES);
+		monitors_resubscribe(self);
+	}
+	else if (!g_strcmp0(key, DISPLAY_STREAM))
+	{
+		self->displayed_mons[STREAM_POS] = g_settings_get_boolean(settings, DISPLAY_STREAM);
+		rebuild_mon(self, STREAM_POS);
+	}
+	else if (!g_strcmp0(key, STREAM_COMMAND) || !g_strcmp0(key, STREAM_FULL_SCALE))
+	{
+		/* Child is restarted, with a history of this command and scale */
+		g_clear_pointer(&self->monitors[STREAM_POS], monitor_dispose);
+		rebuild_mon(self, STREAM_POS);
+	}
+	else if (!g_strcmp0(key, STREAM_CL) && self->monitors[STREAM_POS] != NULL)
+	{
+		g_autofree char *color = g_settings_get_string(settings, STREAM_CL);
+		monitor_set_color(self->monitors[STREAM_POS], color);
+	}
+	else if (!g_strcmp0(key, STREAM_WIDTH) && self->monitors[STREAM_POS] != NULL)
+	{
+		int width = g_settings_get_int(settings, STREAM_WIDTH);
+		monitor_setup_size(self->monitors[STREAM_POS], self, width);
+	}
+	else if (!g_strcmp0(key, CGROUP))
+	{
+		/* Recreated with a history of their own */
+		g_clear_pointer(&self->monitors[CPU_POS], monitor_dispose);
+		g_clear_pointer(&self->monitors[RAM_POS], monitor_dispose);
+		rebuild_mon(self, CPU_POS);
+		rebuild_mon(self, RAM_POS);
+	}
+	else
+		on_psi_settings_changed(self, settings, key);
+	for (uint i = VALA_PANEL_CPU_NICE; i < VALA_PANEL_CPU_N_STATES; i++)
+	{
+		if (!g_strcmp0(key, cpu_state_colors[i]) && self->monitors[CPU_POS] != NULL)
+		{
+			g_autofree char *color = g_settings_get_string(settings, key);
+			monitor_set_series_color(self->monitors[CPU_POS], i, color);
+		}
+	}
 }
 
 static void monitors_applet_constructed(GObject *obj)
@@ -227,16 +541,27 @@ static void monitors_applet_constructed(GObject *obj)
 	g_simple_action_set_enabled(
 	    G_SIMPLE_ACTION(g_action_map_lookup_action(map, VALA_PANEL_APPLET_ACTION_CONFIGURE)),
 	    true);
-	GtkBox *box                    = GTK_BOX(gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 2));
-	self->displayed_mons[CPU_POS]  = g_settings_get_boolean(settings, DISPLAY_CPU);
-	self->displayed_mons[RAM_POS]  = g_settings_get_boolean(settings, DISPLAY_RAM);
-	self->displayed_mons[SWAP_POS] = g_settings_get_boolean(settings, DISPLAY_SWAP);
+	GtkBox *box                       = GTK_BOX(gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 2));
+	self->displayed_mons[CPU_POS]     = g_settings_get_boolean(settings, DISPLAY_CPU);
+	self->displayed_mons[RAM_POS]     = g_settings_get_boolean(settings, DISPLAY_RAM);
+	self->displayed_mons[SWAP_POS]    = g_settings_get_boolean(settings, DISPLAY_SWAP);
+	self->displayed_mons[DISK_POS]    = g_settings_get_boolean(settings, DISPLAY_DISK);
+	self->displayed_mons[POWER_POS]   = g_settings_get_boolean(settings, DISPLAY_POWER);
+	self->displayed_mons[PSI_CPU_POS] = g_settings_get_boolean(settings, DISPLAY_PSI_CPU);
+	self->displayed_mons[PSI_MEM_POS] = g_settings_get_boolean(settings, DISPLAY_PSI_MEM);
+	self->displayed_mons[PSI_IO_POS]  = g_settings_get_boolean(settings, DISPLAY_PSI_IO);
+	self->displayed_mons[STREAM_POS]  = g_settings_get_boolean(settings, DISPLAY_STREAM);
+	self->fast                        = g_settings_get_boolean(settings, FAST_SAMPLING);
+	self->top_processes               = g_settings_get_boolean(settings, TOP_PROCESSES);
 	gtk_container_add(GTK_CONTAINER(self), GTK_WIDGET(box));
 	gtk_widget_show(GTK_WIDGET(box));
 	for (int i = 0; i < N_POS; i++)
 		rebuild_mon(self, i);
-	self->timer = g_timeout_add_seconds(UPDATE_PERIOD, (GSourceFunc)monitors_update, self);
 	g_signal_connect(settings, "changed", G_CALLBACK(on_settings_changed), self);
+	g_signal_connect(vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(self)),
+	                 "notify::" VALA_PANEL_KEY_VISIBILITY,
+	                 G_CALLBACK(on_visibility_change),
+	                 self);
 	gtk_widget_show(GTK_WIDGET(self));
 }
 
@@ -246,9 +571,24 @@ static GtkWidget *monitors_get_settings_ui(ValaPanelApplet *base)
 	                             _("Display CPU usage"),
 	                             DISPLAY_CPU,
 	                             CONF_BOOL,
-	                             _("CPU color"),
+	                             _("CPU user color"),
 	                             CPU_CL,
 	                             CONF_STR,
+	                             _("CPU nice color"),
+	                             CPU_NICE_CL,
+	                             CONF_STR,
+	                             _("CPU system color"),
+	                             CPU_SYSTEM_CL,
+	                             CONF_STR,
+	                             _("CPU interrupts color"),
+	                             CPU_IRQ_CL,
+	                             CONF_STR,
+	                             _("CPU steal color"),
+	                             CPU_STEAL_CL,
+	                             CONF_STR,
+	                             _("CPU I/O wait color"),
+	                             CPU_IOWAIT_CL,
+	                             CONF_STR,
 	                             _("CPU width"),
 	                             CPU_WIDTH,
 	                             CONF_INT,
@@ -270,6 +610,84 @@ static GtkWidget *monitors_get_settings_ui(ValaPanelApplet *base)
 	                             _("Swap width"),
 	                             SWAP_WIDTH,
 	                             CONF_INT,
+	                             _("Display disk throughput"),
+	                             DISPLAY_DISK,
+	                             CONF_BOOL,
+	                             _("Disks, or patterns like sd[a-z],nvme*n1"),
+	                             DISK_DEVICES,
+	                             CONF_STR,
+	                             _("Disk read color"),
+	                             DISK_READ_CL,
+	                             CONF_STR,
+	                             _("Disk write color"),
+	                             DISK_WRITE_CL,
+	                             CONF_STR,
+	                             _("Disk width"),
+	                             DISK_WIDTH,
+	                             CONF_INT,
+	                             _("Display power draw"),
+	                             DISPLAY_POWER,
+	                             CONF_BOOL,
+	                             _("CPU package power color"),
+	                             POWER_PACKAGE_CL,
+	                             CONF_STR,
+	                             _("Battery discharge color"),
+	                             POWER_BATTERY_CL,
+	                             CONF_STR,
+	                             _("Power width"),
+	                             POWER_WIDTH,
+	                             CONF_INT,
+	                             _("Display CPU pressure"),
+	                             DISPLAY_PSI_CPU,
+	                             CONF_BOOL,
+	                             _("CPU pressure color"),
+	                             PSI_CPU_CL,
+	                             CONF_STR,
+	                             _("CPU pressure width"),
+	                             PSI_CPU_WIDTH,
+	                             CONF_INT,
+	                             _("Display memory pressure"),
+	                             DISPLAY_PSI_MEM,
+	                             CONF_BOOL,
+	                             _("Memory pressure color"),
+	                             PSI_MEM_CL,
+	                             CONF_STR,
+	                             _("Memory pressure width"),
+	                             PSI_MEM_WIDTH,
+	                             CONF_INT,
+	                             _("Display I/O pressure"),
+	                             DISPLAY_PSI_IO,
+	                             CONF_BOOL,
+	                             _("I/O pressure color"),
+	                             PSI_IO_CL,
+	                             CONF_STR,
+	                             _("I/O pressure width"),
+	                             PSI_IO_WIDTH,
+	                             CONF_INT,
+	                             _("Display values streamed by a command"),
+	                             DISPLAY_STREAM,
+	                             CONF_BOOL,
+	                             _("Command printing one number per line"),
+	                             STREAM_COMMAND,
+	                             CONF_STR,
+	                             _("Full scale of streamed values, 0 to follow them"),
+	                             STREAM_FULL_SCALE,
+	                             CONF_INT,
+	                             _("Stream color"),
+	                             STREAM_CL,
+	                             CONF_STR,
+	                             _("Stream width"),
+	                             STREAM_WIDTH,
+	                             CONF_INT,
+	                             _("Sample ten times per second, showing bursts"),
+	                             FAST_SAMPLING,
+	                             CONF_BOOL,
+	                             _("Show top processes in CPU and RAM tooltips"),
+	                             TOP_PROCESSES,
+	                             CONF_BOOL,
+	                             _("Cgroup for CPU and RAM, like \"self\", or empty"),
+	                             CGROUP,
+	                             CONF_STR,
 	                             _("Action when clicked"),
 	                             ACTION,
 	                             CONF_STR,
@@ -283,11 +701,13 @@ static void monitors_applet_dispose(GObject *user_data)
 	GSettings *settings = vala_panel_applet_get_settings(VALA_PANEL_APPLET(c));
 	/* Disconnect the signals. */
 	g_signal_handlers_disconnect_by_data(settings, c);
-	/* Disconnect the timer. */
-	if (c->timer)
+	g_signal_handlers_disconnect_by_data(vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(c)),
+	                                     c);
+	/* Disconnect from the sampler. */
+	if (c->sampler_id)
 	{
-		g_source_remove(c->timer);
-		c->timer = 0;
+		vala_panel_sampler_unsubscribe(vala_panel_sampler_get_default(), c->sampler_id);
+		c->sampler_id = 0;
 	}
 	/* Freeing all monitors */
 	for (int i = 0; i < N_POS; i++)
@@ -0,0 +1,72 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+
+#include "psi.h"
+
+/*
+ * Pressure stall monitor functions
+ */
+
+static const char *psi_labels[VALA_PANEL_PSI_N_RESOURCES] = {
+	N_("CPU pressure"),
+	N_("Memory pressure"),
+	N_("I/O pressure"),
+};
+
+/* Share of elapsed wall time which tasks spent stalled */
+static double psi_fraction(guint64 stalled, gint64 elapsed)
+{
+	return elapsed > 0 ? MIN((double)stalled / elapsed, 1.0) : 0.0;
+}
+
+G_GNUC_INTERNAL bool update_psi(Monitor *m, const ValaPanelSnapshot *snapshot)
+{
+	if (!(snapshot->valid & VALA_PANEL_SAMPLE_PRESSURE) ||
+	    !(snapshot->pressure_valid & (1u << m->resource)))
+		return false;
+
+	const ValaPanelPsiSample *psi = &snapshot->pressure[m->resource];
+	bool column                   = false;
+	/* First sample only primes totals, they are counted from boot */
+	if (m->previous_time != 0)
+	{
+		gint64 elapsed = snapshot->time - m->previous_time;
+		double value   = psi_fraction(psi->some_total - m->previous_psi.some_total, elapsed);
+		m->full        = psi_fraction(psi->full_total - m->previous_psi.full_total, elapsed);
+		column         = vala_panel_graph_push_at(m->graph, &value, snapshot->time);
+	}
+	m->previous_psi  = *psi;
+	m->previous_time = snapshot->time;
+	return column;
+}
+
+G_GNUC_INTERNAL void tooltip_update_psi(Monitor *m,
+                                        G_GNUC_UNUSED const ValaPanelSnapshot *snapshot)
+{
+	if (m != NULL && m->graph != NULL)
+	{
+		g_autofree char *tooltip_txt =
+		    g_strdup_printf(_("%s: some %.2f%%, full %.2f%%"),
+		                    _(psi_labels[m->resource]),
+		                    vala_panel_graph_get_last(m->graph, 0) * 100,
+		                    m->full * 100);
+		gtk_widget_set_tooltip_text(GTK_WIDGET(m->graph), tooltip_txt);
+	}
+}
@@ -0,0 +1,41 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PSI_H
+#define PSI_H
+
+#include "monitor.h"
+
+G_BEGIN_DECLS
+
+#define DISPLAY_PSI_CPU "display-psi-cpu-monitor"
+#define PSI_CPU_CL "psi-cpu-color"
+#define PSI_CPU_WIDTH "psi-cpu-width"
+#define DISPLAY_PSI_MEM "display-psi-memory-monitor"
+#define PSI_MEM_CL "psi-memory-color"
+#define PSI_MEM_WIDTH "psi-memory-width"
+#define DISPLAY_PSI_IO "display-psi-io-monitor"
+#define PSI_IO_CL "psi-io-color"
+#define PSI_IO_WIDTH "psi-io-width"
+
+G_GNUC_INTERNAL bool update_psi(Monitor *m, const ValaPanelSnapshot *snapshot);
+G_GNUC_INTERNAL void tooltip_update_psi(Monitor *m, const ValaPanelSnapshot *snapshot);
+
+G_END_DECLS
+
+#endif // PSI_H
@@ -0,0 +1,69 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+
+#include "stream.h"
+
+/*
+ * Streaming command monitor functions
+ */
+
+static void stream_sample(double value, gint64 time, gpointer data)
+{
+	Monitor *m = (Monitor *)data;
+	/* Autoscaled graph takes raw values */
+	double scaled = m->total > 0 ? CLAMP(value / m->total, 0.0, 1.0) : MAX(value, 0.0);
+	if (vala_panel_graph_push_at(m->graph, &scaled, time))
+		tooltip_update_stream(m, NULL);
+}
+
+G_GNUC_INTERNAL void stream_monitor_start(Monitor *m, const char *command, int full_scale)
+{
+	g_autoptr(GError) error = NULL;
+	m->total                = MAX(full_scale, 0);
+	if (command != NULL && *command != '\0')
+		m->stream = vala_panel_child_stream_start(command, stream_sample, m, &error);
+	if (error != NULL)
+		g_warning("monitors: Cannot run \"%s\": %s", command, error->message);
+	tooltip_update_stream(m, NULL);
+}
+
+G_GNUC_INTERNAL bool update_stream(G_GNUC_UNUSED Monitor *m,
+                                   G_GNUC_UNUSED const ValaPanelSnapshot *snapshot)
+{
+	return false;
+}
+
+G_GNUC_INTERNAL void tooltip_update_stream(Monitor *m,
+                                           G_GNUC_UNUSED const ValaPanelSnapshot *snapshot)
+{
+	if (m == NULL || m->graph == NULL)
+		return;
+	if (m->stream == NULL)
+	{
+		gtk_widget_set_tooltip_text(GTK_WIDGET(m->graph), _("No command to stream from"));
+		return;
+	}
+	double value = vala_panel_graph_get_last(m->graph, 0);
+	if (m->total > 0)
+		value *= m->total;
+	g_autofree char *tooltip_txt =
+	    g_strdup_printf("%s: %g", vala_panel_child_stream_get_command(m->stream), value);
+	gtk_widget_set_tooltip_text(GTK_WIDGET(m->graph), tooltip_txt);
+}
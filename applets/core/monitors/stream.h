@@ -0,0 +1,43 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "monitor.h"
+
+G_BEGIN_DECLS
+
+#define DISPLAY_STREAM "display-stream-monitor"
+#define STREAM_COMMAND "stream-command"
+#define STREAM_FULL_SCALE "stream-full-scale"
+#define STREAM_CL "stream-color"
+#define STREAM_WIDTH "stream-width"
+
+#define STREAM_MIN_FULL_SCALE 1e-9 /* Keeps small values, like latencies in seconds, visible */
+
+/* Samples come from the child, so snapshots of the sampler are ignored */
+G_GNUC_INTERNAL bool update_stream(Monitor *m, const ValaPanelSnapshot *snapshot);
+G_GNUC_INTERNAL void tooltip_update_stream(Monitor *m, const ValaPanelSnapshot *snapshot);
+/* Runs @command for graph of @m, values are divided by @full_scale unless it is 0,
+ * then graph must be autoscaled from %STREAM_MIN_FULL_SCALE before history is set */
+G_GNUC_INTERNAL void stream_monitor_start(Monitor *m, const char *command, int full_scale);
+
+G_END_DECLS
+
+#endif // STREAM_H
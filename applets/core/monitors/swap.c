@@ -16,59 +16,20 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <errno.h>
 #include <stdbool.h>
-#include <stdio.h>
 
 #include "swap.h"
 
 /*
  * Memory monitor functions
  */
-G_GNUC_INTERNAL bool update_swap(Monitor *m)
+G_GNUC_INTERNAL bool update_swap(Monitor *m, const ValaPanelSnapshot *snapshot)
 {
-	char buf[80];
-	long swap_total  = 0;
-	long swap_free   = 0;
-	long swap_cached = 0;
-	uint readmask    = 0x4 | 0x2 | 0x1;
-	if (m->stats == NULL || m->pixmap == NULL)
-		return true;
-	FILE *meminfo = fopen("/proc/meminfo", "r");
-	if (meminfo == NULL)
-	{
-		g_warning("monitors: Could not open /proc/meminfo: %d, %s", errno, strerror(errno));
-		return false;
-	}
-
-	while (readmask != 0 && fgets(buf, 80, meminfo) != NULL)
-	{
-		if (sscanf(buf, "SwapTotal: %ld kB\n", &swap_total) == 1)
-		{
-			readmask ^= 0x1;
-			continue;
-		}
-		if (sscanf(buf, "SwapFree: %ld kB\n", &swap_free) == 1)
-		{
-			readmask ^= 0x2;
-			continue;
-		}
-		if (sscanf(buf, "SwapCached: %ld kB\n", &swap_cached) == 1)
-		{
-			readmask ^= 0x4;
-			continue;
-		}
-	}
-	fclose(meminfo);
-
-	if (readmask != 0)
-	{
-		g_warning("monitors: Could not read all values from /proc/meminfo:\n readmask %x",
-		          readmask);
+	if (!(snapshot->valid & VALA_PANEL_SAMPLE_MEM))
 		return false;
-	}
 
-	m->total = swap_total;
+	const ValaPanelMemSample *mem = &snapshot->mem;
+	m->total                      = mem->swap_total;
 	/* Adding stats to the buffer:
 	 * It is hard to draw the line, which caches should be counted as free,
 	 * and which not. Pagecaches, dentry, and inode caches are quickly
@@ -76,28 +37,21 @@ G_GNUC_INTERNAL bool update_swap(Monitor *m)
 	 * them as 'free'.
 	 * 'swap_cached' definitely counts as 'free' because it is immediately
 	 * released should any application need it. */
-	m->stats[m->ring_cursor] = (swap_total - swap_free - swap_cached) / (double)swap_total;
-
-	m->ring_cursor += 1;
-	if (m->ring_cursor >= m->pixmap_width)
-		m->ring_cursor = 0;
-	/* Redraw the pixmap, with the new sample */
-	monitor_redraw_pixmap(m);
-	return true;
+	double value =
+	    ((double)mem->swap_total - mem->swap_free - mem->swap_cached) / mem->swap_total;
+	return vala_panel_graph_push_at(m->graph, &value, snapshot->time);
 }
 
-G_GNUC_INTERNAL void tooltip_update_swap(Monitor *m)
+G_GNUC_INTERNAL void tooltip_update_swap(Monitor *m,
+                                         G_GNUC_UNUSED const ValaPanelSnapshot *snapshot)
 {
-	if (m != NULL && m->stats != NULL)
+	if (m != NULL && m->graph != NULL)
 	{
-		int ring_pos = (m->ring_cursor == 0) ? m->pixmap_width - 1 : m->ring_cursor - 1;
-		if (m->da != NULL && m->stats != NULL)
-		{
-			g_autofree char *tooltip_txt =
-			    g_strdup_printf(_("Swap usage: %.1fMB (%.2f%%)"),
-			                    m->stats[ring_pos] * m->total / 1024,
-			                    m->stats[ring_pos] * 100);
-			gtk_widget_set_tooltip_text(GTK_WIDGET(m->da), tooltip_txt);
-		}
+		double value = vala_panel_graph_get_last(m->graph, 0);
+		g_autofree char *tooltip_txt =
+		    g_strdup_printf(_("Swap usage: %.1fMB (%.2f%%)"),
+		                    value * m->total / 1024,
+		                    value * 100);
+		gtk_widget_set_tooltip_text(GTK_WIDGET(m->graph), tooltip_txt);
 	}
 }
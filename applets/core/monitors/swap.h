@@ -27,8 +27,8 @@ G_BEGIN_DECLS
 #define SWAP_CL "swap-color"
 #define SWAP_WIDTH "swap-width"
 
-G_GNUC_INTERNAL bool update_swap(Monitor *m);
-G_GNUC_INTERNAL void tooltip_update_swap(Monitor *m);
+G_GNUC_INTERNAL bool update_swap(Monitor *m, const ValaPanelSnapshot *snapshot);
+G_GNUC_INTERNAL void tooltip_update_swap(Monitor *m, const ValaPanelSnapshot *snapshot);
 
 G_END_DECLS
 
@@ -23,38 +23,52 @@
 #include <gtk/gtk.h>
 #include <stdbool.h>
 
+#include "sampler.h"
+#include "util-gtk.h"
+
 G_BEGIN_DECLS
 
+#define NET_SAMPLE_COUNT 5
+#define NET_MIN_FULL_SCALE 10000 /* Bytes per second */
+
+/* Graph series */
+#define NET_RX 0
+#define NET_TX 1
+
 struct mon;
 
-typedef bool (*update_func)(struct mon *);
+/* Returns whether graph got a new column */
+typedef bool (*update_func)(struct mon *, const ValaPanelSnapshot *);
+
+struct net_stat
+{
+	long long last_down, last_up;
+	gint64 last_time; /* Monotonic time of last_down and last_up */
+	bool up;          /* Any link was operational on last sample */
+	int cur_idx;
+	long long down[NET_SAMPLE_COUNT], up[NET_SAMPLE_COUNT];
+	double seconds[NET_SAMPLE_COUNT]; /* Real length of every sample */
+	double down_rate, up_rate; /* Bytes per second */
+	bool initialized;
+};
 typedef void (*tooltip_update_func)(struct mon *);
 
 typedef struct mon
 {
-	GtkDrawingArea *da;      /* Drawing area                           */
-	cairo_surface_t *pixmap; /* Pixmap to be drawn on drawing area     */
-	int pixmap_width;        /* Width and size of the buffer           */
-	int pixmap_height;       /* Does not include border size           */
-	bool use_bar;
+	ValaPanelGraph *graph; /* Graph of RX and TX rates, also a drawing area */
 	int average_samples;
-	char *interface_name;
-	GdkRGBA rx_color;    /* Foreground color for drawing area      */
-	GdkRGBA tx_color;    /* Foreground color for drawing area      */
-	double *up_stats;    /* Circular buffer of values              */
-	double up_current;   /* Maximum possible value, as in mem_total*/
-	double *down_stats;  /* Circular buffer of values              */
-	double down_current; /* Maximum possible value, as in mem_total*/
-	int ring_cursor;     /* Cursor for ring/circular buffer        */
+	char *interface_name;         /* Name or glob patterns */
+	ValaPanelSampleFilter filter; /* Links which are summed, picked by interface_name */
+	struct net_stat net;          /* Counters state of this instance */
 	update_func update;
 	tooltip_update_func tooltip_update;
 } NetMon;
 
 G_GNUC_INTERNAL void netmon_init_no_height(NetMon *mon, const char *rx_color, const char *tx_color);
-G_GNUC_INTERNAL void netmon_redraw_pixmap(NetMon *mon);
-G_GNUC_INTERNAL bool netmon_update(NetMon *mon);
+G_GNUC_INTERNAL void netmon_set_color(NetMon *mon, uint series, const char *color);
+G_GNUC_INTERNAL void netmon_set_use_bar(NetMon *mon, bool use_bar);
+G_GNUC_INTERNAL bool netmon_update(NetMon *mon, const ValaPanelSnapshot *snapshot);
 G_GNUC_INTERNAL void netmon_dispose(NetMon *mon);
-G_GNUC_INTERNAL bool netmon_resize(GtkWidget *widget, NetMon *mon);
 
 G_END_DECLS
 
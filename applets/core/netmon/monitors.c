@@ -21,7 +21,6 @@
 #include "net.h"
 
 #define DEFAULT_WIDTH 40 /* Pixels               */
-#define UPDATE_PERIOD 1  /* Seconds */
 
 #define ACTION "click-action"
 
@@ -34,8 +33,10 @@ enum
 struct _NetMonApplet
 {
 	ValaPanelApplet _parent_;
-	NetMon *monitor;
-	uint timer;
+	GPtrArray *monitors;          /* Of NetMon, one per matching link in per-interface mode */
+	ValaPanelSampleFilter filter; /* Picks links for graphs, only in per-interface mode */
+	bool per_interface;
+	uint sampler_id;
 };
 
 G_DEFINE_DYNAMIC_TYPE(NetMonApplet, netmon_applet, vala_panel_applet_get_type())
@@ -67,8 +68,7 @@ static void monitor_setup_size(NetMon *mon, NetMonApplet *pl, int width)
 	             VALA_PANEL_KEY_HEIGHT,
 	             &height,
 	             NULL);
-	gtk_widget_set_size_request(GTK_WIDGET(mon->da), width, height);
-	netmon_resize(GTK_WIDGET(mon->da), mon);
+	gtk_widget_set_size_request(GTK_WIDGET(mon->graph), width, height);
 }
 
 static void monitor_init(NetMon *mon, NetMonApplet *pl, const char *rx_color, const char *tx_color,
@@ -76,23 +76,33 @@ static void monitor_init(NetMon *mon, NetMonApplet *pl, const char *rx_color, co
 {
 	netmon_init_no_height(mon, rx_color, tx_color);
 	monitor_setup_size(mon, pl, width);
-	g_signal_connect(mon->da, "button-release-event", G_CALLBACK(button_release_event), pl);
+	g_signal_connect(mon->graph, "button-release-event", G_CALLBACK(button_release_event), pl);
 }
 
 static NetMon *monitor_create(GtkBox *monitor_box, NetMonApplet *pl, update_func update,
                               tooltip_update_func tooltip_update, const char *interface_name,
                               const char *rx_color, const char *tx_color, int width,
-                              int average_samples, bool use_bar)
+                              int average_samples, bool use_bar, bool fast)
 {
 	NetMon *m = g_new0(NetMon, 1);
 	monitor_init(m, pl, rx_color, tx_color, width);
 	m->interface_name  = (char *)interface_name;
 	m->average_samples = average_samples;
-	m->use_bar         = use_bar;
 	m->update          = update;
 	m->tooltip_update  = tooltip_update;
-	gtk_box_pack_start(GTK_BOX(monitor_box), GTK_WIDGET(m->da), false, false, 0);
-	gtk_widget_show(GTK_WIDGET(m->da));
+	vala_panel_sample_filter_init(&m->filter, interface_name);
+	netmon_set_use_bar(m, use_bar);
+	/* Links come and go, containers make a new veth each start, and a file per
+	 * name would pile up in the cache, so only the summed graph is persistent */
+	if (!pl->per_interface)
+	{
+		const char *uuid      = vala_panel_applet_get_uuid(VALA_PANEL_APPLET(pl));
+		g_autofree char *name = g_strdup_printf("%s-net-%s", uuid, interface_name);
+		vala_panel_graph_set_history(m->graph, name);
+	}
+	vala_panel_graph_set_envelope(m->graph, fast);
+	gtk_box_pack_start(GTK_BOX(monitor_box), GTK_WIDGET(m->graph), false, false, 0);
+	gtk_widget_show(GTK_WIDGET(m->graph));
 	return m;
 }
 
@@ -100,15 +110,16 @@ static NetMon *monitor_create(GtkBox *monitor_box, NetMonApplet *pl, update_func
  * Applet functions
  */
 
-static NetMon *create_monitor(NetMonApplet *self)
+/* Takes ownership of interface_name */
+static NetMon *create_monitor(NetMonApplet *self, char *interface_name)
 {
 	GSettings *settings       = vala_panel_applet_get_settings(VALA_PANEL_APPLET(self));
 	g_autofree char *rx_color = g_settings_get_string(settings, NET_RX_CL);
 	g_autofree char *tx_color = g_settings_get_string(settings, NET_TX_CL);
-	char *interface_name      = g_settings_get_string(settings, NET_IFACE);
 	int width                 = g_settings_get_int(settings, NET_WIDTH);
 	int average_samples       = g_settings_get_int(settings, NET_AVERAGE_SAMPLES);
 	bool use_bar              = g_settings_get_boolean(settings, NET_USE_BAR);
+	bool fast                 = g_settings_get_boolean(settings, NET_FAST_SAMPLING);
 	return monitor_create(GTK_BOX(gtk_bin_get_child(GTK_BIN(self))),
 	                      self,
 	                      update_net,
@@ -118,56 +129,133 @@ static NetMon *create_monitor(NetMonApplet *self)
 	                      tx_color,
 	                      width,
 	                      average_samples,
-	                      use_bar);
+	                      use_bar,
+	                      fast);
 }
 
-static int monitors_update(void *data)
+/* Keeps one graph per matching link, in kernel order, reusing graphs of links kept by name */
+static void reconcile_monitors(NetMonApplet *self, const ValaPanelSnapshot *snapshot)
+{
+	GtkBox *box       = GTK_BOX(gtk_bin_get_child(GTK_BIN(self)));
+	GArray *positions = self->filter.positions;
+	GPtrArray *stale  = self->monitors;
+	self->monitors    = g_ptr_array_new_with_free_func((GDestroyNotify)netmon_dispose);
+	g_ptr_array_set_free_func(stale, NULL);
+	for (uint i = 0; i < positions->len; i++)
+	{
+		const char *name = snapshot->net[g_array_index(positions, uint, i)].name;
+		NetMon *mon      = NULL;
+		for (uint j = 0; j < stale->len && mon == NULL; j++)
+		{
+			NetMon *old = g_ptr_array_index(stale, j);
+			if (!g_strcmp0(old->interface_name, name))
+				mon = g_ptr_array_remove_index_fast(stale, j);
+		}
+		if (mon == NULL)
+			mon = create_monitor(self, g_strdup(name));
+		gtk_box_reorder_child(box, GTK_WIDGET(mon->graph), (int)i);
+		g_ptr_array_add(self->monitors, mon);
+	}
+	/* Graphs of links which went away */
+	g_ptr_array_set_free_func(stale, (GDestroyNotify)netmon_dispose);
+	g_ptr_array_unref(stale);
+}
+
+static void monitors_update(const ValaPanelSnapshot *snapshot, void *data)
 {
 	NetMonApplet *self = VALA_PANEL_NETMON_APPLET(data);
-	if (g_source_is_destroyed(g_main_current_source()))
-		return false;
-	netmon_update(self->monitor);
-	return true;
+	/* Digest of the snapshot makes this a no-op until links appear, go or get renamed */
+	if (self->per_interface && (snapshot->valid & VALA_PANEL_SAMPLE_NET) &&
+	    vala_panel_sample_filter_update_net(&self->filter,
+	                                        snapshot->net,
+	                                        snapshot->n_net,
+	                                        snapshot->net_digest))
+		reconcile_monitors(self, snapshot);
+	for (uint i = 0; i < self->monitors->len; i++)
+		netmon_update(g_ptr_array_index(self->monitors, i), snapshot);
+}
+
+static void on_visibility_change(GObject *owner, G_GNUC_UNUSED GParamSpec *pspec, void *data)
+{
+	NetMonApplet *self = VALA_PANEL_NETMON_APPLET(data);
+	bool paused        = vala_panel_sampler_follow_visibility(vala_panel_sampler_get_default(),
+	                                                          self->sampler_id,
+	                                                          VALA_PANEL_TOPLEVEL(owner));
+	/* Byte counts gathered over the pause are not a rate, do not graph them */
+	for (uint i = 0; paused && i < self->monitors->len; i++)
+		restart_net(g_ptr_array_index(self->monitors, i));
 }
 
 static void rebuild_mon(NetMonApplet *self)
 {
-	g_clear_pointer(&self->monitor, netmon_dispose);
-	self->monitor = create_monitor(self);
+	GSettings *settings   = vala_panel_applet_get_settings(VALA_PANEL_APPLET(self));
+	g_autofree char *name = g_settings_get_string(settings, NET_IFACE);
+	g_ptr_array_set_size(self->monitors, 0);
+	vala_panel_sample_filter_clear(&self->filter);
+	self->per_interface = g_settings_get_boolean(settings, NET_PER_INTERFACE);
+	/* Graphs of separate links are made by first snapshot, which lists them */
+	if (self->per_interface)
+		vala_panel_sample_filter_init(&self->filter, name);
+	else
+		g_ptr_array_add(self->monitors, create_monitor(self, g_steal_pointer(&name)));
 }
 
-void on_settings_changed(GSettings *settings, char *key, gpointer user_data)
+static void monitor_apply_setting(NetMonApplet *self, NetMon *mon, GSettings *settings,
+                                  const char *key)
 {
-	g_return_if_fail(VALA_PANEL_IS_NETMON_APPLET(user_data));
-	NetMonApplet *self = VALA_PANEL_NETMON_APPLET(user_data);
-	if (!g_strcmp0(key, NET_IFACE))
-	{
-		rebuild_mon(self);
-	}
-	else if (!g_strcmp0(key, NET_RX_CL))
+	if (!g_strcmp0(key, NET_RX_CL))
 	{
 		g_autofree char *color = g_settings_get_string(settings, NET_RX_CL);
-		gdk_rgba_parse(&self->monitor->rx_color, color);
+		netmon_set_color(mon, NET_RX, color);
 	}
 	else if (!g_strcmp0(key, NET_TX_CL))
 	{
 		g_autofree char *color = g_settings_get_string(settings, NET_TX_CL);
-		gdk_rgba_parse(&self->monitor->tx_color, color);
+		netmon_set_color(mon, NET_TX, color);
 	}
 	else if (!g_strcmp0(key, NET_WIDTH))
 	{
 		int width = g_settings_get_int(settings, NET_WIDTH);
-		monitor_setup_size(self->monitor, self, width);
+		monitor_setup_size(mon, self, width);
 	}
 	else if (!g_strcmp0(key, NET_AVERAGE_SAMPLES))
 	{
-		int width                      = g_settings_get_int(settings, NET_AVERAGE_SAMPLES);
-		self->monitor->average_samples = width;
+		int width            = g_settings_get_int(settings, NET_AVERAGE_SAMPLES);
+		mon->average_samples = width;
 	}
 	else if (!g_strcmp0(key, NET_USE_BAR))
 	{
-		bool use_bar           = g_settings_get_boolean(settings, NET_USE_BAR);
-		self->monitor->use_bar = use_bar;
+		bool use_bar = g_settings_get_boolean(settings, NET_USE_BAR);
+		netmon_set_use_bar(mon, use_bar);
+	}
+	else if (!g_strcmp0(key, NET_FAST_SAMPLING))
+	{
+		bool fast = g_settings_get_boolean(settings, NET_FAST_SAMPLING);
+		vala_panel_graph_set_envelope(mon->graph, fast);
+	}
+}
+
+void on_settings_changed(GSettings *settings, char *key, gpointer user_data)
+{
+	g_return_if_fail(VALA_PANEL_IS_NETMON_APPLET(user_data));
+	NetMonApplet *self = VALA_PANEL_NETMON_APPLET(user_data);
+	if (!g_strcmp0(key, NET_IFACE) || !g_strcmp0(key, NET_PER_INTERFACE))
+	{
+		rebuild_mon(self);
+	}
+	else
+	{
+		for (uint i = 0; i < self->monitors->len; i++)
+		{
+			NetMon *mon = g_ptr_array_index(self->monitors, i);
+			monitor_apply_setting(self, mon, settings, key);
+		}
+	}
+	if (!g_strcmp0(key, NET_FAST_SAMPLING))
+	{
+		ValaPanelSampler *sampler = vala_panel_sampler_get_default();
+		bool fast                 = g_settings_get_boolean(settings, NET_FAST_SAMPLING);
+		vala_panel_sampler_set_fast(sampler, self->sampler_id, fast);
 	}
 }
 
@@ -184,17 +272,33 @@ static void netmon_applet_constructed(GObject *obj)
 	gtk_container_add(GTK_CONTAINER(self), GTK_WIDGET(box));
 	gtk_widget_show(GTK_WIDGET(box));
 	rebuild_mon(self);
-	self->timer = g_timeout_add_seconds(UPDATE_PERIOD, (GSourceFunc)monitors_update, self);
+	self->sampler_id = vala_panel_sampler_subscribe(vala_panel_sampler_get_default(),
+	                                                VALA_PANEL_SAMPLE_NET,
+	                                                monitors_update,
+	                                                self);
+	vala_panel_sampler_set_fast(vala_panel_sampler_get_default(),
+	                            self->sampler_id,
+	                            g_settings_get_boolean(settings, NET_FAST_SAMPLING));
 	g_signal_connect(settings, "changed", G_CALLBACK(on_settings_changed), self);
+	g_signal_connect(vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(self)),
+	                 "notify::" VALA_PANEL_KEY_VISIBILITY,
+	                 G_CALLBACK(on_visibility_change),
+	                 self);
+	on_visibility_change(G_OBJECT(vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(self))),
+	                     NULL,
+	                     self);
 	gtk_widget_show(GTK_WIDGET(self));
 }
 
 static GtkWidget *netmon_get_settings_ui(ValaPanelApplet *base)
 {
 	return vala_panel_generic_cfg_widgetv(vala_panel_applet_get_settings(base),
-	                             _("Network interface"),
+	                             _("Network interface, or patterns like en*,wl*"),
 	                             NET_IFACE,
 	                             CONF_STR,
+	                             _("Separate graph for every matching interface"),
+	                             NET_PER_INTERFACE,
+	                             CONF_BOOL,
 	                             _("Net average samples count (for more round speed)"),
 	                             NET_AVERAGE_SAMPLES,
 	                             CONF_INT,
@@ -207,6 +311,9 @@ static GtkWidget *netmon_get_settings_ui(ValaPanelApplet *base)
 	                             _("Net graph as histogram"),
 	                             NET_USE_BAR,
 	                             CONF_BOOL,
+	                             _("Sample ten times per second, showing bursts"),
+	                             NET_FAST_SAMPLING,
+	                             CONF_BOOL,
 	                             _("Net width"),
 	                             NET_WIDTH,
 	                             CONF_INT,
@@ -223,20 +330,24 @@ static void netmon_applet_dispose(GObject *user_data)
 	GSettings *settings = vala_panel_applet_get_settings(VALA_PANEL_APPLET(c));
 	/* Disconnect the signals. */
 	g_signal_handlers_disconnect_by_data(settings, c);
-	/* Disconnect the timer. */
-	if (c->timer)
+	g_signal_handlers_disconnect_by_data(vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(c)),
+	                                     c);
+	/* Disconnect from the sampler. */
+	if (c->sampler_id)
 	{
-		g_source_remove(c->timer);
-		c->timer = 0;
+		vala_panel_sampler_unsubscribe(vala_panel_sampler_get_default(), c->sampler_id);
+		c->sampler_id = 0;
 	}
 	/* Freeing all monitors */
-	g_clear_pointer(&c->monitor, netmon_dispose);
+	g_clear_pointer(&c->monitors, g_ptr_array_unref);
+	vala_panel_sample_filter_clear(&c->filter);
 
 	G_OBJECT_CLASS(netmon_applet_parent_class)->dispose(user_data);
 }
 
-static void netmon_applet_init(G_GNUC_UNUSED NetMonApplet *self)
+static void netmon_applet_init(NetMonApplet *self)
 {
+	self->monitors = g_ptr_array_new_with_free_func((GDestroyNotify)netmon_dispose);
 }
 
 static void netmon_applet_class_init(NetMonAppletClass *klass)
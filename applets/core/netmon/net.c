@@ -16,158 +16,93 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <ctype.h>
-#include <errno.h>
 #include <stdbool.h>
-#include <stdio.h>
+#include <string.h>
 
 #include "net.h"
 
-#define NET_SAMPLE_COUNT 5
-#define SAMPLE_SCALE_MULT 0.1
-#define MIN_MAXIMUM 10000
-
 /*
  * Network monitor functions
  */
 
-struct net_stat
-{
-	long long last_down, last_up;
-	int cur_idx;
-	long long down[NET_SAMPLE_COUNT], up[NET_SAMPLE_COUNT];
-	double down_rate, up_rate;
-	/* We need one maximum to maintain consistent curves */
-	double max;
-};
-
-G_GNUC_INTERNAL bool update_net(NetMon *mon)
+G_GNUC_INTERNAL bool update_net(NetMon *mon, const ValaPanelSnapshot *snapshot)
 {
-	static struct net_stat net = { .cur_idx = 0, .max = MIN_MAXIMUM };
-
-	FILE *fp;
-	if (!(fp = fopen("/proc/net/dev", "r")))
+	struct net_stat *net              = &mon->net;
+	ValaPanelSampleFilter *filter     = &mon->filter;
+	const ValaPanelNetSample *samples = snapshot->net;
+	guint digest                      = snapshot->net_digest;
+	/* Links were added, recreated or renamed, so their sum is not comparable to the last one */
+	if (vala_panel_sample_filter_update_net(filter, samples, snapshot->n_net, digest))
+		restart_net(mon);
+	bool found     = filter->positions->len > 0;
+	guint64 rx_sum = 0;
+	guint64 tx_sum = 0;
+	bool link_up   = false;
+	for (uint i = 0; i < filter->positions->len; i++)
 	{
-		return 0;
+		uint pos                         = g_array_index(filter->positions, uint, i);
+		const ValaPanelNetSample *sample = &samples[pos];
+		rx_sum += sample->rx_bytes;
+		tx_sum += sample->tx_bytes;
+		link_up |= sample->up;
 	}
-	char buf[256];
-	G_GNUC_UNUSED char *tmp;
-	/* Ignore first two lines - header */
-	tmp                   = fgets(buf, 255, fp);
-	tmp                   = fgets(buf, 255, fp);
-	static bool first_run = true;
-	while (!feof(fp))
+	if (found)
 	{
-		if (fgets(buf, 255, fp) == NULL)
-		{
-			break;
-		}
-		char *p = buf;
-		while (isspace((int)*p))
-			p++;
-		char *curdev = p;
-		while (*p && *p != ':')
-			p++;
-		if (*p == '\0')
-			continue;
-		*p = '\0';
-
-		if (g_strcmp0(curdev, mon->interface_name))
-			continue;
-
-		long long down, up;
-		sscanf(p + 1, "%lld %*d %*d %*d %*d %*d %*d %*d %lld", &down, &up);
-		if (down < net.last_down)
-			net.last_down = 0; // Overflow
-		if (up < net.last_up)
-			net.last_up = 0; // Overflow
-		net.down[net.cur_idx] = (down - net.last_down);
-		net.up[net.cur_idx]   = (up - net.last_up);
-		net.last_down         = down;
-		net.last_up           = up;
-		if (first_run)
-		{
-			first_run = false;
-			break;
-		}
-
-		unsigned int curtmp1 = 0;
-		unsigned int curtmp2 = 0;
-		/* Average the samples */
+		long long down = (long long)rx_sum;
+		long long up   = (long long)tx_sum;
+		if (down < net->last_down)
+			net->last_down = 0; // Overflow
+		if (up < net->last_up)
+			net->last_up = 0; // Overflow
+		/* Ticks slip when main loop is busy, so rates use real time between them */
+		net->seconds[net->cur_idx] =
+		    (double)(snapshot->time - net->last_time) / G_USEC_PER_SEC;
+		net->down[net->cur_idx] = (down - net->last_down);
+		net->up[net->cur_idx]   = (up - net->last_up);
+		net->last_down          = down;
+		net->last_up            = up;
+		net->last_time          = snapshot->time;
+		net->up                 = link_up;
+	}
+	if (found && !net->initialized)
+		net->initialized = true;
+	else if (found)
+	{
+		double curtmp1 = 0;
+		double curtmp2 = 0;
+		double seconds = 0;
+		/* Average the samples, weighted by their length, to get bytes per second */
 		for (int i = 0; i < mon->average_samples; i++)
 		{
-			curtmp1 +=
-			    net.down[(net.cur_idx + NET_SAMPLE_COUNT - i) % NET_SAMPLE_COUNT];
-			curtmp2 += net.up[(net.cur_idx + NET_SAMPLE_COUNT - i) % NET_SAMPLE_COUNT];
-		}
-		net.down_rate = curtmp1 / (double)mon->average_samples;
-		net.up_rate   = curtmp2 / (double)mon->average_samples;
-		/* Count current values for tooltip */
-		mon->down_current = net.down_rate;
-		mon->up_current   = net.up_rate;
-		/* Check if we need downscaling */
-		double max_up_sample = 0.0, max_down_sample = 0.0;
-		for (int i = 0; i < mon->pixmap_width; i++)
-		{
-			max_up_sample   = MAX(max_up_sample, mon->up_stats[i]);
-			max_down_sample = MAX(max_down_sample, mon->down_stats[i]);
+			int idx = (net->cur_idx + NET_SAMPLE_COUNT - i) % NET_SAMPLE_COUNT;
+			curtmp1 += net->down[idx];
+			curtmp2 += net->up[idx];
+			seconds += net->seconds[idx];
 		}
-		if (max_up_sample < SAMPLE_SCALE_MULT && max_down_sample < SAMPLE_SCALE_MULT &&
-		    net.max >= MIN_MAXIMUM / SAMPLE_SCALE_MULT)
-		{
-			/* We need downscaling, process it */
-			for (int i = 0; i < mon->pixmap_width; i++)
-			{
-				mon->down_stats[i] /= SAMPLE_SCALE_MULT;
-				mon->up_stats[i] /= SAMPLE_SCALE_MULT;
-			}
-			net.max *= SAMPLE_SCALE_MULT;
-		}
-		double rate = MAX(net.up_rate, net.down_rate);
-		/* Normalize by maximum speed (a priori unknown,
-		 so we must do this all the time). */
-		if (net.max < rate)
-		{
-			for (int i = 0; i < mon->pixmap_width; i++)
-			{
-				mon->down_stats[i] *= (net.max / rate);
-				mon->up_stats[i] *= (net.max / rate);
-			}
-			net.max = net.up_rate > net.down_rate ? net.up_rate : net.down_rate;
-			if (net.up_rate > net.down_rate)
-			{
-				net.up_rate = 1.0;
-				net.down_rate /= net.max;
-			}
-			else
-			{
-				net.down_rate = 1.0;
-				net.up_rate /= net.max;
-			}
-		}
-		else if (net.max != 0)
-		{
-			net.up_rate /= net.max;
-			net.down_rate /= net.max;
-		}
-		net.cur_idx = (net.cur_idx + 1) % NET_SAMPLE_COUNT;
-		break; // Ignore the rest
+		net->down_rate = seconds > 0 ? curtmp1 / seconds : 0;
+		net->up_rate   = seconds > 0 ? curtmp2 / seconds : 0;
+		net->cur_idx   = (net->cur_idx + 1) % NET_SAMPLE_COUNT;
 	}
-	fclose(fp);
 
-	mon->down_stats[mon->ring_cursor] = net.down_rate;
-	mon->up_stats[mon->ring_cursor]   = net.up_rate;
+	/* Bytes per second are stored as they are, graph scales them only when drawing */
+	double values[] = { [NET_RX] = net->down_rate, [NET_TX] = net->up_rate };
+	return vala_panel_graph_push_at(mon->graph, values, snapshot->time);
+}
 
-	mon->ring_cursor += 1;
-	if (mon->ring_cursor >= mon->pixmap_width)
-		mon->ring_cursor = 0;
-	netmon_redraw_pixmap(mon);
-	return true;
+/* Drop averaging window, so next sample only primes the counters */
+G_GNUC_INTERNAL void restart_net(NetMon *mon)
+{
+	struct net_stat *net = &mon->net;
+	memset(net->down, 0, sizeof(net->down));
+	memset(net->up, 0, sizeof(net->up));
+	memset(net->seconds, 0, sizeof(net->seconds));
+	net->down_rate   = 0;
+	net->up_rate     = 0;
+	net->initialized = false;
 }
 
-static double count_coeff(double rate, double max)
+static double count_coeff(double bytes)
 {
-	double bytes = rate * max;
 	if (bytes > 1073741824)
 		return bytes / 1073741824;
 	else if (bytes > 1048576)
@@ -178,9 +113,8 @@ static double count_coeff(double rate, double max)
 		return bytes;
 }
 
-static const char *get_relevant_char(double rate, double max)
+static const char *get_relevant_char(double bytes)
 {
-	double bytes = rate * max;
 	if (bytes > 1073741824)
 		return _("GB/s");
 	else if (bytes > 1048576)
@@ -193,19 +127,24 @@ static const char *get_relevant_char(double rate, double max)
 
 G_GNUC_INTERNAL void tooltip_update_net(NetMon *m)
 {
-	if (m != NULL && m->down_stats != NULL && m->up_stats != NULL)
+	if (m != NULL && m->graph != NULL)
 	{
-		int ring_pos = (m->ring_cursor == 0) ? m->pixmap_width - 1 : m->ring_cursor - 1;
-		if (m->da != NULL && m->down_stats != NULL && m->up_stats != NULL)
+		double down = vala_panel_graph_get_last(m->graph, NET_RX);
+		double up   = vala_panel_graph_get_last(m->graph, NET_TX);
+		if (!m->net.up)
 		{
-			g_autofree char *tooltip_txt = g_strdup_printf(
-			    _("%s:\nNet receive: %.3f %s \nNet transmit: %.3f %s\n"),
-			    m->interface_name,
-			    count_coeff(m->down_stats[ring_pos], m->down_current),
-			    get_relevant_char(m->down_stats[ring_pos], m->down_current),
-			    count_coeff(m->up_stats[ring_pos], m->up_current),
-			    get_relevant_char(m->up_stats[ring_pos], m->up_current));
-			gtk_widget_set_tooltip_text(GTK_WIDGET(m->da), tooltip_txt);
+			g_autofree char *tooltip_txt =
+			    g_strdup_printf(_("%s:\nLink is down\n"), m->interface_name);
+			gtk_widget_set_tooltip_text(GTK_WIDGET(m->graph), tooltip_txt);
+			return;
 		}
+		g_autofree char *tooltip_txt =
+		    g_strdup_printf(_("%s:\nNet receive: %.3f %s \nNet transmit: %.3f %s\n"),
+		                    m->interface_name,
+		                    count_coeff(down),
+		                    get_relevant_char(down),
+		                    count_coeff(up),
+		                    get_relevant_char(up));
+		gtk_widget_set_tooltip_text(GTK_WIDGET(m->graph), tooltip_txt);
 	}
 }
@@ -29,9 +29,12 @@ G_BEGIN_DECLS
 #define NET_WIDTH "width"
 #define NET_AVERAGE_SAMPLES "average-samples-precision"
 #define NET_USE_BAR "draw-as-bar"
+#define NET_FAST_SAMPLING "fast-sampling"
+#define NET_PER_INTERFACE "per-interface"
 
-G_GNUC_INTERNAL bool update_net(NetMon *m);
+G_GNUC_INTERNAL bool update_net(NetMon *m, const ValaPanelSnapshot *snapshot);
 G_GNUC_INTERNAL void tooltip_update_net(NetMon *m);
+G_GNUC_INTERNAL void restart_net(NetMon *m);
 
 G_END_DECLS
 
@@ -0,0 +1,191 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "icon-cache.h"
+
+#include <string.h>
+
+#define HASH_PRIME G_GUINT64_CONSTANT(0x9e3779b97f4a7c15)
+#define HASH_LANES 4 /* Independent multiply chains, so a pixmap hashes near memory speed */
+
+typedef struct
+{
+	IconCacheKey key; /* First, so a key can be looked up as an entry */
+	GIcon *icon;
+	size_t cost;
+	GList lru_link; /* Head is the most recently used */
+} IconCacheEntry;
+
+static GHashTable *cache_table = NULL;
+static GQueue cache_lru        = G_QUEUE_INIT;
+static size_t cache_budget     = ICON_CACHE_DEFAULT_BUDGET;
+static IconCacheStats cache_stats;
+
+static inline guint64 hash_mix(guint64 h, guint64 word)
+{
+	h = (h ^ word) * HASH_PRIME;
+	return h ^ (h >> 32);
+}
+
+static guint64 hash_bytes(GBytes *bytes, guint64 h)
+{
+	size_t len;
+	const guint8 *p = g_bytes_get_data(bytes, &len);
+	guint64 lanes[HASH_LANES];
+	guint64 word;
+	h = hash_mix(h, len);
+	for (int i = 0; i < HASH_LANES; i++)
+		lanes[i] = h + i;
+	for (; len >= sizeof(lanes); p += sizeof(lanes), len -= sizeof(lanes))
+		for (int i = 0; i < HASH_LANES; i++)
+		{
+			memcpy(&word, p + i * sizeof(word), sizeof(word));
+			lanes[i] = hash_mix(lanes[i], word);
+		}
+	for (int i = 0; i < HASH_LANES; i++)
+		h = hash_mix(h, lanes[i]);
+	for (; len >= sizeof(word); p += sizeof(word), len -= sizeof(word))
+	{
+		memcpy(&word, p, sizeof(word));
+		h = hash_mix(h, word);
+	}
+	word = 0;
+	memcpy(&word, p, len);
+	return hash_mix(h, word);
+}
+
+static guint entry_hash(gconstpointer data)
+{
+	const IconCacheKey *key = data;
+	return (guint)(key->hash ^ (key->hash >> 32));
+}
+
+static gboolean entry_equal(gconstpointer a, gconstpointer b)
+{
+	const IconCacheKey *ka = a;
+	const IconCacheKey *kb = b;
+	if (ka->hash != kb->hash || ka->width != kb->width || ka->height != kb->height ||
+	    ka->overlay_width != kb->overlay_width || ka->overlay_height != kb->overlay_height ||
+	    ka->icon_size != kb->icon_size || ka->symbolic != kb->symbolic)
+		return false;
+	if ((ka->overlay == NULL) != (kb->overlay == NULL))
+		return false;
+	if (ka->overlay && !g_bytes_equal(ka->overlay, kb->overlay))
+		return false;
+	return g_bytes_equal(ka->pixmap, kb->pixmap);
+}
+
+static void entry_free(gpointer data)
+{
+	IconCacheEntry *entry = data;
+	g_bytes_unref(entry->key.pixmap);
+	if (entry->key.overlay)
+		g_bytes_unref(entry->key.overlay);
+	g_object_unref(entry->icon);
+	g_slice_free(IconCacheEntry, entry);
+}
+
+static void cache_evict(size_t budget)
+{
+	while (cache_stats.bytes > budget && cache_lru.tail)
+	{
+		IconCacheEntry *entry = cache_lru.tail->data;
+		g_queue_unlink(&cache_lru, &entry->lru_link);
+		cache_stats.bytes -= entry->cost;
+		cache_stats.entries--;
+		cache_stats.evictions++;
+		g_hash_table_remove(cache_table, entry);
+	}
+}
+
+G_GNUC_INTERNAL void icon_cache_key_init(IconCacheKey *key, IconPixmap *pixmap,
+                                         IconPixmap *overlay, int icon_size, bool symbolic)
+{
+	guint64 h = hash_mix(HASH_PRIME, (guint64)icon_size << 1 | symbolic);
+	h = hash_mix(h, (guint64)pixmap->width << 32 | (guint)pixmap->height);
+	h = hash_bytes(pixmap->bytes, h);
+	*key = (IconCacheKey){
+		.pixmap    = pixmap->bytes,
+		.width     = pixmap->width,
+		.height    = pixmap->height,
+		.icon_size = icon_size,
+		.symbolic  = symbolic,
+	};
+	if (overlay && overlay->bytes)
+	{
+		h = hash_mix(h, (guint64)overlay->width << 32 | (guint)overlay->height);
+		h                   = hash_bytes(overlay->bytes, h);
+		key->overlay        = overlay->bytes;
+		key->overlay_width  = overlay->width;
+		key->overlay_height = overlay->height;
+	}
+	key->hash = h;
+}
+
+G_GNUC_INTERNAL GIcon *icon_cache_lookup(const IconCacheKey *key)
+{
+	if (!cache_table)
+		return NULL;
+	cache_stats.lookups++;
+	IconCacheEntry *entry = g_hash_table_lookup(cache_table, key);
+	if (!entry)
+		return NULL;
+	cache_stats.hits++;
+	g_queue_unlink(&cache_lru, &entry->lru_link);
+	g_queue_push_head_link(&cache_lru, &entry->lru_link);
+	return g_object_ref(entry->icon);
+}
+
+G_GNUC_INTERNAL void icon_cache_insert(const IconCacheKey *key, GIcon *icon, size_t cost)
+{
+	cost += g_bytes_get_size(key->pixmap) + sizeof(IconCacheEntry);
+	if (key->overlay)
+		cost += g_bytes_get_size(key->overlay);
+	/* An icon bigger than the whole budget would only flush everything else */
+	if (cost > cache_budget)
+		return;
+	if (!cache_table)
+		cache_table = g_hash_table_new_full(entry_hash, entry_equal, NULL, entry_free);
+	if (g_hash_table_contains(cache_table, key))
+		return;
+	IconCacheEntry *entry = g_slice_new0(IconCacheEntry);
+	entry->key            = *key;
+	entry->key.pixmap     = g_bytes_ref(key->pixmap);
+	if (key->overlay)
+		entry->key.overlay = g_bytes_ref(key->overlay);
+	entry->icon          = g_object_ref(icon);
+	entry->cost          = cost;
+	entry->lru_link.data = entry;
+	g_hash_table_add(cache_table, entry);
+	g_queue_push_head_link(&cache_lru, &entry->lru_link);
+	cache_stats.bytes += cost;
+	cache_stats.entries++;
+	cache_evict(cache_budget);
+}
+
+G_GNUC_INTERNAL void icon_cache_set_budget(size_t bytes)
+{
+	cache_budget = bytes;
+	if (cache_table)
+		cache_evict(bytes);
+}
+
+G_GNUC_INTERNAL void icon_cache_get_stats(IconCacheStats *stats)
+{
+	*stats = cache_stats;
+}
@@ -0,0 +1,71 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ICONCACHE_H
+#define ICONCACHE_H
+
+#include <gio/gio.h>
+#include <stdbool.h>
+
+#include "icon-pixmap.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Process-wide cache of icons made from pixmaps, shared by all tray items.
+ * Items resend identical pixmaps with every NewIcon and many apps ship the
+ * same default icon, so converted and scaled results are kept by content.
+ * Least recently used icons go first once the byte budget is exceeded.
+ */
+typedef struct
+{
+	GBytes *pixmap; /* Borrowed while looking up, referenced once inserted */
+	int width;
+	int height;
+	GBytes *overlay; /* Nullable */
+	int overlay_width;
+	int overlay_height;
+	int icon_size;
+	bool symbolic;
+	guint64 hash;
+} IconCacheKey;
+
+typedef struct
+{
+	guint64 lookups;
+	guint64 hits;
+	guint64 evictions;
+	size_t bytes; /* Pixmaps and converted icons of all entries */
+	uint entries;
+} IconCacheStats;
+
+#define ICON_CACHE_DEFAULT_BUDGET (4 * 1024 * 1024)
+
+G_GNUC_INTERNAL void icon_cache_key_init(IconCacheKey *key, IconPixmap *pixmap,
+                                         IconPixmap *overlay, int icon_size, bool symbolic);
+/* Returns (transfer full) the cached icon for @key, or NULL */
+G_GNUC_INTERNAL GIcon *icon_cache_lookup(const IconCacheKey *key);
+/* @cost is the size of @icon itself, pixmaps of @key are counted here */
+G_GNUC_INTERNAL void icon_cache_insert(const IconCacheKey *key, GIcon *icon, size_t cost);
+/* Evicts down to @bytes at once, 0 disables the cache */
+G_GNUC_INTERNAL void icon_cache_set_budget(size_t bytes);
+G_GNUC_INTERNAL void icon_cache_get_stats(IconCacheStats *stats);
+
+G_END_DECLS
+
+#endif // ICONCACHE_H
@@ -0,0 +1,267 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "icon-path-index.h"
+
+#include <dirent.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define INDEX_MAX_DEPTH 8       /* Also stops symlink loops */
+#define INDEX_MAX_MONITORS 64   /* Shallowest directories, where icons usually are */
+#define INDEX_REBUILD_DELAY 500 /* ms, lets bursts like package upgrades settle */
+
+struct _IconPathIndex
+{
+	GObject __parent__;
+
+	char *path;
+	GHashTable *icons; /* Name without extension to file path, NULL until first built */
+	GPtrArray *monitors;
+	uint rebuild_timeout;
+	bool building;
+	bool stale; /* Changed again while building */
+};
+
+G_DEFINE_TYPE(IconPathIndex, icon_path_index, G_TYPE_OBJECT)
+
+enum
+{
+	CHANGED,
+	LAST_SIGNAL
+};
+
+static uint signals[LAST_SIGNAL] = { 0 };
+
+/* Path to index, entries are not referenced and go away on finalize */
+static GHashTable *indexes = NULL;
+
+typedef struct
+{
+	GHashTable *icons;
+	GPtrArray *dirs;
+} IndexScan;
+
+static void icon_path_index_rebuild(IconPathIndex *self);
+
+static void index_scan_free(IndexScan *scan)
+{
+	g_clear_pointer(&scan->icons, g_hash_table_unref);
+	g_clear_pointer(&scan->dirs, g_ptr_array_unref);
+	g_free(scan);
+}
+
+static void monitor_free(void *data)
+{
+	g_file_monitor_cancel(G_FILE_MONITOR(data));
+	g_object_unref(data);
+}
+
+static void icon_path_index_init(IconPathIndex *self)
+{
+	self->path            = NULL;
+	self->icons           = NULL;
+	self->monitors        = g_ptr_array_new_with_free_func(monitor_free);
+	self->rebuild_timeout = 0;
+	self->building        = false;
+	self->stale           = false;
+}
+
+static void icon_path_index_finalize(GObject *object)
+{
+	IconPathIndex *self = ICON_PATH_INDEX(object);
+
+	if (indexes && g_hash_table_lookup(indexes, self->path) == self)
+		g_hash_table_remove(indexes, self->path);
+	if (self->rebuild_timeout != 0)
+		g_source_remove(self->rebuild_timeout);
+	g_clear_pointer(&self->monitors, g_ptr_array_unref);
+	g_clear_pointer(&self->icons, g_hash_table_unref);
+	g_clear_pointer(&self->path, g_free);
+
+	G_OBJECT_CLASS(icon_path_index_parent_class)->finalize(object);
+}
+
+static void icon_path_index_class_init(IconPathIndexClass *klass)
+{
+	GObjectClass *oclass = G_OBJECT_CLASS(klass);
+	oclass->finalize     = icon_path_index_finalize;
+
+	signals[CHANGED] = g_signal_new(g_intern_static_string(ICON_PATH_INDEX_SIGNAL_CHANGED),
+	                                G_TYPE_FROM_CLASS(oclass),
+	                                G_SIGNAL_RUN_LAST,
+	                                0,
+	                                NULL,
+	                                NULL,
+	                                g_cclosure_marshal_VOID__VOID,
+	                                G_TYPE_NONE,
+	                                0);
+}
+
+/* Breadth first, so a file nearer to the top wins over one with the same name deeper down */
+static void icon_path_index_scan(GTask *task, G_GNUC_UNUSED void *source, void *task_data,
+                                 GCancellable *cancellable)
+{
+	IndexScan *scan = g_new0(IndexScan, 1);
+	scan->icons     = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	scan->dirs      = g_ptr_array_new_with_free_func(g_free);
+	g_autoptr(GPtrArray) depths = g_ptr_array_new();
+	g_ptr_array_add(scan->dirs, g_strdup(task_data));
+	g_ptr_array_add(depths, GUINT_TO_POINTER(0));
+	for (uint i = 0; i < scan->dirs->len && !g_cancellable_is_cancelled(cancellable); i++)
+	{
+		const char *dir_path = g_ptr_array_index(scan->dirs, i);
+		uint depth           = GPOINTER_TO_UINT(g_ptr_array_index(depths, i));
+		DIR *dir             = opendir(dir_path);
+		if (dir == NULL)
+			continue;
+		struct dirent *ent;
+		while ((ent = readdir(dir)) != NULL)
+		{
+			/* Also skips . and .. */
+			if (ent->d_name[0] == '.')
+				continue;
+			char *file  = g_build_filename(dir_path, ent->d_name, NULL);
+			bool is_dir = ent->d_type == DT_DIR;
+			if (ent->d_type == DT_UNKNOWN || ent->d_type == DT_LNK)
+				is_dir = g_file_test(file, G_FILE_TEST_IS_DIR);
+			if (is_dir && depth < INDEX_MAX_DEPTH)
+			{
+				g_ptr_array_add(scan->dirs, file);
+				g_ptr_array_add(depths, GUINT_TO_POINTER(depth + 1));
+				continue;
+			}
+			const char *ext = strrchr(ent->d_name, '.');
+			char *name      = ext ? g_strndup(ent->d_name, (size_t)(ext - ent->d_name))
+			                      : g_strdup(ent->d_name);
+			if (is_dir || g_hash_table_contains(scan->icons, name))
+			{
+				g_free(name);
+				g_free(file);
+				continue;
+			}
+			g_hash_table_insert(scan->icons, name, file);
+		}
+		closedir(dir);
+	}
+	g_task_return_pointer(task, scan, (GDestroyNotify)index_scan_free);
+}
+
+static int icon_path_index_rebuild_timeout(void *user_data)
+{
+	IconPathIndex *self   = user_data;
+	self->rebuild_timeout = 0;
+	icon_path_index_rebuild(self);
+	return G_SOURCE_REMOVE;
+}
+
+static void icon_path_index_dir_changed(G_GNUC_UNUSED GFileMonitor *monitor,
+                                        G_GNUC_UNUSED GFile *file, G_GNUC_UNUSED GFile *other,
+                                        GFileMonitorEvent event, void *user_data)
+{
+	IconPathIndex *self = user_data;
+
+	/* Only files appearing or going away change the index, not their contents */
+	if (event != G_FILE_MONITOR_EVENT_CREATED && event != G_FILE_MONITOR_EVENT_DELETED &&
+	    event != G_FILE_MONITOR_EVENT_MOVED_IN && event != G_FILE_MONITOR_EVENT_MOVED_OUT &&
+	    event != G_FILE_MONITOR_EVENT_RENAMED)
+		return;
+	if (self->rebuild_timeout == 0)
+		self->rebuild_timeout =
+		    g_timeout_add(INDEX_REBUILD_DELAY, icon_path_index_rebuild_timeout, self);
+}
+
+static void icon_path_index_watch(IconPathIndex *self, GPtrArray *dirs)
+{
+	g_ptr_array_set_size(self->monitors, 0);
+	for (uint i = 0; i < dirs->len && self->monitors->len < INDEX_MAX_MONITORS; i++)
+	{
+		g_autoptr(GFile) dir  = g_file_new_for_path(g_ptr_array_index(dirs, i));
+		GFileMonitor *monitor = g_file_monitor_directory(dir,
+		                                                 G_FILE_MONITOR_WATCH_MOVES,
+		                                                 NULL,
+		                                                 NULL);
+		if (monitor == NULL)
+			continue;
+		g_signal_connect(monitor,
+		                 "changed",
+		                 G_CALLBACK(icon_path_index_dir_changed),
+		                 self);
+		g_ptr_array_add(self->monitors, monitor);
+	}
+}
+
+static void icon_path_index_built(GObject *source, GAsyncResult *res,
+                                  G_GNUC_UNUSED void *user_data)
+{
+	IconPathIndex *self = ICON_PATH_INDEX(source);
+	IndexScan *scan     = g_task_propagate_pointer(G_TASK(res), NULL);
+
+	self->building = false;
+	if (scan == NULL)
+		return;
+	g_clear_pointer(&self->icons, g_hash_table_unref);
+	self->icons = g_steal_pointer(&scan->icons);
+	icon_path_index_watch(self, scan->dirs);
+	index_scan_free(scan);
+	if (self->stale)
+	{
+		self->stale = false;
+		icon_path_index_rebuild(self);
+	}
+	g_signal_emit(self, signals[CHANGED], 0);
+}
+
+static void icon_path_index_rebuild(IconPathIndex *self)
+{
+	if (self->building)
+	{
+		self->stale = true;
+		return;
+	}
+	self->building        = true;
+	g_autoptr(GTask) task = g_task_new(self, NULL, icon_path_index_built, NULL);
+	g_task_set_task_data(task, g_strdup(self->path), g_free);
+	g_task_run_in_thread(task, icon_path_index_scan);
+}
+
+G_GNUC_INTERNAL IconPathIndex *icon_path_index_get(const char *path)
+{
+	if (indexes == NULL)
+		indexes = g_hash_table_new(g_str_hash, g_str_equal);
+	IconPathIndex *self = g_hash_table_lookup(indexes, path);
+	if (self != NULL)
+		return g_object_ref(self);
+
+	self       = ICON_PATH_INDEX(g_object_new(icon_path_index_get_type(), NULL));
+	self->path = g_strdup(path);
+	g_hash_table_insert(indexes, self->path, self);
+	icon_path_index_rebuild(self);
+	return self;
+}
+
+G_GNUC_INTERNAL GIcon *icon_path_index_lookup(IconPathIndex *self, const char *icon_name)
+{
+	g_return_val_if_fail(ICON_IS_PATH_INDEX(self), NULL);
+
+	const char *file = self->icons ? g_hash_table_lookup(self->icons, icon_name) : NULL;
+	if (file == NULL)
+		return NULL;
+	g_autoptr(GFile) f = g_file_new_for_path(file);
+	return g_file_icon_new(f);
+}
@@ -0,0 +1,42 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ICONPATHINDEX_H
+#define ICONPATHINDEX_H
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define ICON_PATH_INDEX_SIGNAL_CHANGED "changed"
+
+/*
+ * Icon files under an item's IconThemePath, by name without extension.
+ * Built on a worker thread and rebuilt when monitored directories change,
+ * emitting "changed" each time, so lookups never touch the disk.
+ */
+G_DECLARE_FINAL_TYPE(IconPathIndex, icon_path_index, ICON, PATH_INDEX, GObject)
+
+/* Shared by all items using @path */
+G_GNUC_INTERNAL IconPathIndex *icon_path_index_get(const char *path);
+/* Returns NULL when not found or while the index is still being built */
+G_GNUC_INTERNAL GIcon *icon_path_index_lookup(IconPathIndex *self, const char *icon_name);
+
+G_END_DECLS
+
+#endif // ICONPATHINDEX_H
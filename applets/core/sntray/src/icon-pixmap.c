@@ -17,6 +17,7 @@
  */
 
 #include "icon-pixmap.h"
+#include "icon-swizzle.h"
 #include "rtparser.h"
 #include "sn-common.h"
 #include <gtk/gtk.h>
@@ -43,11 +44,8 @@ G_GNUC_INTERNAL IconPixmap *icon_pixmap_new_with_size(GVariant *pixmaps, int ico
 			self->width  = width;
 			g_autoptr(GVariant) bytes_var =
 			    g_variant_get_child_value(pixmap_variant, 2);
-			self->bytes    = (u_int8_t *)g_variant_get_fixed_array(bytes_var,
-                                                                            &self->bytes_size,
-                                                                            sizeof(u_int8_t));
-			self->bytes    = g_memdup(self->bytes, self->bytes_size);
-			self->is_gicon = false;
+			/* Referenced, not copied: pixels are read once, when converted */
+			self->bytes = g_variant_get_data_as_bytes(bytes_var);
 			break;
 		}
 		g_clear_pointer(&pixmap_variant, g_variant_unref);
@@ -58,80 +56,51 @@ G_GNUC_INTERNAL IconPixmap *icon_pixmap_new_with_size(GVariant *pixmaps, int ico
 
 G_GNUC_INTERNAL void icon_pixmap_free(IconPixmap *self)
 {
-	if (!self->is_gicon)
-		g_clear_pointer(&self->bytes, g_free);
+	g_clear_pointer(&self->bytes, g_bytes_unref);
 	g_clear_pointer(&self, g_free);
 }
 
-G_GNUC_INTERNAL void icon_pixmap_destroy_notify(uint8_t* pixels, gpointer user_data)
+/* Referenced pixels keep the whole message alive, copy them out to keep the pixmap around */
+G_GNUC_INTERNAL void icon_pixmap_detach(IconPixmap *self)
 {
-	g_free(pixels);
+	if (!self->bytes)
+		return;
+	size_t size   = g_bytes_get_size(self->bytes);
+	GBytes *bytes = g_bytes_new(g_bytes_get_data(self->bytes, NULL), size);
+	g_bytes_unref(self->bytes);
+	self->bytes = bytes;
 }
 
-G_GNUC_INTERNAL GIcon *icon_pixmap_to_gicon(IconPixmap *self)
+G_GNUC_INTERNAL void icon_pixmap_destroy_notify(uint8_t* pixels, gpointer user_data)
 {
-	if (!self->bytes)
-		return NULL;
-	{
-		u_int32_t *data = (u_int32_t *)self->bytes;
-		for (size_t i = 0; i < self->bytes_size / 4; i++)
-		{
-			data[i]    = GUINT32_FROM_BE(data[i]);
-			u_int8_t a = (data[i] >> 24) & 0xFF;
-			u_int8_t b = (data[i] >> 16) & 0xFF;
-			u_int8_t g = (data[i] >> 8) & 0xFF;
-			u_int8_t r = data[i] & 0xFF;
-			data[i]    = a << 24 | r << 16 | g << 8 | b;
-		}
-	}
-	GIcon *icon =
-	    G_ICON(gdk_pixbuf_new_from_data(self->bytes,
-	                                    GDK_COLORSPACE_RGB,
-	                                    true,
-	                                    8,
-	                                    self->width,
-	                                    self->height,
-	                                    cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32,
-	                                                                  self->width),
-	                                    icon_pixmap_destroy_notify,
-	                                    NULL));
-	self->is_gicon = true;
-	self->bytes    = NULL;
-	return icon;
+	g_free(pixels);
 }
 
-static GIcon *icon_pixmap_find_file_icon(const char *icon_name, const char *path)
+G_GNUC_INTERNAL GIcon *icon_pixmap_to_gicon(IconPixmap *self)
 {
-	if (string_empty(path))
+	if (!self->bytes || self->width <= 0 || self->height <= 0 || self->width > G_MAXINT / 4)
 		return NULL;
-	g_autoptr(GError) err = NULL;
-	g_autoptr(GDir) dir   = g_dir_open(path, 0, &err);
-	if (err)
+	size_t n_pixels = (size_t)self->width * (size_t)self->height;
+	/* Items are not trusted to send as many pixels as they claim */
+	if ((size_t)self->height > G_MAXSIZE / 4 / (size_t)self->width ||
+	    g_bytes_get_size(self->bytes) < n_pixels * 4)
 		return NULL;
-	for (const char *ch = g_dir_read_name(dir); ch != NULL; ch = g_dir_read_name(dir))
-	{
-		g_autofree char *new_path = g_build_filename(path, ch, NULL);
-		g_autoptr(GFile) f        = g_file_new_for_path(new_path);
-		char *sstr                = g_strrstr(ch, ".");
-		long diff                 = -1;
-		if (sstr != NULL)
-			diff = sstr - ch;
-		long index            = labs(diff);
-		g_autofree char *icon = index >= 0 ? g_strndup(ch, (ulong)index) : g_strdup(ch);
-		if (!g_strcmp0(icon_name, icon))
-			return g_file_icon_new(f);
-		GIcon *ret  = NULL;
-		GFileType t = g_file_query_file_type(f, G_FILE_QUERY_INFO_NONE, NULL);
-		if (t == G_FILE_TYPE_DIRECTORY)
-			ret = icon_pixmap_find_file_icon(icon_name, new_path);
-		if (ret)
-			return ret;
-	}
-	return NULL;
+	/* Converted straight from the message into pixbuf memory, pixmap stays reusable */
+	u_int8_t *pixels = g_malloc(n_pixels * 4);
+	icon_swizzle_argb_to_rgba(g_bytes_get_data(self->bytes, NULL), pixels, n_pixels);
+	return G_ICON(gdk_pixbuf_new_from_data(pixels,
+	                                       GDK_COLORSPACE_RGB,
+	                                       true,
+	                                       8,
+	                                       self->width,
+	                                       self->height,
+	                                       self->width * 4,
+	                                       icon_pixmap_destroy_notify,
+	                                       NULL));
 }
 
 GIcon *icon_pixmap_select_icon(const char *icon_name, IconPixmap *pixmap, GtkIconTheme *theme,
-                               const char *icon_theme_path, const int icon_size,
+                               IconPathIndex *path_index, const int icon_size,
                                const bool use_symbolic)
 {
 	if (!string_empty(icon_name))
@@ -144,10 +113,10 @@ GIcon *icon_pixmap_select_icon(const char *icon_name, IconPixmap *pixmap, GtkIco
 			g_autoptr(GFile) f = g_file_new_for_path(icon_name);
 			return g_file_icon_new(f);
 		}
-		else if (string_empty(icon_theme_path) || gtk_icon_theme_has_icon(theme, new_name))
+		else if (path_index == NULL || gtk_icon_theme_has_icon(theme, new_name))
 			return g_themed_icon_new_with_default_fallbacks(new_name);
 		else
-			return icon_pixmap_find_file_icon(icon_name, icon_theme_path);
+			return icon_path_index_lookup(path_index, icon_name);
 	}
 	else if (pixmap != NULL)
 	{
@@ -189,7 +158,7 @@ G_GNUC_INTERNAL ToolTip *tooltip_new(GVariant *variant)
 }
 
 G_GNUC_INTERNAL void unbox_tooltip(ToolTip *tooltip, GtkIconTheme *theme,
-                                   const char *icon_theme_path, GIcon **icon, char **markup)
+                                   IconPathIndex *path_index, GIcon **icon, char **markup)
 {
 	g_autofree char *raw_text = g_strdup_printf("%s\n%s", tooltip->title, tooltip->description);
 	bool is_pango_markup      = true;
@@ -221,7 +190,7 @@ G_GNUC_INTERNAL void unbox_tooltip(ToolTip *tooltip, GtkIconTheme *theme,
 		g_autoptr(GIcon) res_icon = icon_pixmap_select_icon(tooltip->icon_name,
 		                                                    tooltip->pixmap,
 		                                                    theme,
-		                                                    icon_theme_path,
+		                                                    path_index,
 		                                                    GTK_ICON_SIZE_DIALOG,
 		                                                    false);
 		*icon = (markup_parser->icon != NULL) ? g_object_ref(markup_parser->icon)
@@ -233,7 +202,7 @@ G_GNUC_INTERNAL void unbox_tooltip(ToolTip *tooltip, GtkIconTheme *theme,
 		*icon   = icon_pixmap_select_icon(tooltip->icon_name,
                                                 tooltip->pixmap,
                                                 theme,
-                                                icon_theme_path,
+                                                path_index,
                                                 48,
                                                 false);
 	}
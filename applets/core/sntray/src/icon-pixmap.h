@@ -22,22 +22,23 @@
 #include <gtk/gtk.h>
 #include <stdbool.h>
 
+#include "icon-path-index.h"
+
 G_BEGIN_DECLS
 
 typedef struct
 {
 	int width;
 	int height;
-	size_t bytes_size;
-	bool is_gicon;
-	u_int8_t *bytes;
+	GBytes *bytes; /* ARGB32 in network byte order, shared with the D-Bus message */
 } IconPixmap;
 
 G_GNUC_INTERNAL IconPixmap *icon_pixmap_new_with_size(GVariant *pixmaps, int icon_size);
 G_GNUC_INTERNAL void icon_pixmap_free(IconPixmap *self);
+G_GNUC_INTERNAL void icon_pixmap_detach(IconPixmap *self);
 G_GNUC_INTERNAL GIcon *icon_pixmap_to_gicon(IconPixmap *self);
 G_GNUC_INTERNAL GIcon *icon_pixmap_select_icon(const char *icon_name, IconPixmap *pixmap,
-                                               GtkIconTheme *theme, const char *icon_theme_path,
+                                               GtkIconTheme *theme, IconPathIndex *path_index,
                                                const int icon_size, const bool use_symbolic);
 typedef struct
 {
@@ -49,7 +50,7 @@ typedef struct
 
 G_GNUC_INTERNAL ToolTip *tooltip_new(GVariant *variant);
 G_GNUC_INTERNAL void unbox_tooltip(ToolTip *tooltip, GtkIconTheme *theme,
-                                   const char *icon_theme_path, GIcon **icon, char **markup);
+                                   IconPathIndex *path_index, GIcon **icon, char **markup);
 G_GNUC_INTERNAL void tooltip_free(ToolTip *self);
 G_END_DECLS
 
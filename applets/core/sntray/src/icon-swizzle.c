@@ -0,0 +1,68 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "icon-swizzle.h"
+
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN && defined(__SSE2__)
+#include <emmintrin.h>
+#define SWIZZLE_SSE2
+#elif G_BYTE_ORDER == G_LITTLE_ENDIAN && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SWIZZLE_NEON
+#endif
+
+#define SWIZZLE_LANES 4 /* Pixels per 128-bit vector */
+
+G_GNUC_INTERNAL void icon_swizzle_argb_to_rgba_scalar(const guint8 *src, guint8 *dst,
+                                                      size_t n_pixels)
+{
+	for (size_t i = 0; i < n_pixels; i++, src += 4, dst += 4)
+	{
+		guint8 a = src[0];
+		dst[0]   = src[1];
+		dst[1]   = src[2];
+		dst[2]   = src[3];
+		dst[3]   = a;
+	}
+}
+
+/*
+ * Loaded as little endian words, ARGB bytes are 0xBBGGRRAA and RGBA ones
+ * are 0xAABBGGRR, so each word is rotated right by 8 bits. SSE2 has no
+ * rotation, but two shifts and an or do the same without SSSE3 shuffles.
+ */
+G_GNUC_INTERNAL void icon_swizzle_argb_to_rgba(const guint8 *src, guint8 *dst, size_t n_pixels)
+{
+	size_t i = 0;
+#if defined(SWIZZLE_SSE2)
+	for (; i + SWIZZLE_LANES <= n_pixels; i += SWIZZLE_LANES)
+	{
+		__m128i argb = _mm_loadu_si128((const __m128i *)(const void *)(src + i * 4));
+		__m128i rgba = _mm_or_si128(_mm_srli_epi32(argb, 8), _mm_slli_epi32(argb, 24));
+		_mm_storeu_si128((__m128i *)(void *)(dst + i * 4), rgba);
+	}
+#elif defined(SWIZZLE_NEON)
+	for (; i + SWIZZLE_LANES <= n_pixels; i += SWIZZLE_LANES)
+	{
+		uint32x4_t argb = vreinterpretq_u32_u8(vld1q_u8(src + i * 4));
+		uint32x4_t rgba = vorrq_u32(vshrq_n_u32(argb, 8), vshlq_n_u32(argb, 24));
+		vst1q_u8(dst + i * 4, vreinterpretq_u8_u32(rgba));
+	}
+#endif
+	icon_swizzle_argb_to_rgba_scalar(src + i * 4, dst + i * 4, n_pixels - i);
+}
@@ -0,0 +1,38 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ICONSWIZZLE_H
+#define ICONSWIZZLE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * StatusNotifierItem pixmaps are ARGB32 in network byte order, so A, R, G, B
+ * bytes, and GdkPixbuf wants R, G, B, A. Both are unpremultiplied, so every
+ * pixel is only rotated by one byte.
+ */
+G_GNUC_INTERNAL void icon_swizzle_argb_to_rgba(const guint8 *src, guint8 *dst, size_t n_pixels);
+/* Same, one pixel at a time, for hosts without SSE2 or NEON and for tails */
+G_GNUC_INTERNAL void icon_swizzle_argb_to_rgba_scalar(const guint8 *src, guint8 *dst,
+                                                      size_t n_pixels);
+
+G_END_DECLS
+
+#endif // ICONSWIZZLE_H
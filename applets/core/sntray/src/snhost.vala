@@ -34,24 +34,26 @@ namespace StatusNotifier
         {
             Object(object_path: path);
         }
-        public string[] watcher_items()
+        public async string[] watcher_items()
         {
             if (is_nested_watcher)
                 return nested_watcher.registered_status_notifier_items;
-            else
+            /* Asked every time, other watchers may not send PropertiesChanged */
+            try
             {
-                WatcherIface? outer = null;
-                try
-                {
-                    outer = Bus.get_proxy_sync(BusType.SESSION,"org.kde.StatusNotifierWatcher","/StatusNotifierWatcher");
-                } catch (Error e) {stderr.printf("%s\n",e.message);}
-                return (outer != null) ? outer.registered_status_notifier_items : outer_watcher.registered_status_notifier_items;
-            }
+                var conn = yield Bus.get(BusType.SESSION);
+                var reply = yield conn.call("org.kde.StatusNotifierWatcher","/StatusNotifierWatcher",
+                                            "org.freedesktop.DBus.Properties","Get",
+                                            new Variant("(ss)","org.kde.StatusNotifierWatcher","RegisteredStatusNotifierItems"),
+                                            new VariantType("(v)"),DBusCallFlags.NONE,-1);
+                return reply.get_child_value(0).get_variant().dup_strv();
+            } catch (Error e) {stderr.printf("%s\n",e.message);}
+            return {};
         }
         private void on_bus_aquired(DBusConnection conn)
         {
             try {
-                nested_watcher = new Watcher();
+                nested_watcher = new Watcher(conn);
                 conn.register_object ("/StatusNotifierWatcher", nested_watcher);
                 nested_watcher.register_status_notifier_host(object_path);
                 nested_watcher.status_notifier_item_registered.connect((id)=>{watcher_item_added(id);});
@@ -70,13 +72,13 @@ namespace StatusNotifier
                 },
                 () => {
                     is_nested_watcher = false;
-                    create_out_watcher();
+                    create_out_watcher.begin();
                 });
         }
-        private void create_out_watcher()
+        private async void create_out_watcher()
         {
             try{
-                outer_watcher = Bus.get_proxy_sync(BusType.SESSION,"org.kde.StatusNotifierWatcher","/StatusNotifierWatcher");
+                outer_watcher = yield Bus.get_proxy(BusType.SESSION,"org.kde.StatusNotifierWatcher","/StatusNotifierWatcher");
                 watched_name = Bus.watch_name(BusType.SESSION,"org.kde.StatusNotifierWatcher",GLib.BusNameWatcherFlags.NONE,
                                                         () => {
                                                             nested_watcher = null;
@@ -89,9 +91,9 @@ namespace StatusNotifier
                                                             create_nested_watcher();
                                                             }
                                                         );
-                outer_watcher.register_status_notifier_host(object_path);
                 outer_watcher.status_notifier_item_registered.connect((id)=>{watcher_item_added(id);});
                 outer_watcher.status_notifier_item_unregistered.connect((id)=>{watcher_item_removed(id);});
+                yield outer_watcher.register_status_notifier_host(object_path);
             } catch (Error e) {
                 stderr.printf("%s\n",e.message);
                 return;
@@ -32,6 +32,7 @@ namespace StatusNotifier
     public const string USE_LABELS = "show-ayatana-labels";
     public const string INDEX_OVERRIDE = "index-override";
     public const string FILTER_OVERRIDE = "filter-override";
+    public const string ICON_CACHE_SIZE = "icon-cache-size";
     public class ItemBox : FlowBox
     {
         static Host host;
@@ -115,17 +116,19 @@ namespace StatusNotifier
         }
         private void recreate_items()
         {
-            string[] new_items = host.watcher_items();
-            foreach (var item in new_items)
-            {
-                string[] np = item.split("/",2);
-                if (!items.contains(item))
+            host.watcher_items.begin((obj,res)=>{
+                string[] new_items = host.watcher_items.end(res);
+                foreach (var item in new_items)
                 {
-                    var snitem = new Item(np[0],(ObjectPath)("/"+np[1]));
-                    items.insert(item, snitem);
-                    this.add(snitem);
+                    string[] np = item.split("/",2);
+                    if (!items.contains(item))
+                    {
+                        var snitem = new Item(np[0],(ObjectPath)("/"+np[1]));
+                        items.insert(item, snitem);
+                        this.add(snitem);
+                    }
                 }
-            }
+            });
         }
         internal bool filter_cb(FlowBoxChild ch)
         {
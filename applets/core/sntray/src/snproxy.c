@@ -17,6 +17,7 @@
  */
 
 #include "snproxy.h"
+#include "icon-cache.h"
 #include "icon-pixmap.h"
 #include "sni-enums.h"
 #include <gtk/gtk.h>
@@ -33,6 +34,9 @@ struct _SnProxy
 	GDBusProxy *item_proxy;
 	GDBusProxy *properties_proxy;
 	uint properties_timeout;
+	uint fetch_pending; /* FETCH_BIT() of properties to get when the timeout fires */
+	uint fetch_delay;
+	gint64 last_fetch;
 
 	/* Exposed as properties */
 	char *bus_name;
@@ -52,6 +56,13 @@ struct _SnProxy
 	uint x_ayatana_ordering_index;
 
 	/* Internal now */
+	char *icon_name;
+	IconPixmap *icon_pixmap;
+	char *attention_name;
+	IconPixmap *attention_pixmap;
+	char *overlay_name;
+	IconPixmap *overlay_pixmap;
+	IconPathIndex *path_index; /* Only set for a non-empty IconThemePath */
 	char *icon_desc;
 	char *attention_desc;
 	int icon_size;
@@ -96,7 +107,59 @@ enum
 static GParamSpec *pspecs[PROP_LAST];
 static uint signals[LAST_SIGNAL] = { 0 };
 
+/* Properties that New* signals are about, fetched one by one */
+enum
+{
+	FETCH_TITLE,
+	FETCH_ICON_NAME,
+	FETCH_ICON_PIXMAP,
+	FETCH_ICON_DESC,
+	FETCH_ATTENTION_NAME,
+	FETCH_ATTENTION_PIXMAP,
+	FETCH_ATTENTION_DESC,
+	FETCH_OVERLAY_NAME,
+	FETCH_OVERLAY_PIXMAP,
+	FETCH_TOOLTIP,
+	FETCH_N_PROPS
+};
+
+#define FETCH_BIT(prop) (1u << (prop))
+#define FETCH_ALL FETCH_BIT(FETCH_N_PROPS) /* GetAll, on start and icon size or theme change */
+
+#define FETCH_DELAY_MIN 10  /* ms, same approach as in Plasma Workspace */
+#define FETCH_DELAY_MAX 640 /* ms, reached by items redrawing their icon every frame */
+#define FETCH_FRAME_US (G_USEC_PER_SEC / 60)
+
+static const char *const fetch_props[FETCH_N_PROPS] = {
+	[FETCH_TITLE]            = "Title",
+	[FETCH_ICON_NAME]        = "IconName",
+	[FETCH_ICON_PIXMAP]      = "IconPixmap",
+	[FETCH_ICON_DESC]        = "IconAccessibleDesc",
+	[FETCH_ATTENTION_NAME]   = "AttentionIconName",
+	[FETCH_ATTENTION_PIXMAP] = "AttentionIconPixmap",
+	[FETCH_ATTENTION_DESC]   = "AttentionAccessibleDesc",
+	[FETCH_OVERLAY_NAME]     = "OverlayIconName",
+	[FETCH_OVERLAY_PIXMAP]   = "OverlayIconPixmap",
+	[FETCH_TOOLTIP]          = "ToolTip",
+};
+
+static const struct
+{
+	const char *signal;
+	uint fetch;
+} fetch_signals[] = {
+	{ "NewTitle", FETCH_BIT(FETCH_TITLE) },
+	{ "NewIcon",
+	  FETCH_BIT(FETCH_ICON_NAME) | FETCH_BIT(FETCH_ICON_PIXMAP) | FETCH_BIT(FETCH_ICON_DESC) },
+	{ "NewAttentionIcon",
+	  FETCH_BIT(FETCH_ATTENTION_NAME) | FETCH_BIT(FETCH_ATTENTION_PIXMAP) |
+	      FETCH_BIT(FETCH_ATTENTION_DESC) },
+	{ "NewOverlayIcon", FETCH_BIT(FETCH_OVERLAY_NAME) | FETCH_BIT(FETCH_OVERLAY_PIXMAP) },
+	{ "NewToolTip", FETCH_BIT(FETCH_TOOLTIP) },
+};
+
 void sn_proxy_reload(SnProxy *self);
+static void sn_proxy_path_index_changed(SnProxy *self);
 static void sn_proxy_finalize(GObject *object);
 static void sn_proxy_get_property(GObject *object, uint prop_id, GValue *value, GParamSpec *pspec);
 static void sn_proxy_set_property(GObject *object, uint prop_id, const GValue *value,
@@ -239,6 +302,9 @@ static void sn_proxy_init(SnProxy *self)
 	self->item_proxy         = NULL;
 	self->properties_proxy   = NULL;
 	self->properties_timeout = 0;
+	self->fetch_pending      = 0;
+	self->fetch_delay        = FETCH_DELAY_MIN;
+	self->last_fetch         = 0;
 
 	self->bus_name                 = NULL;
 	self->object_path              = NULL;
@@ -255,9 +321,16 @@ static void sn_proxy_init(SnProxy *self)
 	self->x_ayatana_label_guide    = NULL;
 	self->x_ayatana_ordering_index = 0;
 
-	self->title          = NULL;
-	self->icon_desc      = NULL;
-	self->attention_desc = NULL;
+	self->title            = NULL;
+	self->icon_name        = NULL;
+	self->icon_pixmap      = NULL;
+	self->attention_name   = NULL;
+	self->attention_pixmap = NULL;
+	self->overlay_name     = NULL;
+	self->overlay_pixmap   = NULL;
+	self->path_index       = NULL;
+	self->icon_desc        = NULL;
+	self->attention_desc   = NULL;
 
 	self->theme = gtk_icon_theme_get_default();
 
@@ -279,6 +352,10 @@ static void sn_proxy_finalize(GObject *object)
 		g_signal_handlers_disconnect_by_data(self->theme, self);
 	if (self->item_proxy)
 		g_signal_handlers_disconnect_by_data(self->item_proxy, self);
+	if (self->properties_proxy)
+		g_signal_handlers_disconnect_by_data(self->properties_proxy, self);
+	if (self->path_index)
+		g_signal_handlers_disconnect_by_data(self->path_index, self);
 
 	g_clear_object(&self->properties_proxy);
 	g_clear_object(&self->item_proxy);
@@ -296,6 +373,13 @@ static void sn_proxy_finalize(GObject *object)
 	g_clear_pointer(&self->x_ayatana_label_guide, g_free);
 
 	g_clear_pointer(&self->title, g_free);
+	g_clear_pointer(&self->icon_name, g_free);
+	g_clear_pointer(&self->icon_pixmap, icon_pixmap_free);
+	g_clear_pointer(&self->attention_name, g_free);
+	g_clear_pointer(&self->attention_pixmap, icon_pixmap_free);
+	g_clear_pointer(&self->overlay_name, g_free);
+	g_clear_pointer(&self->overlay_pixmap, icon_pixmap_free);
+	g_clear_object(&self->path_index);
 	g_clear_pointer(&self->icon_desc, g_free);
 	g_clear_pointer(&self->attention_desc, g_free);
 
@@ -432,19 +516,35 @@ static void sn_proxy_name_owner_changed(GDBusConnection *connection, const char
 		g_signal_emit(self, signals[FAIL], 0);
 }
 
+static size_t icon_cost(GIcon *icon)
+{
+	return GDK_IS_PIXBUF(icon) ? gdk_pixbuf_get_byte_length(GDK_PIXBUF(icon)) : 0;
+}
+
 static GIcon *sn_proxy_load_icon(SnProxy *self, const char *icon_name, IconPixmap *pixmap,
                                  const char *overlay, IconPixmap *opixmap)
 {
+	/* Named icons are resolved lazily by GTK, only pixmaps are worth caching */
+	IconCacheKey key = { 0 };
+	bool cacheable   = string_empty(icon_name) && string_empty(overlay) && pixmap &&
+	                 pixmap->bytes;
+	if (cacheable)
+	{
+		icon_cache_key_init(&key, pixmap, opixmap, self->icon_size, self->use_symbolic);
+		GIcon *cached = icon_cache_lookup(&key);
+		if (cached)
+			return cached;
+	}
 	g_autoptr(GIcon) tmp_main_icon    = icon_pixmap_select_icon(icon_name,
                                                                  pixmap,
                                                                  self->theme,
-                                                                 self->icon_theme_path,
+                                                                 self->path_index,
                                                                  self->icon_size,
                                                                  self->use_symbolic);
 	g_autoptr(GIcon) tmp_overlay_icon = icon_pixmap_select_icon(overlay,
 	                                                            opixmap,
 	                                                            self->theme,
-	                                                            self->icon_theme_path,
+	                                                            self->path_index,
 	                                                            self->icon_size / 4,
 	                                                            self->use_symbolic);
 	g_autoptr(GEmblem) overlay_icon   = NULL;
@@ -455,226 +555,233 @@ static GIcon *sn_proxy_load_icon(SnProxy *self, const char *icon_name, IconPixma
 		icon = g_emblemed_icon_new(tmp_main_icon, overlay_icon);
 	if (!icon)
 		return NULL;
+	if (cacheable)
+	{
+		size_t cost = icon_cost(tmp_main_icon) + icon_cost(tmp_overlay_icon);
+		icon_cache_insert(&key, icon, cost);
+	}
 	return g_object_ref(icon);
 }
 
-static void sn_proxy_reload_finish(GObject *source_object, GAsyncResult *res, gpointer user_data)
+typedef struct
 {
-	g_autoptr(GError) error = NULL;
-	g_autoptr(GVariant) properties =
-	    g_dbus_proxy_call_finish(G_DBUS_PROXY(source_object), res, &error);
-
-	if (error)
-	{
-		if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-			g_warning("%s", error->message);
-		return;
-	}
-
-	if (!SN_IS_PROXY(user_data))
-		return;
+	bool tooltip;
+	bool icon;
+	bool attention_icon;
+	bool desc;
+	bool menu;
+	bool detach; /* Values come from GetAll, whose reply holds every property */
+	ToolTip *new_tooltip;
+} SnProxyChanges;
+
+static uint sn_proxy_fetch_bit(const char *name)
+{
+	for (uint i = 0; i < FETCH_N_PROPS; i++)
+		if (!g_strcmp0(name, fetch_props[i]))
+			return FETCH_BIT(i);
+	return 0;
+}
 
-	SnProxy *self                 = SN_PROXY(user_data);
-	bool update_tooltip           = false;
-	bool update_icon              = false;
-	bool update_attention_icon    = false;
-	bool update_desc              = false;
-	bool update_menu              = false;
-	ToolTip *new_tooltip          = NULL;
-	g_autofree char *icon_name    = NULL;
-	g_autofree char *att_name     = NULL;
-	g_autofree char *overlay_name = NULL;
-	IconPixmap *icon_pixmap       = NULL;
-	IconPixmap *att_pixmap        = NULL;
-	IconPixmap *overlay_pixmap    = NULL;
+/* Replies of Get and PropertiesChanged hold only this property, referencing them is free */
+static void sn_proxy_store_pixmap(SnProxy *self, IconPixmap **pixmap, GVariant *value,
+                                  bool detach)
+{
+	g_clear_pointer(pixmap, icon_pixmap_free);
+	*pixmap = icon_pixmap_new_with_size(value, self->icon_size);
+	if (detach)
+		icon_pixmap_detach(*pixmap);
+}
 
-	if (!properties)
-	{
-		g_signal_emit(self, signals[FAIL], 0);
-		return;
-	}
-	GVariantIter *iter;
-	g_variant_get(properties, "(a{sv})", &iter);
-	char *name;
-	GVariant *value;
-	while (g_variant_iter_loop(iter, "{&sv}", &name, &value))
+static void sn_proxy_apply_property(SnProxy *self, const char *name, GVariant *value,
+                                    SnProxyChanges *changes)
+{
+	if (!g_strcmp0(name, "XAyatanaLabel"))
 	{
-		if (!g_strcmp0(name, "XAyatanaLabel"))
+		if (g_strcmp0(g_variant_get_string(value, NULL), self->x_ayatana_label))
 		{
-			if (g_strcmp0(g_variant_get_string(value, NULL), self->x_ayatana_label))
-			{
-				g_clear_pointer(&self->x_ayatana_label, g_free);
-				self->x_ayatana_label = g_variant_dup_string(value, NULL);
-				g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_LABEL]);
-			}
+			g_clear_pointer(&self->x_ayatana_label, g_free);
+			self->x_ayatana_label = g_variant_dup_string(value, NULL);
+			g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_LABEL]);
 		}
-		else if (!g_strcmp0(name, "XAyatanaLabelGuide"))
+	}
+	else if (!g_strcmp0(name, "XAyatanaLabelGuide"))
+	{
+		if (g_strcmp0(g_variant_get_string(value, NULL), self->x_ayatana_label_guide))
 		{
-			if (g_strcmp0(g_variant_get_string(value, NULL),
-			              self->x_ayatana_label_guide))
-			{
-				g_clear_pointer(&self->x_ayatana_label_guide, g_free);
-				self->x_ayatana_label_guide = g_variant_dup_string(value, NULL);
-				g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_LABEL_GUIDE]);
-			}
+			g_clear_pointer(&self->x_ayatana_label_guide, g_free);
+			self->x_ayatana_label_guide = g_variant_dup_string(value, NULL);
+			g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_LABEL_GUIDE]);
 		}
-		else if (!g_strcmp0(name, "XAyatanaOrderingIndex"))
+	}
+	else if (!g_strcmp0(name, "XAyatanaOrderingIndex"))
+	{
+		if (g_variant_get_uint32(value) != self->x_ayatana_ordering_index)
 		{
-			if (g_variant_get_uint32(value) != self->x_ayatana_ordering_index)
-			{
-				self->x_ayatana_ordering_index = g_variant_get_uint32(value);
-				g_object_notify_by_pspec(G_OBJECT(self),
-				                         pspecs[PROP_ORDERING_INDEX]);
-			}
+			self->x_ayatana_ordering_index = g_variant_get_uint32(value);
+			g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_ORDERING_INDEX]);
 		}
-		else if (!g_strcmp0(name, "Category"))
+	}
+	else if (!g_strcmp0(name, "Category"))
+	{
+		SnCategory new_cat =
+		    sn_category_get_value_from_nick(g_variant_get_string(value, NULL));
+		if (self->category != new_cat)
 		{
-			SnCategory new_cat =
-			    sn_category_get_value_from_nick(g_variant_get_string(value, NULL));
-			if (self->category != new_cat)
-				g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_CATEGORY]);
+			self->category = new_cat;
+			g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_CATEGORY]);
 		}
-		else if (!g_strcmp0(name, "Id"))
+	}
+	else if (!g_strcmp0(name, "Id"))
+	{
+		if (!self->id || g_strcmp0(g_variant_get_string(value, NULL), self->id))
 		{
-			if (!self->id || g_strcmp0(g_variant_get_string(value, NULL), self->id))
-			{
-				g_clear_pointer(&self->id, g_free);
-				self->id = g_variant_dup_string(value, NULL);
-				g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_ID]);
-			}
+			g_clear_pointer(&self->id, g_free);
+			self->id = g_variant_dup_string(value, NULL);
+			g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_ID]);
 		}
-		else if (!g_strcmp0(name, "Status"))
+	}
+	else if (!g_strcmp0(name, "Status"))
+	{
+		SnStatus new_st = sn_status_get_value_from_nick(g_variant_get_string(value, NULL));
+		if (self->status != new_st)
 		{
-			SnStatus new_st =
-			    sn_status_get_value_from_nick(g_variant_get_string(value, NULL));
-			if (self->status != new_st)
-			{
-				self->status = new_st;
-				g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_STATUS]);
-			}
+			self->status = new_st;
+			g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_STATUS]);
 		}
-		else if (!g_strcmp0(name, "Title"))
+	}
+	else if (!g_strcmp0(name, "Title"))
+	{
+		if (g_strcmp0(g_variant_get_string(value, NULL), self->title))
 		{
-			if (g_strcmp0(g_variant_get_string(value, NULL), self->title))
-			{
-				g_clear_pointer(&self->title, g_free);
-				self->title = g_variant_dup_string(value, NULL);
-				g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_TITLE]);
-				update_tooltip = true;
-			}
+			g_clear_pointer(&self->title, g_free);
+			self->title = g_variant_dup_string(value, NULL);
+			g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_TITLE]);
+			changes->tooltip = true;
 		}
-		else if (!g_strcmp0(name, "Menu"))
+	}
+	else if (!g_strcmp0(name, "Menu"))
+	{
+		if (g_strcmp0(g_variant_get_string(value, NULL), self->menu_object_path))
 		{
-			if (g_strcmp0(g_variant_get_string(value, NULL), self->menu_object_path))
-			{
-				g_clear_pointer(&self->menu_object_path, g_free);
-				self->menu_object_path = g_variant_dup_string(value, NULL);
-				update_menu            = true;
-			}
+			g_clear_pointer(&self->menu_object_path, g_free);
+			self->menu_object_path = g_variant_dup_string(value, NULL);
+			changes->menu          = true;
 		}
-		else if (!g_strcmp0(name, "ItemIsMenu"))
+	}
+	else if (!g_strcmp0(name, "ItemIsMenu"))
+	{
+		if (g_variant_get_boolean(value) != self->item_is_menu)
 		{
-			if (g_variant_get_boolean(value) != self->item_is_menu)
-			{
-				self->item_is_menu = g_variant_get_boolean(value);
-				update_menu        = true;
-			}
+			self->item_is_menu = g_variant_get_boolean(value);
+			changes->menu      = true;
 		}
-		else if (!g_strcmp0(name, "IconAccessibleDesc"))
+	}
+	else if (!g_strcmp0(name, "IconAccessibleDesc"))
+	{
+		if (g_strcmp0(g_variant_get_string(value, NULL), self->icon_desc))
 		{
-			if (g_strcmp0(g_variant_get_string(value, NULL), self->icon_desc))
-			{
-				g_clear_pointer(&self->icon_desc, g_free);
-				self->icon_desc = g_variant_dup_string(value, NULL);
-				update_desc     = true;
-				update_tooltip  = true;
-			}
+			g_clear_pointer(&self->icon_desc, g_free);
+			self->icon_desc  = g_variant_dup_string(value, NULL);
+			changes->desc    = true;
+			changes->tooltip = true;
 		}
-		else if (!g_strcmp0(name, "AttentionAccessibleDesc"))
+	}
+	else if (!g_strcmp0(name, "AttentionAccessibleDesc"))
+	{
+		if (g_strcmp0(g_variant_get_string(value, NULL), self->attention_desc))
 		{
-			if (g_strcmp0(g_variant_get_string(value, NULL), self->attention_desc))
+			g_clear_pointer(&self->attention_desc, g_free);
+			self->attention_desc = g_variant_dup_string(value, NULL);
+			if (self->status == SN_STATUS_ATTENTION)
 			{
-				g_clear_pointer(&self->attention_desc, g_free);
-				self->attention_desc = g_variant_dup_string(value, NULL);
-				if (self->status == SN_STATUS_ATTENTION)
-				{
-					update_desc    = true;
-					update_tooltip = true;
-				}
+				changes->desc    = true;
+				changes->tooltip = true;
 			}
 		}
-		else if (!g_strcmp0(name, "IconThemePath"))
+	}
+	else if (!g_strcmp0(name, "IconThemePath"))
+	{
+		if (g_strcmp0(g_variant_get_string(value, NULL), self->icon_theme_path))
 		{
-			if (g_strcmp0(g_variant_get_string(value, NULL), self->icon_theme_path))
+			g_clear_pointer(&self->icon_theme_path, g_free);
+			self->icon_theme_path = g_variant_dup_string(value, NULL);
+			gtk_icon_theme_append_search_path(self->theme, self->icon_theme_path);
+			if (self->path_index)
+				g_signal_handlers_disconnect_by_data(self->path_index, self);
+			g_clear_object(&self->path_index);
+			if (!string_empty(self->icon_theme_path))
 			{
-				g_clear_pointer(&self->icon_theme_path, g_free);
-				self->icon_theme_path = g_variant_dup_string(value, NULL);
-				gtk_icon_theme_append_search_path(self->theme,
-				                                  self->icon_theme_path);
-				update_icon           = true;
-				update_attention_icon = true;
+				self->path_index = icon_path_index_get(self->icon_theme_path);
+				g_signal_connect_swapped(self->path_index,
+				                         ICON_PATH_INDEX_SIGNAL_CHANGED,
+				                         G_CALLBACK(sn_proxy_path_index_changed),
+				                         self);
 			}
-		}
-		else if (!g_strcmp0(name, "IconName"))
-		{
-			icon_name   = g_variant_dup_string(value, NULL);
-			update_icon = true;
-		}
-		else if (!g_strcmp0(name, "AttentionIconName"))
-		{
-			att_name              = g_variant_dup_string(value, NULL);
-			update_attention_icon = true;
-		}
-		else if (!g_strcmp0(name, "OverlayIconName"))
-		{
-			overlay_name          = g_variant_dup_string(value, NULL);
-			update_icon           = true;
-			update_attention_icon = true;
-		}
-		else if (!g_strcmp0(name, "IconPixmap"))
-		{
-			icon_pixmap = icon_pixmap_new_with_size(value, self->icon_size);
-			update_icon = true;
-		}
-		else if (!g_strcmp0(name, "AttentionIconPixmap"))
-		{
-			att_pixmap            = icon_pixmap_new_with_size(value, self->icon_size);
-			update_attention_icon = true;
-		}
-		else if (!g_strcmp0(name, "OverlayIconPixmap"))
-		{
-			overlay_pixmap        = icon_pixmap_new_with_size(value, self->icon_size);
-			update_icon           = true;
-			update_attention_icon = true;
-		}
-		else if (!g_strcmp0(name, "ToolTip"))
-		{
-			new_tooltip    = tooltip_new(value);
-			update_tooltip = true;
+			changes->icon           = true;
+			changes->attention_icon = true;
 		}
 	}
-	g_clear_pointer(&iter, g_variant_iter_free);
-	g_clear_pointer(&name, g_free);
-	g_clear_pointer(&value, g_variant_unref);
-	if (update_desc)
+	else if (!g_strcmp0(name, "IconName"))
+	{
+		g_clear_pointer(&self->icon_name, g_free);
+		self->icon_name = g_variant_dup_string(value, NULL);
+		changes->icon   = true;
+	}
+	else if (!g_strcmp0(name, "AttentionIconName"))
+	{
+		g_clear_pointer(&self->attention_name, g_free);
+		self->attention_name    = g_variant_dup_string(value, NULL);
+		changes->attention_icon = true;
+	}
+	else if (!g_strcmp0(name, "OverlayIconName"))
+	{
+		g_clear_pointer(&self->overlay_name, g_free);
+		self->overlay_name      = g_variant_dup_string(value, NULL);
+		changes->icon           = true;
+		changes->attention_icon = true;
+	}
+	else if (!g_strcmp0(name, "IconPixmap"))
+	{
+		sn_proxy_store_pixmap(self, &self->icon_pixmap, value, changes->detach);
+		changes->icon = true;
+	}
+	else if (!g_strcmp0(name, "AttentionIconPixmap"))
+	{
+		sn_proxy_store_pixmap(self, &self->attention_pixmap, value, changes->detach);
+		changes->attention_icon = true;
+	}
+	else if (!g_strcmp0(name, "OverlayIconPixmap"))
+	{
+		sn_proxy_store_pixmap(self, &self->overlay_pixmap, value, changes->detach);
+		changes->icon           = true;
+		changes->attention_icon = true;
+	}
+	else if (!g_strcmp0(name, "ToolTip"))
+	{
+		g_clear_pointer(&changes->new_tooltip, tooltip_free);
+		changes->new_tooltip = tooltip_new(value);
+		changes->tooltip     = true;
+	}
+}
+
+static void sn_proxy_apply_changes(SnProxy *self, SnProxyChanges *changes)
+{
+	if (changes->desc)
 		g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_DESC]);
-	if (update_menu)
+	if (changes->menu)
 		g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_MENU_OBJECT_PATH]);
-	if (update_tooltip)
+	if (changes->new_tooltip)
 	{
 		char *markup     = NULL;
 		GIcon *icon      = NULL;
 		bool notify_text = false;
 		bool notify_icon = false;
-		if (new_tooltip)
-		{
-			unbox_tooltip(new_tooltip,
-			              self->theme,
-			              self->icon_theme_path,
-			              &icon,
-			              &markup);
-			g_clear_pointer(&new_tooltip, tooltip_free);
-		}
+		unbox_tooltip(changes->new_tooltip,
+		              self->theme,
+		              self->path_index,
+		              &icon,
+		              &markup);
+		g_clear_pointer(&changes->new_tooltip, tooltip_free);
 		if (g_strcmp0(markup, self->tooltip_text))
 			notify_text = true;
 		if (!g_icon_equal(self->tooltip_icon, icon))
@@ -688,32 +795,74 @@ static void sn_proxy_reload_finish(GObject *source_object, GAsyncResult *res, gp
 		if (notify_icon)
 			g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_TOOLTIP_ICON]);
 	}
-	if (update_icon)
+	/* Title or description only matter when tooltip falls back to them */
+	else if (changes->tooltip)
+		g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_TOOLTIP_TEXT]);
+	if (changes->icon)
 	{
-		g_autoptr(GIcon) new_icon =
-		    sn_proxy_load_icon(self, icon_name, icon_pixmap, overlay_name, overlay_pixmap);
+		g_autoptr(GIcon) new_icon = sn_proxy_load_icon(self,
+		                                               self->icon_name,
+		                                               self->icon_pixmap,
+		                                               self->overlay_name,
+		                                               self->overlay_pixmap);
 		if (!g_icon_equal(self->icon, new_icon))
 		{
 			g_clear_object(&self->icon);
-			self->icon = g_object_ref(new_icon);
+			self->icon = g_steal_pointer(&new_icon);
 			g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_ICON]);
 		}
 	}
-	if (update_attention_icon)
+	if (changes->attention_icon)
 	{
-		g_autoptr(GIcon) new_icon =
-		    sn_proxy_load_icon(self, att_name, att_pixmap, overlay_name, overlay_pixmap);
+		g_autoptr(GIcon) new_icon = sn_proxy_load_icon(self,
+		                                               self->attention_name,
+		                                               self->attention_pixmap,
+		                                               self->overlay_name,
+		                                               self->overlay_pixmap);
 		if (!g_icon_equal(self->attention_icon, new_icon))
 		{
 			g_clear_object(&self->attention_icon);
-			self->attention_icon = g_object_ref(new_icon);
+			self->attention_icon = g_steal_pointer(&new_icon);
 			if (self->status == SN_STATUS_ATTENTION)
 				g_object_notify_by_pspec(G_OBJECT(self), pspecs[PROP_ICON]);
 		}
 	}
-	g_clear_pointer(&icon_pixmap, icon_pixmap_free);
-	g_clear_pointer(&att_pixmap, icon_pixmap_free);
-	g_clear_pointer(&overlay_pixmap, icon_pixmap_free);
+}
+
+static void sn_proxy_reload_finish(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GVariant) properties =
+	    g_dbus_proxy_call_finish(G_DBUS_PROXY(source_object), res, &error);
+
+	if (error)
+	{
+		if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			g_warning("%s", error->message);
+		return;
+	}
+
+	if (!SN_IS_PROXY(user_data))
+		return;
+
+	SnProxy *self          = SN_PROXY(user_data);
+	SnProxyChanges changes = { .detach = true };
+
+	if (!properties)
+	{
+		g_signal_emit(self, signals[FAIL], 0);
+		return;
+	}
+	GVariantIter *iter;
+	g_variant_get(properties, "(a{sv})", &iter);
+	char *name;
+	GVariant *value;
+	while (g_variant_iter_loop(iter, "{&sv}", &name, &value))
+		sn_proxy_apply_property(self, name, value, &changes);
+	g_clear_pointer(&iter, g_variant_iter_free);
+	g_clear_pointer(&name, g_free);
+	g_clear_pointer(&value, g_variant_unref);
+	sn_proxy_apply_changes(self, &changes);
 	if (!self->initialized)
 	{
 		if (self->id != NULL)
@@ -728,33 +877,166 @@ static void sn_proxy_reload_finish(GObject *source_object, GAsyncResult *res, gp
 	}
 }
 
+typedef struct
+{
+	SnProxy *self;
+	SnProxyChanges changes;
+	uint pending;
+	bool cancelled;
+} SnProxyFetch;
+
+typedef struct
+{
+	SnProxyFetch *fetch;
+	const char *name;
+} SnProxyFetchCall;
+
+static void sn_proxy_fetch_finish(GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+	SnProxyFetchCall *call  = user_data;
+	SnProxyFetch *fetch     = call->fetch;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GVariant) result =
+	    g_dbus_proxy_call_finish(G_DBUS_PROXY(source_object), res, &error);
+
+	if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		fetch->cancelled = true;
+	/* Optional properties are often not implemented at all */
+	else if (error)
+		g_debug("%s: %s", call->name, error->message);
+	else
+	{
+		g_autoptr(GVariant) value = NULL;
+		g_variant_get(result, "(v)", &value);
+		sn_proxy_apply_property(fetch->self, call->name, value, &fetch->changes);
+	}
+	g_free(call);
+
+	/* Results of one fetch are applied together, so the icon is built once */
+	if (--fetch->pending > 0)
+		return;
+	if (!fetch->cancelled)
+		sn_proxy_apply_changes(fetch->self, &fetch->changes);
+	g_clear_pointer(&fetch->changes.new_tooltip, tooltip_free);
+	g_free(fetch);
+}
+
 static int sn_proxy_reload_begin(gpointer user_data)
 {
 	SnProxy *self = user_data;
+	uint pending  = self->fetch_pending;
 
 	self->properties_timeout = 0;
+	self->fetch_pending      = 0;
+	if (pending == 0)
+		return G_SOURCE_REMOVE;
+	self->last_fetch = g_get_monotonic_time();
 
-	g_dbus_proxy_call(self->properties_proxy,
-	                  "GetAll",
-	                  g_variant_new("(s)", "org.kde.StatusNotifierItem"),
-	                  G_DBUS_CALL_FLAGS_NONE,
-	                  -1,
-	                  self->cancellable,
-	                  sn_proxy_reload_finish,
-	                  self);
+	if (pending & FETCH_ALL)
+	{
+		g_dbus_proxy_call(self->properties_proxy,
+		                  "GetAll",
+		                  g_variant_new("(s)", PROXY_DBUS_IFACE_KDE),
+		                  G_DBUS_CALL_FLAGS_NONE,
+		                  -1,
+		                  self->cancellable,
+		                  sn_proxy_reload_finish,
+		                  self);
+		return G_SOURCE_REMOVE;
+	}
+
+	SnProxyFetch *fetch = g_new0(SnProxyFetch, 1);
+	fetch->self         = self;
+	for (uint i = 0; i < FETCH_N_PROPS; i++)
+	{
+		if (!(pending & FETCH_BIT(i)))
+			continue;
+		SnProxyFetchCall *call = g_new0(SnProxyFetchCall, 1);
+		call->fetch            = fetch;
+		call->name             = fetch_props[i];
+		fetch->pending++;
+		g_dbus_proxy_call(self->properties_proxy,
+		                  "Get",
+		                  g_variant_new("(ss)", PROXY_DBUS_IFACE_KDE, call->name),
+		                  G_DBUS_CALL_FLAGS_NONE,
+		                  -1,
+		                  self->cancellable,
+		                  sn_proxy_fetch_finish,
+		                  call);
+	}
 
 	return G_SOURCE_REMOVE;
 }
 
+static void sn_proxy_queue_fetch(SnProxy *self, uint fetch)
+{
+	self->fetch_pending |= fetch;
+	/* Coalesced, not restarted, so an item that never stops signalling is still updated */
+	if (self->properties_timeout != 0)
+		return;
+
+	/* Items signalling again within a frame of the last fetch are backed off,
+	 * and recover once they stay quiet for longer than they are delayed */
+	gint64 gap = g_get_monotonic_time() - self->last_fetch;
+	if (gap < FETCH_FRAME_US)
+		self->fetch_delay = MIN(self->fetch_delay * 2, FETCH_DELAY_MAX);
+	else if (gap > (gint64)self->fetch_delay * 1000)
+		self->fetch_delay = MAX(self->fetch_delay / 2, FETCH_DELAY_MIN);
+	self->properties_timeout = g_timeout_add(self->fetch_delay, sn_proxy_reload_begin, self);
+}
+
 void sn_proxy_reload(SnProxy *self)
 {
 	g_return_if_fail(SN_IS_PROXY(self));
 	g_return_if_fail(self->properties_proxy != NULL);
 
-	/* same approach as in Plasma Workspace */
-	if (self->properties_timeout != 0)
-		g_source_remove(self->properties_timeout);
-	self->properties_timeout = g_timeout_add(10, sn_proxy_reload_begin, self);
+	sn_proxy_queue_fetch(self, FETCH_ALL);
+}
+
+/* Icons from the item's own path are only found once its index is built */
+static void sn_proxy_path_index_changed(SnProxy *self)
+{
+	SnProxyChanges changes = { .icon = true, .attention_icon = true };
+	sn_proxy_apply_changes(self, &changes);
+	/* Tooltip is not kept unparsed, so get it again */
+	sn_proxy_queue_fetch(self, FETCH_BIT(FETCH_TOOLTIP));
+}
+
+static void sn_proxy_properties_changed(GDBusProxy *proxy, gchar *sender_name, gchar *signal_name,
+                                        GVariant *parameters, gpointer user_data)
+{
+	if (!SN_IS_PROXY(user_data))
+		return;
+
+	SnProxy *self = SN_PROXY(user_data);
+	if (!self->initialized || g_strcmp0(signal_name, "PropertiesChanged") ||
+	    !g_variant_is_of_type(parameters, G_VARIANT_TYPE("(sa{sv}as)")))
+		return;
+
+	const char *iface                    = NULL;
+	g_autoptr(GVariant) changed          = NULL;
+	g_autofree const char **invalidated  = NULL;
+	SnProxyChanges changes               = { 0 };
+	g_variant_get(parameters, "(&s@a{sv}^a&s)", &iface, &changed, &invalidated);
+	if (g_strcmp0(iface, PROXY_DBUS_IFACE_KDE))
+		return;
+
+	GVariantIter iter;
+	const char *name;
+	GVariant *value;
+	g_variant_iter_init(&iter, changed);
+	while (g_variant_iter_loop(&iter, "{&sv}", &name, &value))
+	{
+		sn_proxy_apply_property(self, name, value, &changes);
+		/* Already fresh, do not fetch it again for the matching New* signal */
+		self->fetch_pending &= ~sn_proxy_fetch_bit(name);
+	}
+	for (size_t i = 0; invalidated[i] != NULL; i++)
+	{
+		uint bit = sn_proxy_fetch_bit(invalidated[i]);
+		sn_proxy_queue_fetch(self, bit != 0 ? bit : FETCH_ALL);
+	}
+	sn_proxy_apply_changes(self, &changes);
 }
 
 static void sn_proxy_properties_callback(GObject *source_object, GAsyncResult *res,
@@ -780,6 +1062,10 @@ static void sn_proxy_properties_callback(GObject *source_object, GAsyncResult *r
 		g_signal_emit(self, signals[FAIL], 0);
 		return;
 	}
+	g_signal_connect(self->properties_proxy,
+	                 "g-signal",
+	                 G_CALLBACK(sn_proxy_properties_changed),
+	                 self);
 	sn_proxy_reload(self);
 }
 
@@ -793,12 +1079,15 @@ static void sn_proxy_signal_received(GDBusProxy *proxy, gchar *sender_name, gcha
 	if (!self->initialized)
 		return;
 
-	if (!g_strcmp0(signal_name, "NewTitle") || !g_strcmp0(signal_name, "NewIcon") ||
-	    !g_strcmp0(signal_name, "NewAttentionIcon") ||
-	    !g_strcmp0(signal_name, "NewOverlayIcon") || !g_strcmp0(signal_name, "NewToolTip"))
+	uint fetch = 0;
+	for (size_t i = 0; i < G_N_ELEMENTS(fetch_signals); i++)
+		if (!g_strcmp0(signal_name, fetch_signals[i].signal))
+			fetch = fetch_signals[i].fetch;
+
+	if (fetch != 0)
 	{
-		// Reload all properties in async mode.
-		sn_proxy_reload(self);
+		// Fetch only the properties this signal is about, in async mode.
+		sn_proxy_queue_fetch(self, fetch);
 	}
 	else if (!g_strcmp0(signal_name, "NewStatus"))
 	{
@@ -852,7 +1141,7 @@ static void sn_proxy_item_callback(GObject *source_object, GAsyncResult *res, gp
 	g_signal_connect(self->item_proxy, "g-signal", G_CALLBACK(sn_proxy_signal_received), self);
 
 	g_dbus_proxy_new(g_dbus_proxy_get_connection(self->item_proxy),
-	                 G_DBUS_PROXY_FLAGS_NONE,
+	                 G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 	                 NULL,
 	                 self->bus_name,
 	                 self->object_path,
@@ -894,8 +1183,9 @@ void sn_proxy_start(SnProxy *self)
 	}
 
 	self->started = true;
+	/* Properties are fetched by SnProxy itself, a cached GetAll would only be parsed twice */
 	g_dbus_proxy_new_for_bus(G_BUS_TYPE_SESSION,
-	                         G_DBUS_PROXY_FLAGS_NONE,
+	                         G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
 	                         NULL,
 	                         self->bus_name,
 	                         self->object_path,
@@ -40,7 +40,7 @@ namespace StatusNotifier
         public abstract int protocol_version {get;}
         /* Public methods */
         public abstract void register_status_notifier_item(string service) throws Error;
-        public abstract void register_status_notifier_host(string service) throws Error;
+        public abstract async void register_status_notifier_host(string service) throws Error;
     }
     [DBus (name = "org.kde.StatusNotifierWatcher")]
     public class Watcher : Object
@@ -53,10 +53,16 @@ namespace StatusNotifier
         /* Hashes */
         private HashTable<string,uint> name_watcher = new HashTable<string,uint>(str_hash, str_equal);
         private HashTable<string,uint> hosts = new HashTable<string,uint>(str_hash, str_equal);
+        private DBusConnection connection;
+        private uint items_changed_idle;
         /* Public properties */
         public string[] registered_status_notifier_items {owned get {return get_registered_items();}}
         public bool is_status_notifier_host_registered {get; private set; default = true;}
         public int protocol_version {get {return 0;}}
+        public Watcher(DBusConnection connection)
+        {
+            this.connection = connection;
+        }
         /* Public methods */
         public void register_status_notifier_item(string service, BusName sender)
         {
@@ -79,23 +85,12 @@ namespace StatusNotifier
                 remove(id);
             }
             var name_handler = Bus.watch_name(BusType.SESSION,name,GLib.BusNameWatcherFlags.NONE,
-                                                ()=>{
-                                                    try {
-                                                        ItemIface ping_iface = Bus.get_proxy_sync(BusType.SESSION,name,path);
-                                                        ping_iface.notify.connect((pspec)=>{
-                                                            if (ping_iface.id == null ||
-                                                            ping_iface.title == null ||
-                                                            ping_iface.id.length <= 0 ||
-                                                            ping_iface.title.length <= 0)
-                                                                remove(get_id(name,path));
-                                                        });
-                                                    } catch (Error e) {remove(get_id(name,path));}
-                                                },
+                                                () => {ping_item.begin(name,path);},
                                                 () => {remove(get_id(name,path));}
                                                 );
             name_watcher.insert(id,name_handler);
             status_notifier_item_registered(id);
-            this.notify_property("registered-status-notifier-items");
+            queue_items_changed();
         }
         public void register_status_notifier_host(string service) throws Error
         {
@@ -113,16 +108,54 @@ namespace StatusNotifier
             Bus.unwatch_name(name);
             status_notifier_host_unregistered();
         }
+        /* Asynchronous, so apps registering together at login do not block the panel */
+        private async void ping_item(string name, string path)
+        {
+            try {
+                ItemIface ping_iface = yield Bus.get_proxy(BusType.SESSION,name,path);
+                ping_iface.notify.connect((pspec)=>{
+                    if (ping_iface.id == null ||
+                    ping_iface.title == null ||
+                    ping_iface.id.length <= 0 ||
+                    ping_iface.title.length <= 0)
+                        remove(get_id(name,path));
+                });
+            } catch (Error e) {remove(get_id(name,path));}
+        }
+        private void queue_items_changed()
+        {
+            if (items_changed_idle == 0)
+                items_changed_idle = Idle.add(emit_items_changed);
+        }
+        /* Coalesced, so a burst of registrations sends the list once */
+        private bool emit_items_changed()
+        {
+            items_changed_idle = 0;
+            this.notify_property("registered-status-notifier-items");
+            var changed = new VariantBuilder(VariantType.VARDICT);
+            changed.add("{sv}","RegisteredStatusNotifierItems",new Variant.strv(get_registered_items()));
+            try {
+                connection.emit_signal(null,"/StatusNotifierWatcher","org.freedesktop.DBus.Properties","PropertiesChanged",
+                                        new Variant.tuple({new Variant.string("org.kde.StatusNotifierWatcher"),
+                                                           changed.end(),
+                                                           new Variant.strv({})}));
+            } catch (Error e) {
+                stderr.printf("%s\n",e.message);
+            }
+            return Source.REMOVE;
+        }
         private void remove(string id)
         {
+            /* Both the name watch and the ping may report the same item gone */
+            if (!(id in name_watcher))
+                return;
             string outer = id.dup();
             uint name = name_watcher.lookup(id);
             if(name != 0)
                 Bus.unwatch_name(name);
             name_watcher.remove(id);
             status_notifier_item_unregistered(outer);
-            this.notify_property("registered-status-notifier-items");
-            /* FIXME PropertiesChanged for RegisteredStatusNotifierItems*/
+            queue_items_changed();
         }
         private string get_id(string name, string path)
         {
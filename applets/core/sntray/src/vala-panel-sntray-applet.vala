@@ -46,6 +46,13 @@ public class SNTray: Applet
                                    (SettingsBindGetMappingShared)get_vardict,
                                    (SettingsBindSetMappingShared)set_vardict,
                                    (void*)"b",null);
+        /* Cache is shared by the whole process, so the last applet to set it wins */
+        IconCache.set_budget((size_t)settings.get_int(ICON_CACHE_SIZE) * 1024);
+        settings.changed[ICON_CACHE_SIZE].connect((k)=>{
+            log_cache_stats();
+            IconCache.set_budget((size_t)settings.get_int(k) * 1024);
+        });
+        this.destroy.connect(log_cache_stats);
         layout.orientation = (toplevel.orientation == Orientation.HORIZONTAL) ? Orientation.VERTICAL:Orientation.HORIZONTAL;
         toplevel.notify["orientation"].connect((o,a)=> {
             layout.orientation = (toplevel.orientation == Orientation.HORIZONTAL) ? Orientation.VERTICAL:Orientation.HORIZONTAL;
@@ -60,6 +67,15 @@ public class SNTray: Applet
         dlg.configure_icon_size = false;
         return dlg;
     }
+    /* Run with G_MESSAGES_DEBUG=all to see whether the budget fits the tray */
+    private static void log_cache_stats()
+    {
+        IconCache.Stats stats;
+        IconCache.get_stats(out stats);
+        debug("Icon cache: %s hits of %s lookups, %s evictions, %u entries in %s bytes",
+              stats.hits.to_string(),stats.lookups.to_string(),stats.evictions.to_string(),
+              stats.entries,stats.bytes.to_string());
+    }
     private static bool get_vardict(Value val, Variant variant,void* data)
     {
         var iter = variant.iterator();
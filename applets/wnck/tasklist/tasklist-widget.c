@@ -160,6 +160,9 @@ struct _XfceTasklist
 	/* whether decorate labels when window is not visible */
 	bool label_decorations : 1;
 
+	/* whether button updates are deferred, because nobody can see them */
+	bool paused : 1;
+
 	/* whether we only show windows that are in the geometry of
 	 * the monitor the tasklist is on */
 	bool all_monitors : 1;
@@ -238,6 +241,9 @@ struct _XfceTasklistChild
 	/* wnck information */
 	WnckWindow *window;
 	WnckClassGroup *class_group;
+
+	/* name or icon changed while the tasklist was paused */
+	bool stale : 1;
 };
 
 static const GtkTargetEntry source_targets[] = { { "application/x-wnck-window-id", 0, 0 } };
@@ -2281,6 +2287,11 @@ static void xfce_tasklist_button_icon_changed(WnckWindow *window, XfceTasklistCh
 	/* 0 means icons are disabled */
 	if (tasklist->minimized_icon_lucency == 0)
 		return;
+	if (tasklist->paused)
+	{
+		child->stale = true;
+		return;
+	}
 	g_object_get(VALA_PANEL_TOPLEVEL(xfce_tasklist_get_toplevel(tasklist)),
 	             VALA_PANEL_KEY_ICON_SIZE,
 	             &icon_size,
@@ -2327,6 +2338,13 @@ static void xfce_tasklist_button_name_changed(WnckWindow *window, XfceTasklistCh
 	g_return_if_fail(WNCK_IS_WINDOW(child->window));
 	g_return_if_fail(XFCE_IS_TASKLIST(child->tasklist));
 
+	/* titles of busy windows change often, catch up on resume */
+	if (child->tasklist->paused)
+	{
+		child->stale = true;
+		return;
+	}
+
 	name = wnck_window_get_name(child->window);
 	gtk_widget_set_tooltip_text(GTK_WIDGET(child->button), name);
 
@@ -3970,6 +3988,35 @@ void xfce_tasklist_set_label_decorations(XfceTasklist *tasklist, bool label_deco
 	}
 }
 
+void xfce_tasklist_set_paused(XfceTasklist *tasklist, bool paused)
+{
+	GList *li;
+	XfceTasklistChild *child;
+	bool resort = false;
+
+	g_return_if_fail(XFCE_IS_TASKLIST(tasklist));
+
+	if (tasklist->paused == paused)
+		return;
+	tasklist->paused = paused;
+	if (paused)
+		return;
+
+	/* refresh once what was skipped, and sort once for all of it */
+	for (li = tasklist->windows; li != NULL; li = li->next)
+	{
+		child = li->data;
+		if (!child->stale || child->window == NULL)
+			continue;
+		child->stale = false;
+		xfce_tasklist_button_icon_changed(child->window, child);
+		xfce_tasklist_button_name_changed(NULL, child);
+		resort = true;
+	}
+	if (resort)
+		xfce_tasklist_sort(tasklist);
+}
+
 void xfce_tasklist_set_grouping(XfceTasklist *tasklist, XfceTasklistGrouping grouping)
 {
 	g_return_if_fail(XFCE_IS_TASKLIST(tasklist));
@@ -94,6 +94,8 @@ void xfce_tasklist_set_grouping(XfceTasklist *tasklist, XfceTasklistGrouping gro
 
 void xfce_tasklist_set_label_decorations(XfceTasklist *tasklist, bool label_decorations);
 
+void xfce_tasklist_set_paused(XfceTasklist *tasklist, bool paused);
+
 void xfce_tasklist_update_edge(XfceTasklist *tasklist, GtkPositionType edge);
 
 G_END_DECLS
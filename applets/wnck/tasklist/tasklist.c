@@ -78,6 +78,16 @@ static void tasklist_notify_orientation_connect(GObject *topo, GParamSpec *pspec
 	}
 }
 
+static void tasklist_notify_visibility(GObject *topo, G_GNUC_UNUSED GParamSpec *pspec, void *data)
+{
+	ValaPanelToplevel *top = VALA_PANEL_TOPLEVEL(topo);
+	if (!XFCE_IS_TASKLIST(data))
+		return;
+	xfce_tasklist_set_paused(XFCE_TASKLIST(data),
+	                         vala_panel_toplevel_get_visibility(top) !=
+	                             VALA_PANEL_VISIBILITY_VISIBLE);
+}
+
 static void tasklist_applet_constructed(GObject *obj)
 {
 	TaskListApplet *self        = TASKLIST_APPLET(obj);
@@ -97,6 +107,10 @@ static void tasklist_applet_constructed(GObject *obj)
 	                       "notify",
 	                       G_CALLBACK(tasklist_notify_orientation_connect),
 	                       self->widget);
+	g_signal_connect(toplevel,
+	                 "notify::" VALA_PANEL_KEY_VISIBILITY,
+	                 G_CALLBACK(tasklist_notify_visibility),
+	                 self->widget);
 	xfce_tasklist_set_button_relief(self->widget, GTK_RELIEF_NONE);
 	g_signal_connect(settings, "changed", G_CALLBACK(tasklist_settings_changed), self);
 	xfce_tasklist_set_include_all_workspaces(self->widget,
@@ -120,6 +134,7 @@ static void tasklist_applet_constructed(GObject *obj)
 	                              g_settings_get_boolean(settings, TASKLIST_SHOW_LABELS));
 	xfce_tasklist_set_orientation(self->widget, orient);
 	xfce_tasklist_update_edge(self->widget, vala_panel_edge_from_gravity(gravity));
+	tasklist_notify_visibility(G_OBJECT(toplevel), NULL, self->widget);
 	gtk_container_add(GTK_CONTAINER(self), GTK_WIDGET(widget));
 	gtk_widget_show(GTK_WIDGET(widget));
 	gtk_widget_show(GTK_WIDGET(self));
@@ -155,8 +170,9 @@ static void tasklist_applet_init(G_GNUC_UNUSED TaskListApplet *self)
 
 static void tasklist_applet_displose(GObject *base)
 {
-	TaskListApplet *self = TASKLIST_APPLET(base);
-	g_signal_handlers_disconnect_by_data(self, self->widget);
+	TaskListApplet *self        = TASKLIST_APPLET(base);
+	ValaPanelToplevel *toplevel = vala_panel_applet_get_toplevel(VALA_PANEL_APPLET(self));
+	g_signal_handlers_disconnect_by_data(toplevel, self->widget);
 	g_signal_handlers_disconnect_by_data(self, self);
 	G_OBJECT_CLASS(tasklist_applet_parent_class)->dispose(base);
 }
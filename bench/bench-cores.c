@@ -0,0 +1,135 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Per-tick cost of the per-core CPU heatmap: parsing every cpuN line of a
+ * synthetic /proc/stat, computing loads and rasterizing the new column.
+ * Fails if 256 cores take more than TICK_BUDGET_US.
+ *
+ * Usage: bench-cores [ITERATIONS]
+ */
+
+#include <cairo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "graph-private.h"
+#include "procfs.h"
+
+#define DEFAULT_ITERATIONS 2000
+#define TICK_BUDGET_US 300.0
+#define BUDGET_CORES 256
+#define WIDTH 64
+#define HEIGHT 32
+
+static const uint core_counts[] = { 8, 64, 128, 256, 512 };
+
+static guint64 now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (guint64)ts.tv_sec * G_GUINT64_CONSTANT(1000000000) + (guint64)ts.tv_nsec;
+}
+
+/* Looks like /proc/stat of a busy host, @tick advances the counters */
+static GString *fake_stat(uint n_cores, uint tick)
+{
+	GString *stat = g_string_new(NULL);
+	guint64 base  = G_GUINT64_CONSTANT(123456789) + tick * 100;
+	g_string_append_printf(stat,
+	                       "cpu  %" G_GUINT64_FORMAT " 1234 %" G_GUINT64_FORMAT
+	                       " %" G_GUINT64_FORMAT " 5678 0 910 0 0 0\n",
+	                       base * n_cores,
+	                       base * n_cores / 4,
+	                       base * n_cores * 2);
+	for (uint i = 0; i < n_cores; i++)
+	{
+		guint64 busy = base + (guint64)tick * ((i * 37) % 101);
+		g_string_append_printf(stat,
+		                       "cpu%u %" G_GUINT64_FORMAT " 12 %" G_GUINT64_FORMAT
+		                       " %" G_GUINT64_FORMAT " 56 0 9 0 0 0\n",
+		                       i,
+		                       busy,
+		                       busy / 4,
+		                       base * 2 + (guint64)tick * (100 - (i * 37) % 101));
+	}
+	g_string_append(stat, "intr 1234567 0 9 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n");
+	g_string_append(stat, "ctxt 123456789\nbtime 1700000000\nprocesses 12345\n");
+	return stat;
+}
+
+int main(int argc, char **argv)
+{
+	uint iterations = argc > 1 ? (uint)strtoul(argv[1], NULL, 10) : DEFAULT_ITERATIONS;
+	bool ok         = true;
+	if (iterations == 0)
+		iterations = DEFAULT_ITERATIONS;
+	for (uint c = 0; c < G_N_ELEMENTS(core_counts); c++)
+	{
+		uint n_cores = core_counts[c];
+		/* Two states of the file, so that loads are not all zero */
+		GString *stat[2] = { fake_stat(n_cores, 0), fake_stat(n_cores, 1) };
+		ValaPanelCpuSample cpu, *cores = g_new0(ValaPanelCpuSample, n_cores);
+		ValaPanelCpuSample *previous   = g_new0(ValaPanelCpuSample, n_cores);
+		double *values                 = g_new0(double, n_cores);
+
+		GraphRing ring;
+		graph_ring_init(&ring, n_cores);
+		graph_ring_resize(&ring, WIDTH, HEIGHT);
+		ring.style     = VALA_PANEL_GRAPH_HEATMAP;
+		ring.colors[0] = 0xff3399ff;
+		cairo_surface_t *surface =
+		    cairo_image_surface_create(CAIRO_FORMAT_ARGB32, WIDTH, HEIGHT);
+		graph_ring_render(&ring, surface);
+
+		guint64 start = now_ns();
+		for (uint i = 0; i < iterations; i++)
+		{
+			const GString *s = stat[i % 2];
+			ok &= vala_panel_proc_parse_stat_cores(s->str, s->len, &cpu, cores, n_cores) ==
+			      n_cores;
+			for (uint k = 0; k < n_cores; k++)
+			{
+				double busy = (cores[k].user - previous[k].user) +
+				              (cores[k].nice - previous[k].nice) +
+				              (cores[k].system - previous[k].system);
+				values[k]   = busy / (busy + (cores[k].idle - previous[k].idle));
+				previous[k] = cores[k];
+			}
+			graph_ring_render_column(&ring, surface, graph_ring_push(&ring, values));
+		}
+		double tick_us = (double)(now_ns() - start) / iterations / 1000.0;
+
+		printf("cores %4u  heatmap tick: %8.1f us\n", n_cores, tick_us);
+		if (n_cores == BUDGET_CORES && tick_us > TICK_BUDGET_US)
+		{
+			fprintf(stderr, "%u cores exceed budget of %.0f us\n", n_cores, TICK_BUDGET_US);
+			ok = false;
+		}
+
+		cairo_surface_destroy(surface);
+		graph_ring_clear(&ring);
+		g_free(values);
+		g_free(previous);
+		g_free(cores);
+		g_string_free(stat[0], true);
+		g_string_free(stat[1], true);
+	}
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,118 @@
+/*
+ * vala-panel
+ * Copyright (C) 2015-2016 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Per-tick cost of graph applets: full cairo redraw of the history, as
+ * monitors, cpu and netmon did before, against the ring raster behind
+ * ValaPanelGraph, which touches only the new column.
+ *
+ * Usage: bench-graph [ITERATIONS]
+ */
+
+#include <cairo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "graph-private.h"
+
+#define DEFAULT_ITERATIONS 2000
+#define HEIGHT 32
+
+static const uint widths[] = { 32, 64, 128, 256, 512, 1024, 2048 };
+
+static guint64 now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (guint64)ts.tv_sec * G_GUINT64_CONSTANT(1000000000) + (guint64)ts.tv_nsec;
+}
+
+static double sample(uint i)
+{
+	return (double)((i * 37) % 101) / 100.0;
+}
+
+/* Former monitor_redraw_pixmap() */
+static void legacy_redraw(cairo_surface_t *pixmap, const double *stats, uint cursor, uint width)
+{
+	cairo_t *cr = cairo_create(pixmap);
+	cairo_set_line_width(cr, 1.0);
+	cairo_set_source_rgba(cr, 0, 0, 0, 0);
+	cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+	cairo_paint(cr);
+	cairo_set_source_rgba(cr, 0.2, 0.6, 1.0, 1.0);
+	for (uint i = 0; i < width; i++)
+	{
+		uint drawing_cursor = (cursor + i) % width;
+		cairo_move_to(cr, i + 0.5, HEIGHT);
+		cairo_line_to(cr, i + 0.5, (1.0 - stats[drawing_cursor]) * HEIGHT);
+		cairo_stroke(cr);
+	}
+	cairo_destroy(cr);
+}
+
+int main(int argc, char **argv)
+{
+	uint iterations = argc > 1 ? (uint)strtoul(argv[1], NULL, 10) : DEFAULT_ITERATIONS;
+	if (iterations == 0)
+		iterations = DEFAULT_ITERATIONS;
+	for (uint w = 0; w < G_N_ELEMENTS(widths); w++)
+	{
+		uint width = widths[w];
+		guint64 start, legacy, graph;
+
+		cairo_surface_t *pixmap =
+		    cairo_image_surface_create(CAIRO_FORMAT_ARGB32, (int)width, HEIGHT);
+		double *stats = g_new0(double, width);
+		uint cursor   = 0;
+		start         = now_ns();
+		for (uint i = 0; i < iterations; i++)
+		{
+			stats[cursor] = sample(i);
+			cursor        = (cursor + 1) % width;
+			legacy_redraw(pixmap, stats, cursor, width);
+		}
+		legacy = now_ns() - start;
+		g_free(stats);
+		cairo_surface_destroy(pixmap);
+
+		GraphRing ring;
+		graph_ring_init(&ring, 1);
+		graph_ring_resize(&ring, width, HEIGHT);
+		ring.colors[0]           = 0xff3399ff;
+		cairo_surface_t *surface =
+		    cairo_image_surface_create(CAIRO_FORMAT_ARGB32, (int)width, HEIGHT);
+		graph_ring_render(&ring, surface);
+		start = now_ns();
+		for (uint i = 0; i < iterations; i++)
+		{
+			double value = sample(i);
+			graph_ring_render_column(&ring, surface, graph_ring_push(&ring, &value));
+		}
+		graph = now_ns() - start;
+		cairo_surface_destroy(surface);
+		graph_ring_clear(&ring);
+
+		printf("width %4u  redraw: %10.1f ns/tick  graph: %8.1f ns/tick\n",
+		       width,
+		       (double)legacy / iterations,
+		       (double)graph / iterations);
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,198 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays /proc/net/dev with up to 500 veth links and measures what netmon
+ * costs on every tick, against the number of links. Sampler parses the
+ * file once for all graphs, then interface filters pick links either for
+ * a sum of "veth*" or for a separate graph of every veth link.
+ *
+ * Lookup of every graph's link by name on every tick, which netmon did
+ * before filters, is measured for comparison.
+ *
+ * Usage: bench-netmon FIXTURES_DIR [ITERATIONS]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "procfs.h"
+
+#define DEFAULT_ITERATIONS 2000
+#define HEADER_LINES 5 /* Two lines of header, then lo, enp3s0 and wg0 */
+#define MAX_NET 512
+#define PATTERN "veth*"
+
+static const uint link_counts[] = { 1, 10, 100, 500 };
+
+static guint64 now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (guint64)ts.tv_sec * G_GUINT64_CONSTANT(1000000000) + (guint64)ts.tv_nsec;
+}
+
+/* Length of the first lines of buf, which are a valid /proc/net/dev themselves */
+static size_t lines_length(const char *buf, size_t len, uint lines)
+{
+	const char *p = buf;
+	for (uint i = 0; i < lines && p != NULL; i++)
+	{
+		p = memchr(p, '\n', len - (size_t)(p - buf));
+		p = p != NULL ? p + 1 : NULL;
+	}
+	return p != NULL ? (size_t)(p - buf) : len;
+}
+
+/* What netmon does on a tick for one graph: sum counters of links the filter picked */
+static guint64 filter_sum(ValaPanelSampleFilter *filter, const ValaPanelNetSample *net,
+                          uint n_net, guint digest, bool *changed)
+{
+	guint64 sum = 0;
+	*changed |= vala_panel_sample_filter_update_net(filter, net, n_net, digest);
+	for (uint i = 0; i < filter->positions->len; i++)
+	{
+		const ValaPanelNetSample *sample = &net[g_array_index(filter->positions, uint, i)];
+		sum += sample->rx_bytes + sample->tx_bytes;
+	}
+	return sum;
+}
+
+static guint64 lookup_sum(const char *name, const ValaPanelNetSample *net, uint n_net)
+{
+	for (uint i = 0; i < n_net; i++)
+		if (!strcmp(net[i].name, name))
+			return net[i].rx_bytes + net[i].tx_bytes;
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s FIXTURES_DIR [ITERATIONS]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	uint iterations = argc > 2 ? (uint)strtoul(argv[2], NULL, 10) : DEFAULT_ITERATIONS;
+	if (iterations == 0)
+		iterations = DEFAULT_ITERATIONS;
+	g_autofree char *path = g_build_filename(argv[1], "net-dev-veth", NULL);
+	ValaPanelProcFile file;
+	if (!vala_panel_proc_file_open(&file, path, 4096, true) ||
+	    !vala_panel_proc_file_read(&file))
+	{
+		fprintf(stderr, "Cannot read fixture %s\n", path);
+		return EXIT_FAILURE;
+	}
+
+	ValaPanelNetSample *net = g_new0(ValaPanelNetSample, MAX_NET);
+	bool ok                 = true;
+	printf("%-6s %14s %14s %14s %14s\n", "links", "parse+hash", "sum", "per-link", "lookup");
+	for (uint c = 0; c < G_N_ELEMENTS(link_counts); c++)
+	{
+		uint links = link_counts[c];
+		size_t len = lines_length(file.buf, file.len, HEADER_LINES + links);
+		uint n_net = vala_panel_proc_parse_net_dev(file.buf, len, net, MAX_NET);
+		ok &= n_net == HEADER_LINES - 2 + links;
+
+		/* Graphs as netmon makes them: one for the pattern, or one per matching link */
+		ValaPanelSampleFilter total, matching;
+		ValaPanelSampleFilter *graphs = g_new0(ValaPanelSampleFilter, links);
+		vala_panel_sample_filter_init(&total, PATTERN);
+		vala_panel_sample_filter_init(&matching, PATTERN);
+		guint digest = vala_panel_net_digest(net, n_net);
+		bool changed = false;
+		vala_panel_sample_filter_update_net(&matching, net, n_net, digest);
+		ok &= matching.positions->len == links;
+		for (uint i = 0; i < links; i++)
+		{
+			uint pos = g_array_index(matching.positions, uint, i);
+			vala_panel_sample_filter_init(&graphs[i], net[pos].name);
+		}
+		/* First tick finds the links, later ones must not search again */
+		filter_sum(&total, net, n_net, digest, &changed);
+		for (uint i = 0; i < links; i++)
+			filter_sum(&graphs[i], net, n_net, digest, &changed);
+		changed = false;
+
+		guint64 start, parse, sum, per_link, lookup;
+		guint64 check_sum = 0, check_links = 0, check_lookup = 0;
+		start = now_ns();
+		for (uint i = 0; i < iterations; i++)
+		{
+			n_net  = vala_panel_proc_parse_net_dev(file.buf, len, net, MAX_NET);
+			digest = vala_panel_net_digest(net, n_net);
+		}
+		parse = now_ns() - start;
+		start = now_ns();
+		for (uint i = 0; i < iterations; i++)
+			check_sum = filter_sum(&total, net, n_net, digest, &changed);
+		sum   = now_ns() - start;
+		start = now_ns();
+		for (uint i = 0; i < iterations; i++)
+		{
+			check_links = 0;
+			filter_sum(&matching, net, n_net, digest, &changed);
+			for (uint g = 0; g < links; g++)
+				check_links += filter_sum(&graphs[g], net, n_net, digest, &changed);
+		}
+		per_link = now_ns() - start;
+		start    = now_ns();
+		for (uint i = 0; i < iterations; i++)
+		{
+			check_lookup = 0;
+			for (uint g = 0; g < links; g++)
+				check_lookup += lookup_sum(graphs[g].name, net, n_net);
+		}
+		lookup = now_ns() - start;
+		printf("%-6u %11.1f ns %11.1f ns %11.1f ns %11.1f ns\n",
+		       links,
+		       (double)parse / iterations,
+		       (double)sum / iterations,
+		       (double)per_link / iterations,
+		       (double)lookup / iterations);
+
+		/* Same counters, whichever way they are picked, and no rescans in steady state */
+		ok &= check_sum == check_links && check_links == check_lookup && !changed;
+		/* Renaming a link must reach the sum and its own graph, but no other graph */
+		g_strlcpy(net[n_net - 1].name, "renamed", VALA_PANEL_SAMPLE_IFNAME_SIZE);
+		digest  = vala_panel_net_digest(net, n_net);
+		changed = false;
+		filter_sum(&total, net, n_net, digest, &changed);
+		ok &= changed && total.positions->len == links - 1;
+		for (uint g = 0; g < links; g++)
+		{
+			changed = false;
+			filter_sum(&graphs[g], net, n_net, digest, &changed);
+			ok &= changed == (g == links - 1);
+		}
+
+		for (uint g = 0; g < links; g++)
+			vala_panel_sample_filter_clear(&graphs[g]);
+		g_free(graphs);
+		vala_panel_sample_filter_clear(&total);
+		vala_panel_sample_filter_clear(&matching);
+	}
+	g_free(net);
+	vala_panel_proc_file_close(&file);
+	if (!ok)
+		fprintf(stderr, "Interface filters disagree with lookup on %s\n", path);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,178 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays a sysfs tree with powercap and power_supply files and compares
+ * what a tick of the power monitor costs when every file is opened, read
+ * and closed again, as battery applets do, with pread() on descriptors
+ * which util/power.c keeps open. Wrapping of energy counters is checked
+ * on a scratch copy of one RAPL zone.
+ *
+ * Usage: bench-power FIXTURES_DIR [ITERATIONS]
+ */
+
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "power.h"
+
+#define DEFAULT_ITERATIONS 20000
+#define FIXTURE_WATTS 26.5 /* BAT0 power_now, plus current_now * voltage_now of BAT1 */
+#define RAPL_FORMAT "%s/class/powercap/intel-rapl:0/%s"
+#define SUPPLY_FORMAT "%s/class/power_supply/%s/%s"
+#define WRAP_RANGE 1000000
+
+static const char *const legacy_files[][2] = {
+	{ "BAT0", "status" },      { "BAT0", "power_now" }, { "BAT1", "status" },
+	{ "BAT1", "current_now" }, { "BAT1", "voltage_now" },
+};
+
+static guint64 now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (guint64)ts.tv_sec * G_GUINT64_CONSTANT(1000000000) + (guint64)ts.tv_nsec;
+}
+
+/* Legacy reader: whole file into a fresh string on every tick */
+static gint64 legacy_read(const char *path)
+{
+	g_autofree char *contents = NULL;
+	if (!g_file_get_contents(path, &contents, NULL, NULL))
+		return 0;
+	return g_ascii_strtoll(contents, NULL, 10);
+}
+
+/* Same files as vala_panel_power_open() finds in the fixture */
+static GPtrArray *legacy_paths(const char *root)
+{
+	GPtrArray *paths = g_ptr_array_new_with_free_func(g_free);
+	g_ptr_array_add(paths, g_strdup_printf(RAPL_FORMAT, root, "energy_uj"));
+	for (uint i = 0; i < G_N_ELEMENTS(legacy_files); i++)
+		g_ptr_array_add(paths,
+		                g_strdup_printf(SUPPLY_FORMAT,
+		                                root,
+		                                legacy_files[i][0],
+		                                legacy_files[i][1]));
+	return paths;
+}
+
+/* Rewrites in place, as sysfs keeps the inode which open descriptors point to */
+static bool write_energy(const char *path, guint64 energy)
+{
+	FILE *file = fopen(path, "w");
+	if (file == NULL)
+		return false;
+	fprintf(file, "%" G_GUINT64_FORMAT "\n", energy);
+	return fclose(file) == 0;
+}
+
+/* Counter goes past its range once, and the total must not jump back */
+static bool check_wrap(void)
+{
+	g_autofree char *root = g_dir_make_tmp("bench-power-XXXXXX", NULL);
+	if (root == NULL)
+		return false;
+	g_autofree char *zone   = g_build_filename(root, "class", "powercap", "intel-rapl:0", NULL);
+	g_autofree char *name   = g_build_filename(zone, "name", NULL);
+	g_autofree char *range  = g_build_filename(zone, "max_energy_range_uj", NULL);
+	g_autofree char *energy = g_build_filename(zone, "energy_uj", NULL);
+	g_autofree char *range_txt = g_strdup_printf("%d\n", WRAP_RANGE);
+	ValaPanelPower power       = { 0 };
+	ValaPanelPowerSample first, second;
+	bool ok = g_mkdir_with_parents(zone, 0700) == 0 &&
+	          g_file_set_contents(name, "package-0\n", -1, NULL) &&
+	          g_file_set_contents(range, range_txt, -1, NULL) &&
+	          write_energy(energy, WRAP_RANGE - 300) && vala_panel_power_open(&power, root);
+	if (ok)
+	{
+		vala_panel_power_read(&power, &first);
+		ok = write_energy(energy, 200);
+		vala_panel_power_read(&power, &second);
+		ok = ok && first.has_energy && second.energy_uj - first.energy_uj == 500;
+		vala_panel_power_close(&power);
+	}
+	g_unlink(energy);
+	g_unlink(range);
+	g_unlink(name);
+	g_rmdir(zone);
+	g_autofree char *powercap = g_path_get_dirname(zone);
+	g_autofree char *class    = g_path_get_dirname(powercap);
+	g_rmdir(powercap);
+	g_rmdir(class);
+	g_rmdir(root);
+	return ok;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s FIXTURES_DIR [ITERATIONS]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	uint iterations = argc > 2 ? (uint)strtoul(argv[2], NULL, 10) : DEFAULT_ITERATIONS;
+	if (iterations == 0)
+		iterations = DEFAULT_ITERATIONS;
+	g_autofree char *root       = g_build_filename(argv[1], "sys", NULL);
+	ValaPanelPower power        = { 0 };
+	ValaPanelPowerSample sample = { 0 };
+	g_autoptr(GPtrArray) paths  = legacy_paths(root);
+	gint64 sink                 = 0;
+	if (!vala_panel_power_open(&power, root))
+	{
+		fprintf(stderr, "No power sources in fixture %s\n", root);
+		return EXIT_FAILURE;
+	}
+	/* Core subzone, psys and mmio zones, and the mouse battery are left out */
+	bool ok = power.n_zones == 1 && power.n_batteries == 2;
+	guint64 start, legacy, pread_time;
+
+	start = now_ns();
+	for (uint i = 0; i < iterations; i++)
+		for (uint p = 0; p < paths->len; p++)
+			sink += legacy_read(g_ptr_array_index(paths, p));
+	legacy = now_ns() - start;
+
+	start = now_ns();
+	for (uint i = 0; i < iterations; i++)
+		vala_panel_power_read(&power, &sample);
+	pread_time = now_ns() - start;
+
+	printf("%-10s %11.1f ns\n", "open+read", (double)legacy / iterations);
+	printf("%-10s %11.1f ns\n", "pread", (double)pread_time / iterations);
+	/* Counters stand still in the fixture */
+	ok &= sink != 0 && sample.has_energy && sample.energy_uj == 0;
+	ok &= sample.has_battery && sample.on_battery;
+	ok &= ABS(sample.battery_watts - FIXTURE_WATTS) < 1e-9;
+	vala_panel_power_close(&power);
+	if (!ok)
+	{
+		fprintf(stderr, "Unexpected power sample from fixture %s\n", root);
+		return EXIT_FAILURE;
+	}
+	if (!check_wrap())
+	{
+		fprintf(stderr, "Energy counter wrap was not followed\n");
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,406 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays recorded /proc files and compares stdio parsing, which monitor
+ * applets used before, with util/procfs.c.
+ *
+ * Pressure fixtures also check that PSI triggers are only ever written to
+ * procfs: a fixture file can never become ready for POLLPRI, so sampler
+ * falls back to polling it on ticks.
+ *
+ * Usage: bench-procfs FIXTURES_DIR [ITERATIONS]
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "procfs.h"
+
+#define DEFAULT_ITERATIONS 100000
+#define MAX_NET 64
+#define MAX_DISKS 64
+
+/*
+ * Legacy readers, as they were in applets/core
+ */
+
+/* Widened to all ten fields, so that both parsers fill the same sample */
+static bool legacy_stat(const char *path, ValaPanelCpuSample *cpu)
+{
+	unsigned long long f[10] = { 0 };
+	FILE *stat               = fopen(path, "r");
+	if (stat == NULL)
+		return false;
+	int fscanf_result = fscanf(stat,
+	                           "cpu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
+	                           &f[0],
+	                           &f[1],
+	                           &f[2],
+	                           &f[3],
+	                           &f[4],
+	                           &f[5],
+	                           &f[6],
+	                           &f[7],
+	                           &f[8],
+	                           &f[9]);
+	fclose(stat);
+	cpu->user       = f[0];
+	cpu->nice       = f[1];
+	cpu->system     = f[2];
+	cpu->idle       = f[3];
+	cpu->iowait     = f[4];
+	cpu->irq        = f[5];
+	cpu->softirq    = f[6];
+	cpu->steal      = f[7];
+	cpu->guest      = f[8];
+	cpu->guest_nice = f[9];
+	return fscanf_result >= 4;
+}
+
+static bool legacy_meminfo(const char *path, ValaPanelMemSample *mem)
+{
+	char buf[80];
+	unsigned long value;
+	uint readmask = 0x10 | 0x8 | 0x4 | 0x2 | 0x1;
+	FILE *meminfo = fopen(path, "r");
+	if (meminfo == NULL)
+		return false;
+	while (readmask != 0 && fgets(buf, 80, meminfo) != NULL)
+	{
+		if (sscanf(buf, "MemTotal: %lu kB\n", &value) == 1)
+		{
+			mem->mem_total = value;
+			readmask &= ~0x1;
+		}
+		else if (sscanf(buf, "MemAvailable: %lu kB\n", &value) == 1)
+		{
+			mem->mem_available = value;
+			readmask &= ~0x2;
+		}
+		else if (sscanf(buf, "SwapCached: %lu kB\n", &value) == 1)
+		{
+			mem->swap_cached = value;
+			readmask &= ~0x4;
+		}
+		else if (sscanf(buf, "SwapTotal: %lu kB\n", &value) == 1)
+		{
+			mem->swap_total = value;
+			readmask &= ~0x8;
+		}
+		else if (sscanf(buf, "SwapFree: %lu kB\n", &value) == 1)
+		{
+			mem->swap_free = value;
+			readmask &= ~0x10;
+		}
+	}
+	fclose(meminfo);
+	return readmask == 0;
+}
+
+static uint legacy_net_dev(const char *path, ValaPanelNetSample *net, uint n_net)
+{
+	char buf[256];
+	uint count = 0;
+	FILE *fp   = fopen(path, "r");
+	if (fp == NULL)
+		return 0;
+	/* Ignore first two lines - header */
+	if (fgets(buf, 255, fp) == NULL || fgets(buf, 255, fp) == NULL)
+	{
+		fclose(fp);
+		return 0;
+	}
+	while (fgets(buf, 255, fp) != NULL)
+	{
+		char *p = buf;
+		while (isspace((int)*p))
+			p++;
+		char *curdev = p;
+		while (*p && *p != ':')
+			p++;
+		if (*p == '\0')
+			continue;
+		*p = '\0';
+
+		unsigned long long down, up;
+		if (sscanf(p + 1, "%llu %*u %*u %*u %*u %*u %*u %*u %llu", &down, &up) != 2)
+			continue;
+		if (count < n_net)
+		{
+			g_strlcpy(net[count].name, curdev, VALA_PANEL_SAMPLE_IFNAME_SIZE);
+			net[count].rx_bytes = down;
+			net[count].tx_bytes = up;
+		}
+		count++;
+	}
+	fclose(fp);
+	return count;
+}
+
+/* How a stdio reader of the same fields would look, for comparison */
+static uint legacy_diskstats(const char *path, ValaPanelDiskSample *disks, uint n_disks)
+{
+	char buf[256];
+	char name[VALA_PANEL_SAMPLE_DISKNAME_SIZE];
+	uint count = 0;
+	FILE *fp   = fopen(path, "r");
+	if (fp == NULL)
+		return 0;
+	while (fgets(buf, 256, fp) != NULL)
+	{
+		unsigned major, minor;
+		unsigned long long f[11];
+		if (sscanf(buf,
+		           "%u %u %31s %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
+		           &major,
+		           &minor,
+		           name,
+		           &f[0],
+		           &f[1],
+		           &f[2],
+		           &f[3],
+		           &f[4],
+		           &f[5],
+		           &f[6],
+		           &f[7],
+		           &f[8],
+		           &f[9],
+		           &f[10]) != 14)
+			continue;
+		if (count < n_disks)
+		{
+			ValaPanelDiskSample *disk = &disks[count];
+			g_strlcpy(disk->name, name, VALA_PANEL_SAMPLE_DISKNAME_SIZE);
+			disk->reads           = f[0];
+			disk->sectors_read    = f[2];
+			disk->writes          = f[4];
+			disk->sectors_written = f[6];
+			disk->io_ticks        = f[9];
+			disk->time_in_queue   = f[10];
+			disk->dev             = major << 20 | minor;
+		}
+		count++;
+	}
+	fclose(fp);
+	return count;
+}
+
+static bool legacy_pressure(const char *path, ValaPanelPsiSample *psi)
+{
+	char buf[128];
+	unsigned long long total;
+	bool has_some   = false;
+	psi->full_total = 0;
+	FILE *fp        = fopen(path, "r");
+	if (fp == NULL)
+		return false;
+	while (fgets(buf, 128, fp) != NULL)
+	{
+		if (sscanf(buf, "some avg10=%*f avg60=%*f avg300=%*f total=%llu", &total) == 1)
+		{
+			psi->some_total = total;
+			has_some        = true;
+		}
+		else if (sscanf(buf, "full avg10=%*f avg60=%*f avg300=%*f total=%llu", &total) == 1)
+			psi->full_total = total;
+	}
+	fclose(fp);
+	return has_some;
+}
+
+/*
+ * Harness
+ */
+
+static guint64 now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (guint64)ts.tv_sec * G_GUINT64_CONSTANT(1000000000) + (guint64)ts.tv_nsec;
+}
+
+static void report(const char *name, guint64 legacy, guint64 procfs, uint iterations)
+{
+	double legacy_ns = (double)legacy / iterations;
+	double procfs_ns = (double)procfs / iterations;
+	printf("%-10s scanf: %9.1f ns/parse  procfs: %9.1f ns/parse  speedup: %5.2fx\n",
+	       name,
+	       legacy_ns,
+	       procfs_ns,
+	       legacy_ns / procfs_ns);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s FIXTURES_DIR [ITERATIONS]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	uint iterations = argc > 2 ? (uint)strtoul(argv[2], NULL, 10) : DEFAULT_ITERATIONS;
+	if (iterations == 0)
+		iterations = DEFAULT_ITERATIONS;
+	g_autofree char *stat_path    = g_build_filename(argv[1], "stat", NULL);
+	g_autofree char *meminfo_path = g_build_filename(argv[1], "meminfo", NULL);
+	g_autofree char *net_dev_path   = g_build_filename(argv[1], "net-dev", NULL);
+	g_autofree char *diskstats_path = g_build_filename(argv[1], "diskstats", NULL);
+
+	ValaPanelProcFile stat, meminfo, net_dev, diskstats;
+	if (!vala_panel_proc_file_open(&stat, stat_path, 65536, true) ||
+	    !vala_panel_proc_file_open(&meminfo, meminfo_path, 4096, true) ||
+	    !vala_panel_proc_file_open(&net_dev, net_dev_path, 4096, true) ||
+	    !vala_panel_proc_file_open(&diskstats, diskstats_path, 8192, true))
+	{
+		fprintf(stderr, "Cannot open fixtures in %s\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	ValaPanelCpuSample cpu_a = { 0 }, cpu_b = { 0 };
+	ValaPanelMemSample mem_a = { 0 }, mem_b = { 0 };
+	ValaPanelNetSample net_a[MAX_NET], net_b[MAX_NET];
+	uint n_a = 0, n_b = 0;
+	bool ok  = true;
+	guint64 start, legacy, procfs;
+
+	start = now_ns();
+	for (uint i = 0; i < iterations; i++)
+		ok &= legacy_stat(stat_path, &cpu_a);
+	legacy = now_ns() - start;
+	start  = now_ns();
+	for (uint i = 0; i < iterations; i++)
+		ok &= vala_panel_proc_file_read(&stat) &&
+		      vala_panel_proc_parse_stat(stat.buf, stat.len, &cpu_b);
+	procfs = now_ns() - start;
+	report("stat", legacy, procfs, iterations);
+
+	start = now_ns();
+	for (uint i = 0; i < iterations; i++)
+		ok &= legacy_meminfo(meminfo_path, &mem_a);
+	legacy = now_ns() - start;
+	start  = now_ns();
+	for (uint i = 0; i < iterations; i++)
+		ok &= vala_panel_proc_file_read(&meminfo) &&
+		      vala_panel_proc_parse_meminfo(meminfo.buf, meminfo.len, &mem_b);
+	procfs = now_ns() - start;
+	report("meminfo", legacy, procfs, iterations);
+
+	start = now_ns();
+	for (uint i = 0; i < iterations; i++)
+		n_a = legacy_net_dev(net_dev_path, net_a, MAX_NET);
+	legacy = now_ns() - start;
+	start  = now_ns();
+	for (uint i = 0; i < iterations; i++)
+	{
+		ok &= vala_panel_proc_file_read(&net_dev);
+		n_b = vala_panel_proc_parse_net_dev(net_dev.buf, net_dev.len, net_b, MAX_NET);
+	}
+	procfs = now_ns() - start;
+	report("net/dev", legacy, procfs, iterations);
+
+	ValaPanelDiskSample disks_a[MAX_DISKS] = { 0 }, disks_b[MAX_DISKS] = { 0 };
+	uint n_disks_a = 0, n_disks_b = 0;
+	start = now_ns();
+	for (uint i = 0; i < iterations; i++)
+		n_disks_a = legacy_diskstats(diskstats_path, disks_a, MAX_DISKS);
+	legacy = now_ns() - start;
+	start  = now_ns();
+	for (uint i = 0; i < iterations; i++)
+	{
+		ok &= vala_panel_proc_file_read(&diskstats);
+		n_disks_b = vala_panel_proc_parse_diskstats(diskstats.buf,
+		                                            diskstats.len,
+		                                            disks_b,
+		                                            MAX_DISKS);
+	}
+	procfs = now_ns() - start;
+	report("diskstats", legacy, procfs, iterations);
+
+	static const char *resources[VALA_PANEL_PSI_N_RESOURCES] = { "cpu", "memory", "io" };
+	ValaPanelPsiSample psi_a[VALA_PANEL_PSI_N_RESOURCES] = { 0 };
+	ValaPanelPsiSample psi_b[VALA_PANEL_PSI_N_RESOURCES] = { 0 };
+	ValaPanelProcFile pressure[VALA_PANEL_PSI_N_RESOURCES];
+	char *pressure_paths[VALA_PANEL_PSI_N_RESOURCES];
+	for (uint r = 0; r < VALA_PANEL_PSI_N_RESOURCES; r++)
+	{
+		pressure_paths[r] = g_build_filename(argv[1], "pressure", resources[r], NULL);
+		ok &= !vala_panel_proc_file_open_trigger(&pressure[r],
+		                                         pressure_paths[r],
+		                                         256,
+		                                         "some 200000 2000000");
+		ok &= vala_panel_proc_file_open(&pressure[r], pressure_paths[r], 256, false);
+	}
+	start = now_ns();
+	for (uint i = 0; i < iterations; i++)
+		for (uint r = 0; r < VALA_PANEL_PSI_N_RESOURCES; r++)
+			ok &= legacy_pressure(pressure_paths[r], &psi_a[r]);
+	legacy = now_ns() - start;
+	start  = now_ns();
+	for (uint i = 0; i < iterations; i++)
+		for (uint r = 0; r < VALA_PANEL_PSI_N_RESOURCES; r++)
+			ok &= vala_panel_proc_file_read(&pressure[r]) &&
+			      vala_panel_proc_parse_pressure(pressure[r].buf,
+			                                     pressure[r].len,
+			                                     &psi_b[r]);
+	procfs = now_ns() - start;
+	report("pressure", legacy, procfs, iterations);
+	for (uint r = 0; r < VALA_PANEL_PSI_N_RESOURCES; r++)
+	{
+		/* Refused trigger must not have touched the fixture */
+		ok &= pressure[r].len > 0 && g_str_has_prefix(pressure[r].buf, "some avg10=");
+		vala_panel_proc_file_close(&pressure[r]);
+		g_free(pressure_paths[r]);
+	}
+	ok &= !memcmp(psi_a, psi_b, sizeof(psi_a));
+
+	/* Report whether real triggers can be armed here, it is not an error if not */
+	ValaPanelProcFile trigger;
+	if (access("/proc/pressure/cpu", R_OK) == 0)
+	{
+		bool armed = vala_panel_proc_file_open_trigger(&trigger,
+		                                               "/proc/pressure/cpu",
+		                                               256,
+		                                               "some 200000 2000000");
+		printf("%-10s trigger on /proc/pressure/cpu: %s\n",
+		       "pressure",
+		       armed ? "armed" : "not permitted, polling");
+		if (armed)
+			vala_panel_proc_file_close(&trigger);
+	}
+
+	vala_panel_proc_file_close(&stat);
+	vala_panel_proc_file_close(&meminfo);
+	vala_panel_proc_file_close(&net_dev);
+	vala_panel_proc_file_close(&diskstats);
+
+	/* Both parsers must agree, otherwise numbers above mean nothing */
+	ok &= !memcmp(&cpu_a, &cpu_b, sizeof(cpu_a)) && !memcmp(&mem_a, &mem_b, sizeof(mem_a));
+	ok &= n_a == n_b && n_a > 0;
+	for (uint i = 0; ok && i < MIN(n_a, MAX_NET); i++)
+		ok &= !g_strcmp0(net_a[i].name, net_b[i].name) &&
+		      net_a[i].rx_bytes == net_b[i].rx_bytes && net_a[i].tx_bytes == net_b[i].tx_bytes;
+	ok &= n_disks_a == n_disks_b && n_disks_a > 0;
+	ok &= !memcmp(disks_a, disks_b, sizeof(ValaPanelDiskSample) * MIN(n_disks_a, MAX_DISKS));
+	if (!ok)
+		fprintf(stderr, "Parsers disagree on fixtures in %s\n", argv[1]);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,267 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Real cost of fast sampling. A second of the graph applets with default
+ * settings (monitors with CPU, RAM and swap, cpu and netmon) is replayed
+ * with one sample, as before, and with ten samples and envelopes. Every
+ * sample rereads and parses the files, computes values, updates history
+ * files and rasterizes the newest column, like the sampler and
+ * ValaPanelGraph do. Painting the widgets on screen is not included.
+ *
+ * Files come from /proc when it is there, otherwise from FIXTURES_DIR.
+ * Fails if fast sampling takes more than FAST_BUDGET percent of one CPU.
+ *
+ * Usage: bench-sampling FIXTURES_DIR [SECONDS]
+ */
+
+#include <cairo.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "graph-private.h"
+#include "procfs.h"
+
+#define DEFAULT_SECONDS 300
+#define FAST_SAMPLES 10 /* Per second */
+#define FAST_BUDGET 1.0 /* Percent of one CPU */
+#define MAX_NET 64
+#define WIDTH 40
+#define HEIGHT 32
+#define NET_MIN_FULL_SCALE 10000 /* Bytes per second, as in netmon */
+
+enum
+{
+	CPU_APPLET,
+	CPU_MONITOR,
+	RAM_MONITOR,
+	SWAP_MONITOR,
+	NETMON,
+	N_GRAPHS
+};
+
+static const char *graph_names[N_GRAPHS] = { "cpu", "monitors-cpu", "mem", "swap", "net" };
+
+typedef struct
+{
+	GraphRing ring;
+	cairo_surface_t *surface;
+	ValaPanelHistory *history;
+} BenchGraph;
+
+typedef struct
+{
+	ValaPanelProcFile stat;
+	ValaPanelProcFile meminfo;
+	ValaPanelProcFile net_dev;
+	ValaPanelCpuSample previous_cpu;
+	ValaPanelNetSample net[MAX_NET];
+	guint64 previous_rx, previous_tx;
+	BenchGraph graphs[N_GRAPHS];
+} Bench;
+
+static guint64 cpu_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return (guint64)ts.tv_sec * G_GUINT64_CONSTANT(1000000000) + (guint64)ts.tv_nsec;
+}
+
+static void bench_graph_init(BenchGraph *g, const char *name, uint n_series, bool stacked)
+{
+	graph_ring_init(&g->ring, n_series);
+	graph_ring_resize(&g->ring, WIDTH, HEIGHT);
+	g->ring.style = stacked ? VALA_PANEL_GRAPH_STACKED : VALA_PANEL_GRAPH_BARS;
+	for (uint s = 0; s < n_series; s++)
+		g->ring.colors[s] = 0xff000000 | (0x3399ff >> s);
+	g->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, WIDTH, HEIGHT);
+	g->history = vala_panel_history_open(name, n_series);
+}
+
+static void bench_graph_clear(BenchGraph *g)
+{
+	g_clear_pointer(&g->history, vala_panel_history_close);
+	cairo_surface_destroy(g->surface);
+	graph_ring_clear(&g->ring);
+}
+
+/* Same steps as vala_panel_graph_push_at() with history, for one sample */
+static void bench_graph_push(BenchGraph *g, const double *values, gint64 second, bool merge)
+{
+	graph_ring_accumulate(&g->ring, values, merge);
+	if (g->history != NULL)
+		vala_panel_history_push(g->history, second, values);
+	GraphRing *ring = &g->ring;
+	uint column     = merge ? graph_ring_replace(ring, values) : graph_ring_push(ring, values);
+	if (merge)
+		graph_ring_store_accumulated(ring, column);
+	graph_ring_render_column(ring, g->surface, column);
+	if (graph_ring_rescale(ring))
+		graph_ring_render(ring, g->surface);
+}
+
+static bool bench_sample(Bench *b, gint64 second, bool merge)
+{
+	ValaPanelCpuSample cpu;
+	ValaPanelMemSample mem;
+	double states[VALA_PANEL_CPU_N_STATES];
+	bool ok = vala_panel_proc_file_read(&b->stat) &&
+	          vala_panel_proc_parse_stat(b->stat.buf, b->stat.len, &cpu) &&
+	          vala_panel_proc_file_read(&b->meminfo) &&
+	          vala_panel_proc_parse_meminfo(b->meminfo.buf, b->meminfo.len, &mem) &&
+	          vala_panel_proc_file_read(&b->net_dev);
+	if (!ok)
+		return false;
+	uint n_net = vala_panel_proc_parse_net_dev(b->net_dev.buf, b->net_dev.len, b->net, MAX_NET);
+
+	vala_panel_cpu_sample_load(&cpu, &b->previous_cpu, states);
+	b->previous_cpu = cpu;
+	bench_graph_push(&b->graphs[CPU_APPLET], states, second, merge);
+	bench_graph_push(&b->graphs[CPU_MONITOR], states, second, merge);
+
+	double ram  = (double)(mem.mem_total - mem.mem_available) / MAX(mem.mem_total, 1);
+	double swap = (double)(mem.swap_total - mem.swap_free) / MAX(mem.swap_total, 1);
+	bench_graph_push(&b->graphs[RAM_MONITOR], &ram, second, merge);
+	bench_graph_push(&b->graphs[SWAP_MONITOR], &swap, second, merge);
+
+	guint64 rx = 0, tx = 0;
+	for (uint i = 0; i < MIN(n_net, MAX_NET); i++)
+	{
+		rx += b->net[i].rx_bytes;
+		tx += b->net[i].tx_bytes;
+	}
+	double rates[] = {
+		(double)(rx - b->previous_rx),
+		(double)(tx - b->previous_tx),
+	};
+	b->previous_rx = rx;
+	b->previous_tx = tx;
+	bench_graph_push(&b->graphs[NETMON], rates, second, merge);
+	return true;
+}
+
+/* Returns CPU time of one replayed second, in nanoseconds */
+static double bench_run(Bench *b, uint seconds, uint samples, bool *ok)
+{
+	gint64 base   = g_get_real_time() / G_USEC_PER_SEC;
+	guint64 start = cpu_ns();
+	for (uint s = 0; s < seconds; s++)
+		for (uint k = 0; k < samples; k++)
+			*ok &= bench_sample(b, base + s, k > 0);
+	return (double)(cpu_ns() - start) / seconds;
+}
+
+static bool bench_open(Bench *b, const char *dir, const char *stat, const char *meminfo,
+                       const char *net_dev)
+{
+	g_autofree char *stat_path    = g_build_filename(dir, stat, NULL);
+	g_autofree char *meminfo_path = g_build_filename(dir, meminfo, NULL);
+	g_autofree char *net_dev_path = g_build_filename(dir, net_dev, NULL);
+	return vala_panel_proc_file_open(&b->stat, stat_path, 65536, true) &&
+	       vala_panel_proc_file_open(&b->meminfo, meminfo_path, 4096, true) &&
+	       vala_panel_proc_file_open(&b->net_dev, net_dev_path, 4096, true);
+}
+
+static void report(const char *name, double ns)
+{
+	printf("%-6s %9.1f us per second, %6.3f%% of one CPU\n", name, ns / 1000.0, ns / 1e7);
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s FIXTURES_DIR [SECONDS]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	uint seconds = argc > 2 ? (uint)strtoul(argv[2], NULL, 10) : DEFAULT_SECONDS;
+	bool ok      = true;
+	Bench b      = { .stat.fd = -1, .meminfo.fd = -1, .net_dev.fd = -1 };
+	if (seconds == 0)
+		seconds = DEFAULT_SECONDS;
+
+	bool real = bench_open(&b, "/proc", "stat", "meminfo", "net/dev");
+	if (!real)
+	{
+		vala_panel_proc_file_close(&b.stat);
+		vala_panel_proc_file_close(&b.meminfo);
+		vala_panel_proc_file_close(&b.net_dev);
+		if (!bench_open(&b, argv[1], "stat", "meminfo", "net-dev"))
+		{
+			fprintf(stderr, "Cannot open fixtures in %s\n", argv[1]);
+			return EXIT_FAILURE;
+		}
+	}
+	printf("Reading %s\n", real ? "/proc" : argv[1]);
+
+	/* History files go to a scratch cache, not to the one of a running panel */
+	g_autofree char *cache = g_dir_make_tmp("bench-sampling-XXXXXX", NULL);
+	if (cache != NULL)
+		g_setenv("XDG_CACHE_HOME", cache, true);
+	for (uint i = 0; i < N_GRAPHS; i++)
+	{
+		uint n_series = i <= CPU_MONITOR ? VALA_PANEL_CPU_N_STATES : i == NETMON ? 2 : 1;
+		bench_graph_init(&b.graphs[i], graph_names[i], n_series, i <= CPU_MONITOR);
+	}
+	graph_ring_set_autoscale(&b.graphs[NETMON].ring, NET_MIN_FULL_SCALE);
+
+	/* Prime deltas and page in history files, like the first tick of a panel */
+	bench_run(&b, 1, 1, &ok);
+	double slow = bench_run(&b, seconds, 1, &ok);
+	for (uint i = 0; i < N_GRAPHS; i++)
+		graph_ring_set_envelope(&b.graphs[i].ring, true);
+	double fast = bench_run(&b, seconds, FAST_SAMPLES, &ok);
+
+	report("1 Hz", slow);
+	report("10 Hz", fast);
+	printf("%-6s %+9.1f us per second, %+6.3f%% of one CPU\n",
+	       "added",
+	       (fast - slow) / 1000.0,
+	       (fast - slow) / 1e7);
+	if (!ok)
+		fprintf(stderr, "Could not read samples\n");
+	if (fast / 1e7 > FAST_BUDGET)
+	{
+		fprintf(stderr, "Fast sampling exceeds budget of %.1f%% of one CPU\n", FAST_BUDGET);
+		ok = false;
+	}
+
+	for (uint i = 0; i < N_GRAPHS; i++)
+		bench_graph_clear(&b.graphs[i]);
+	if (cache != NULL)
+	{
+		g_autofree char *history = g_build_filename(cache, "vala-panel", "history", NULL);
+		g_autofree char *parent  = g_path_get_dirname(history);
+		for (uint i = 0; i < N_GRAPHS; i++)
+		{
+			g_autofree char *file = g_strconcat(graph_names[i], ".hist", NULL);
+			g_autofree char *path = g_build_filename(history, file, NULL);
+			g_unlink(path);
+		}
+		g_rmdir(history);
+		g_rmdir(parent);
+		g_rmdir(cache);
+	}
+	vala_panel_proc_file_close(&b.stat);
+	vala_panel_proc_file_close(&b.meminfo);
+	vala_panel_proc_file_close(&b.net_dev);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,125 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays a sysfs tree with cpufreq and hwmon files and compares what a
+ * tick of the CPU frequency applet costs when every file is opened, read
+ * and closed again, as thermal applets do, with pread() on descriptors
+ * which util/sensors.c keeps open.
+ *
+ * Usage: bench-sensors FIXTURES_DIR [ITERATIONS]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sensors.h"
+
+#define DEFAULT_ITERATIONS 20000
+#define FIXTURE_CPUS 8
+#define FIXTURE_TEMPS 7 /* Package and four cores of coretemp, acpitz, nvme */
+#define CPUFREQ_FORMAT "%s/devices/system/cpu/cpu%u/cpufreq/scaling_cur_freq"
+#define HWMON_FORMAT "%s/class/hwmon/hwmon%u/temp%u_input"
+
+static guint64 now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (guint64)ts.tv_sec * G_GUINT64_CONSTANT(1000000000) + (guint64)ts.tv_nsec;
+}
+
+/* Legacy reader: whole file into a fresh string on every tick */
+static gint64 legacy_read(const char *path)
+{
+	g_autofree char *contents = NULL;
+	if (!g_file_get_contents(path, &contents, NULL, NULL))
+		return 0;
+	return g_ascii_strtoll(contents, NULL, 10);
+}
+
+/* Same files as vala_panel_sensors_open() finds in the fixture */
+static GPtrArray *legacy_paths(const char *root)
+{
+	GPtrArray *paths = g_ptr_array_new_with_free_func(g_free);
+	for (uint i = 0; i < FIXTURE_CPUS; i++)
+		g_ptr_array_add(paths, g_strdup_printf(CPUFREQ_FORMAT, root, i));
+	for (uint i = 1; i <= FIXTURE_TEMPS - 2; i++)
+		g_ptr_array_add(paths, g_strdup_printf(HWMON_FORMAT, root, 0, i));
+	g_ptr_array_add(paths, g_strdup_printf(HWMON_FORMAT, root, 1, 1));
+	g_ptr_array_add(paths, g_strdup_printf(HWMON_FORMAT, root, 2, 1));
+	return paths;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s FIXTURES_DIR [ITERATIONS]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	uint iterations = argc > 2 ? (uint)strtoul(argv[2], NULL, 10) : DEFAULT_ITERATIONS;
+	if (iterations == 0)
+		iterations = DEFAULT_ITERATIONS;
+	g_autofree char *root       = g_build_filename(argv[1], "sys", NULL);
+	ValaPanelSensors sensors    = { 0 };
+	g_autoptr(GPtrArray) paths  = legacy_paths(root);
+	g_autofree gint64 *expected = g_new0(gint64, paths->len);
+	if (!vala_panel_sensors_open(&sensors, root))
+	{
+		fprintf(stderr, "No sensors in fixture %s\n", root);
+		return EXIT_FAILURE;
+	}
+	bool ok = sensors.n_freqs == FIXTURE_CPUS && sensors.n_temps == FIXTURE_TEMPS;
+	guint64 start, legacy, pread_time;
+
+	start = now_ns();
+	for (uint i = 0; i < iterations; i++)
+		for (uint p = 0; p < paths->len; p++)
+			expected[p] = legacy_read(g_ptr_array_index(paths, p));
+	legacy = now_ns() - start;
+
+	start = now_ns();
+	for (uint i = 0; i < iterations; i++)
+		ok &= vala_panel_sensors_read(&sensors);
+	pread_time = now_ns() - start;
+
+	printf("%-10s %11.1f ns\n", "open+read", (double)legacy / iterations);
+	printf("%-10s %11.1f ns\n", "pread", (double)pread_time / iterations);
+	/* Both readers must see the same values */
+	for (uint i = 0; ok && i < sensors.n_freqs; i++)
+		ok &= sensors.freqs[i].khz == (guint64)expected[i] && sensors.freqs[i].max_khz > 0;
+	for (uint i = 0; ok && i < sensors.n_temps; i++)
+	{
+		gint64 millidegrees = (gint64)(sensors.temps[i].celsius * 1000.0 + 0.5);
+		ok &= millidegrees == expected[FIXTURE_CPUS + i];
+	}
+	/* Labels come from tempN_label, or from the input number when there is none */
+	ok &= !g_strcmp0(sensors.temps[0].label, "coretemp Package id 0");
+	ok &= !g_strcmp0(sensors.temps[FIXTURE_TEMPS - 2].label, "acpitz temp1");
+	/* Bogus limits fall back to the default */
+	ok &= sensors.temps[FIXTURE_TEMPS - 1].critical == VALA_PANEL_SENSOR_DEFAULT_CRITICAL;
+	vala_panel_sensors_close(&sensors);
+	if (!ok)
+	{
+		fprintf(stderr, "Readers disagree on fixture %s\n", root);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
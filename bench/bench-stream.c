@@ -0,0 +1,188 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Feeds a child stream from a copy of this program, which prints numbered
+ * samples at 100 per second, and reports what the panel process spends on
+ * each of them. For comparison, it also reports wall time of spawning a
+ * command per sample, which is what a script run on every tick costs.
+ * A burst without pauses shows how many samples per second a stream can
+ * take at most.
+ *
+ * Usage: bench-stream [SECONDS]
+ */
+
+#include <gio/gio.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include "childstream.h"
+
+#define DEFAULT_SECONDS 3
+#define SUSTAINED_RATE 100 /* Samples per second */
+#define BURST_COUNT 200000
+#define SPAWN_COUNT 100
+#define RUN_TIMEOUT 60 /* Seconds */
+
+typedef struct
+{
+	GMainLoop *loop;
+	uint expected;
+	uint received;
+	guint64 sum;
+	bool timed_out;
+} StreamRun;
+
+static guint64 now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (guint64)ts.tv_sec * G_GUINT64_CONSTANT(1000000000) + (guint64)ts.tv_nsec;
+}
+
+/* User and system time of this process, without children */
+static guint64 cpu_ns(void)
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return ((guint64)usage.ru_utime.tv_sec + (guint64)usage.ru_stime.tv_sec) *
+	           G_GUINT64_CONSTANT(1000000000) +
+	       ((guint64)usage.ru_utime.tv_usec + (guint64)usage.ru_stime.tv_usec) * 1000;
+}
+
+/* Child side: sample i is i % 100, so sums are known in advance */
+static int emit(uint rate, uint count)
+{
+	guint64 start = now_ns();
+	for (uint i = 0; i < count; i++)
+	{
+		if (rate > 0)
+		{
+			guint64 due = start + (guint64)i * G_GUINT64_CONSTANT(1000000000) / rate;
+			guint64 now = now_ns();
+			guint64 gap = due > now ? due - now : 0;
+			if (gap > 0)
+			{
+				struct timespec pause = { .tv_sec  = (time_t)(gap / 1000000000),
+					                  .tv_nsec = (long)(gap % 1000000000) };
+				nanosleep(&pause, NULL);
+			}
+		}
+		printf("%u\n", i % 100);
+		/* Sustained samples go out one by one, as a monitoring script does */
+		if (rate > 0)
+			fflush(stdout);
+	}
+	return fflush(stdout) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static guint64 expected_sum(uint count)
+{
+	guint64 rest = count % 100;
+	/* Every full hundred sums to 4950 */
+	return (guint64)(count / 100) * 4950 + (rest > 0 ? rest * (rest - 1) / 2 : 0);
+}
+
+static void on_sample(double value, G_GNUC_UNUSED gint64 time, gpointer data)
+{
+	StreamRun *run = (StreamRun *)data;
+	run->received++;
+	run->sum += (guint64)value;
+	if (run->received == run->expected)
+		g_main_loop_quit(run->loop);
+}
+
+static gboolean on_timeout(gpointer data)
+{
+	StreamRun *run = (StreamRun *)data;
+	run->timed_out = true;
+	g_main_loop_quit(run->loop);
+	return G_SOURCE_REMOVE;
+}
+
+static bool run_stream(const char *program, uint rate, uint count, guint64 *cpu, guint64 *wall)
+{
+	g_autofree char *quoted  = g_shell_quote(program);
+	g_autofree char *command = g_strdup_printf("%s --emit %u %u", quoted, rate, count);
+	StreamRun run            = { .loop = g_main_loop_new(NULL, false), .expected = count };
+	ValaPanelChildStream *stream =
+	    vala_panel_child_stream_start(command, on_sample, &run, NULL);
+	uint timeout = g_timeout_add_seconds(RUN_TIMEOUT, on_timeout, &run);
+	guint64 cpu_start = cpu_ns(), wall_start = now_ns();
+	g_main_loop_run(run.loop);
+	*cpu  = cpu_ns() - cpu_start;
+	*wall = now_ns() - wall_start;
+	if (!run.timed_out)
+		g_source_remove(timeout);
+	vala_panel_child_stream_stop(stream);
+	g_main_loop_unref(run.loop);
+	return !run.timed_out && run.sum == expected_sum(count);
+}
+
+/* Legacy way: one process per sample, read to the end and parsed */
+static bool run_spawns(const char *program, guint64 *wall)
+{
+	const char *argv[] = { program, "--emit", "0", "1", NULL };
+	guint64 start      = now_ns();
+	bool ok            = true;
+	for (uint i = 0; i < SPAWN_COUNT && ok; i++)
+	{
+		g_autofree char *out = NULL;
+		ok = g_spawn_sync(NULL,
+		                  (char **)argv,
+		                  NULL,
+		                  G_SPAWN_DEFAULT,
+		                  NULL,
+		                  NULL,
+		                  &out,
+		                  NULL,
+		                  NULL,
+		                  NULL) &&
+		     g_ascii_strtod(out, NULL) == 0.0;
+	}
+	*wall = now_ns() - start;
+	return ok;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc == 4 && !g_strcmp0(argv[1], "--emit"))
+		return emit((uint)strtoul(argv[2], NULL, 10), (uint)strtoul(argv[3], NULL, 10));
+	uint seconds = argc > 1 ? (uint)strtoul(argv[1], NULL, 10) : DEFAULT_SECONDS;
+	if (seconds == 0)
+		seconds = DEFAULT_SECONDS;
+	uint count = seconds * SUSTAINED_RATE;
+	guint64 spawn_wall, sustained_cpu, sustained_wall, burst_cpu, burst_wall;
+	bool ok = run_spawns(argv[0], &spawn_wall);
+	ok &= run_stream(argv[0], SUSTAINED_RATE, count, &sustained_cpu, &sustained_wall);
+	ok &= run_stream(argv[0], 0, BURST_COUNT, &burst_cpu, &burst_wall);
+
+	printf("%-10s %11.1f ns\n", "spawn", (double)spawn_wall / SPAWN_COUNT);
+	printf("%-10s %11.1f ns\n", "stream", (double)sustained_cpu / count);
+	printf("%-10s %11.1f ns\n", "burst", (double)burst_cpu / BURST_COUNT);
+	printf("%-10s %11.0f /s\n", "max rate", BURST_COUNT / ((double)burst_wall / 1e9));
+	if (!ok)
+	{
+		fprintf(stderr, "Samples were lost or misread\n");
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Converts StatusNotifierItem pixmaps of typical sizes from ARGB32 in
+ * network byte order to RGBA, as the tray does on every NewIcon. The
+ * previous way, a copy of the pixmap swapped and reordered in place one
+ * word at a time, is compared with the one pass conversion of
+ * icon-swizzle.c, both vectorized and scalar.
+ *
+ * Usage: bench-swizzle [ITERATIONS]
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "icon-swizzle.h"
+
+#define DEFAULT_ITERATIONS 20000
+
+static const int sizes[] = { 22, 64, 256 };
+
+static guint64 now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (guint64)ts.tv_sec * G_GUINT64_CONSTANT(1000000000) + (guint64)ts.tv_nsec;
+}
+
+/* Previous icon_pixmap_to_gicon(): duplicate, then swap and reorder in place */
+static guint8 *legacy_convert(const guint8 *src, size_t n_pixels)
+{
+	guint32 *data = g_malloc(n_pixels * 4);
+	memcpy(data, src, n_pixels * 4);
+	for (size_t i = 0; i < n_pixels; i++)
+	{
+		data[i]  = GUINT32_FROM_BE(data[i]);
+		guint8 a = (data[i] >> 24) & 0xFF;
+		guint8 b = (data[i] >> 16) & 0xFF;
+		guint8 g = (data[i] >> 8) & 0xFF;
+		guint8 r = data[i] & 0xFF;
+		data[i]  = (guint32)a << 24 | (guint32)r << 16 | (guint32)g << 8 | b;
+	}
+	return (guint8 *)data;
+}
+
+static guint8 *kernel_convert(const guint8 *src, size_t n_pixels, bool scalar)
+{
+	guint8 *dst = g_malloc(n_pixels * 4);
+	if (scalar)
+		icon_swizzle_argb_to_rgba_scalar(src, dst, n_pixels);
+	else
+		icon_swizzle_argb_to_rgba(src, dst, n_pixels);
+	return dst;
+}
+
+static double bench_size(int size, uint iterations, guint64 *legacy, guint64 *scalar,
+                         guint64 *vector, bool *ok)
+{
+	/* Odd pixel count exercises the scalar tail of the vector loop */
+	size_t n_pixels = (size_t)size * (size_t)size + 1;
+	guint8 *src     = g_malloc(n_pixels * 4);
+	guint64 start;
+	for (size_t i = 0; i < n_pixels * 4; i++)
+		src[i] = (guint8)(i * 131 + 7);
+
+	g_autofree guint8 *expected = legacy_convert(src, n_pixels);
+	start                       = now_ns();
+	for (uint i = 0; i < iterations; i++)
+		g_free(legacy_convert(src, n_pixels));
+	*legacy = now_ns() - start;
+
+	start = now_ns();
+	for (uint i = 0; i < iterations; i++)
+		g_free(kernel_convert(src, n_pixels, true));
+	*scalar = now_ns() - start;
+
+	start = now_ns();
+	for (uint i = 0; i < iterations; i++)
+		g_free(kernel_convert(src, n_pixels, false));
+	*vector = now_ns() - start;
+
+	g_autofree guint8 *scalar_out = kernel_convert(src, n_pixels, true);
+	g_autofree guint8 *vector_out = kernel_convert(src, n_pixels, false);
+	*ok &= !memcmp(expected, scalar_out, n_pixels * 4) &&
+	       !memcmp(expected, vector_out, n_pixels * 4);
+	g_free(src);
+	return (double)(n_pixels * 4) * iterations;
+}
+
+int main(int argc, char **argv)
+{
+	uint iterations = argc > 1 ? (uint)strtoul(argv[1], NULL, 10) : DEFAULT_ITERATIONS;
+	if (iterations == 0)
+		iterations = DEFAULT_ITERATIONS;
+	bool ok = true;
+	printf("%-8s %12s %12s %12s\n", "size", "legacy", "scalar", "vector");
+	for (uint s = 0; s < G_N_ELEMENTS(sizes); s++)
+	{
+		guint64 legacy, scalar, vector;
+		double bytes = bench_size(sizes[s], iterations, &legacy, &scalar, &vector, &ok);
+		/* Bytes per nanosecond are gigabytes per second */
+		printf("%3dx%-4d %9.2f GB/s %7.2f GB/s %7.2f GB/s\n",
+		       sizes[s],
+		       sizes[s],
+		       bytes / legacy,
+		       bytes / scalar,
+		       bytes / vector);
+	}
+	if (!ok)
+	{
+		fprintf(stderr, "Conversions disagree\n");
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,781 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib-unix.h>
+#include <unistd.h>
+
+#include "netlink.h"
+#include "power.h"
+#include "sampler.h"
+#include "scheduler.h"
+#include "sensors.h"
+
+#define SAMPLER_PERIOD 1         /* Seconds */
+#define SAMPLER_TOLERANCE 1      /* Seconds, readings carry their own timestamp */
+#define SAMPLER_FAST_PERIOD 100 /* Milliseconds */
+#define PRESSURE_DIR "/proc/pressure"
+#define SYSFS_ROOT "/sys"
+#define PRESSURE_DIR_ENV "VALA_PANEL_PRESSURE_DIR"
+#define SYSFS_ROOT_ENV "VALA_PANEL_SYSFS_ROOT"
+#define PROC_DIR "/proc"
+/* 10% stall over 2s, windows of unprivileged triggers must be multiples of 2s */
+#define PRESSURE_TRIGGER "some 200000 2000000"
+
+typedef struct
+{
+	uint id;
+	ValaPanelSampleSource sources;
+	ValaPanelSamplerFunc func;
+	gpointer user_data;
+	bool paused;
+	bool fast;
+} SamplerSubscriber;
+
+/* Subscribers are read on one of two timers */
+typedef enum
+{
+	SAMPLER_SLOW = 1 << 0,
+	SAMPLER_FAST = 1 << 1,
+	SAMPLER_ANY  = SAMPLER_SLOW | SAMPLER_FAST,
+} SamplerRate;
+
+struct _ValaPanelSampler
+{
+	GObject __parent__;
+	GArray *subscribers; /* Array of SamplerSubscriber */
+	GArray *net;         /* Link table of ValaPanelNetSample, reused between ticks */
+	GArray *disks;       /* Of ValaPanelDiskSample, reused like net */
+	ValaPanelCpuSample *cores; /* Reused between ticks, like net */
+	uint n_cores;
+	uint cores_capacity;
+	ValaPanelProcFile stat;
+	ValaPanelProcFile meminfo;
+	ValaPanelProcFile net_dev;
+	ValaPanelProcFile diskstats;
+	ValaPanelNetlink netlink;
+	uint netlink_watch;  /* Link events, while netlink is open */
+	bool netlink_failed; /* Sockets are not permitted, so /proc/net/dev is read instead */
+	ValaPanelProcFile pressure[VALA_PANEL_PSI_N_RESOURCES];
+	uint pressure_watch[VALA_PANEL_PSI_N_RESOURCES]; /* 0 if file is only polled */
+	char *pressure_dir;
+	ValaPanelSensors sensors;
+	bool sensors_failed; /* Neither cpufreq nor hwmon found, so sysfs is not scanned again */
+	char *sysfs_root;
+	ValaPanelPower power;
+	bool power_open;   /* Some RAPL package or battery was found */
+	bool power_failed; /* Neither was, so sysfs is not scanned again */
+	int uevent_fd;     /* Power supply events, while power is open */
+	uint uevent_watch;
+	ValaPanelProcScanner *scanner; /* Worker thread, while processes are requested */
+	ValaPanelProcTop *top;         /* Taken from scanner, owned by sampler */
+	ValaPanelSnapshot snapshot;
+	uint last_id;
+	uint task;       /* Scheduler task, while anything is requested at slow rate */
+	uint fast_timer; /* Timeout source, while anything is requested at fast rate */
+	bool dispatching;
+};
+
+enum
+{
+	PROP_DUMMY,
+	PROP_PRESSURE_DIR,
+	PROP_SYSFS_ROOT,
+	N_PROPERTIES
+};
+
+static GParamSpec *sampler_spec[N_PROPERTIES];
+
+G_DEFINE_TYPE(ValaPanelSampler, vala_panel_sampler, G_TYPE_OBJECT)
+
+static ValaPanelSampler *default_sampler = NULL;
+
+const ValaPanelNetSample *vala_panel_snapshot_lookup_net(const ValaPanelSnapshot *self,
+                                                         const char *iface)
+{
+	if (!(self->valid & VALA_PANEL_SAMPLE_NET))
+		return NULL;
+	for (uint i = 0; i < self->n_net; i++)
+		if (!g_strcmp0(self->net[i].name, iface))
+			return &self->net[i];
+	return NULL;
+}
+
+/*
+ * Source readers
+ */
+
+/* Files stay open for the sampler lifetime and are reread in place */
+#define STAT_BUFFER_SIZE 65536 /* Holds cpuN lines of ~800 cores, grows past that */
+#define MEMINFO_BUFFER_SIZE 4096
+#define NET_DEV_BUFFER_SIZE 4096
+#define DISKSTATS_BUFFER_SIZE 8192
+#define PRESSURE_BUFFER_SIZE 256
+
+static const char *pressure_names[VALA_PANEL_PSI_N_RESOURCES] = { "cpu", "memory", "io" };
+
+static bool read_file(ValaPanelProcFile *file, const char *path, size_t size, bool grow)
+{
+	if (file->fd < 0 && !vala_panel_proc_file_open(file, path, size, grow))
+		return false;
+	return vala_panel_proc_file_read(file);
+}
+
+static bool read_cpu(ValaPanelSampler *self, ValaPanelCpuSample *cpu)
+{
+	if (!read_file(&self->stat, "/proc/stat", STAT_BUFFER_SIZE, true))
+		return false;
+	return vala_panel_proc_parse_stat(self->stat.buf, self->stat.len, cpu);
+}
+
+/* Same file as read_cpu(), but every core is parsed in the same pass */
+static bool read_cores(ValaPanelSampler *self, ValaPanelCpuSample *cpu)
+{
+	if (!read_file(&self->stat, "/proc/stat", STAT_BUFFER_SIZE, true))
+		return false;
+	const char *buf = self->stat.buf;
+	size_t len      = self->stat.len;
+	uint count =
+	    vala_panel_proc_parse_stat_cores(buf, len, cpu, self->cores, self->cores_capacity);
+	/* Storage only grows when cores come online, so steady state does not allocate */
+	if (count > self->cores_capacity)
+	{
+		self->cores_capacity = count;
+		self->cores          = g_renew(ValaPanelCpuSample, self->cores, count);
+		vala_panel_proc_parse_stat_cores(buf, len, cpu, self->cores, self->cores_capacity);
+	}
+	self->n_cores = count;
+	return count > 0;
+}
+
+static bool read_mem(ValaPanelSampler *self, ValaPanelMemSample *mem)
+{
+	if (!read_file(&self->meminfo, "/proc/meminfo", MEMINFO_BUFFER_SIZE, true))
+		return false;
+	if (!vala_panel_proc_parse_meminfo(self->meminfo.buf, self->meminfo.len, mem))
+	{
+		g_warning("sampler: Could not read all values from /proc/meminfo");
+		return false;
+	}
+	return true;
+}
+
+static gboolean sampler_netlink_ready(int fd, GIOCondition condition, gpointer data);
+
+static void close_netlink(ValaPanelSampler *self)
+{
+	if (self->netlink_watch != 0)
+		g_source_remove(self->netlink_watch);
+	self->netlink_watch = 0;
+	vala_panel_netlink_close(&self->netlink);
+}
+
+static bool open_netlink(ValaPanelSampler *self)
+{
+	if (!vala_panel_netlink_open(&self->netlink))
+		return false;
+	/* Table is listed once, then link events keep names and states current */
+	if (!vala_panel_netlink_request_links(&self->netlink, self->net))
+	{
+		vala_panel_netlink_close(&self->netlink);
+		return false;
+	}
+	self->netlink_watch = g_unix_fd_add(self->netlink.events_fd,
+	                                    G_IO_IN | G_IO_ERR,
+	                                    sampler_netlink_ready,
+	                                    self);
+	return true;
+}
+
+static bool read_net_dev(ValaPanelSampler *self)
+{
+	if (!read_file(&self->net_dev, "/proc/net/dev", NET_DEV_BUFFER_SIZE, true))
+		return false;
+	const char *buf         = self->net_dev.buf;
+	size_t len              = self->net_dev.len;
+	ValaPanelNetSample *net = (ValaPanelNetSample *)self->net->data;
+	uint count              = vala_panel_proc_parse_net_dev(buf, len, net, self->net->len);
+	bool fits               = count <= self->net->len;
+	/* Storage only grows when interfaces appear, so steady state does not allocate */
+	g_array_set_size(self->net, count);
+	if (!fits)
+	{
+		net = (ValaPanelNetSample *)self->net->data;
+		vala_panel_proc_parse_net_dev(buf, len, net, count);
+	}
+	return true;
+}
+
+static bool read_net(ValaPanelSampler *self)
+{
+	if (self->netlink.fd < 0 && !self->netlink_failed && !open_netlink(self))
+	{
+		g_debug("sampler: Netlink is not available, reading /proc/net/dev");
+		self->netlink_failed = true;
+	}
+	if (self->netlink.fd >= 0)
+	{
+		if (vala_panel_netlink_request_stats(&self->netlink, self->net))
+			return true;
+		/* Reopened on next read, with a fresh link table */
+		close_netlink(self);
+	}
+	return read_net_dev(self);
+}
+
+static bool read_disks(ValaPanelSampler *self)
+{
+	if (!read_file(&self->diskstats, "/proc/diskstats", DISKSTATS_BUFFER_SIZE, true))
+		return false;
+	const char *buf            = self->diskstats.buf;
+	size_t len                 = self->diskstats.len;
+	ValaPanelDiskSample *disks = (ValaPanelDiskSample *)self->disks->data;
+	uint capacity              = self->disks->len;
+	uint count                 = vala_panel_proc_parse_diskstats(buf, len, disks, capacity);
+	bool fits                  = count <= capacity;
+	/* Grows like net, when devices appear */
+	g_array_set_size(self->disks, count);
+	if (!fits)
+	{
+		disks = (ValaPanelDiskSample *)self->disks->data;
+		vala_panel_proc_parse_diskstats(buf, len, disks, count);
+	}
+	return true;
+}
+
+static bool read_sensors(ValaPanelSampler *self)
+{
+	if (self->sensors.files == NULL && !self->sensors_failed &&
+	    !vala_panel_sensors_open(&self->sensors, self->sysfs_root))
+	{
+		g_debug("sampler: No cpufreq or hwmon sensors in %s", self->sysfs_root);
+		self->sensors_failed = true;
+	}
+	if (self->sensors.files == NULL)
+		return false;
+	if (vala_panel_sensors_read(&self->sensors))
+		return true;
+	/* Hotplugged chip went away, so sensors after it move down */
+	vala_panel_sensors_close(&self->sensors);
+	return vala_panel_sensors_open(&self->sensors, self->sysfs_root) &&
+	       vala_panel_sensors_read(&self->sensors);
+}
+
+static gboolean sampler_uevent_ready(int fd, GIOCondition condition, gpointer data);
+
+static void close_power(ValaPanelSampler *self)
+{
+	if (self->uevent_watch != 0)
+		g_source_remove(self->uevent_watch);
+	self->uevent_watch = 0;
+	if (self->uevent_fd >= 0)
+		close(self->uevent_fd);
+	self->uevent_fd = -1;
+	if (self->power_open)
+		vala_panel_power_close(&self->power);
+	self->power_open = false;
+}
+
+static bool read_power(ValaPanelSampler *self, ValaPanelSnapshot *snap)
+{
+	if (!self->power_open && !self->power_failed)
+	{
+		self->power_open   = vala_panel_power_open(&self->power, self->sysfs_root);
+		self->power_failed = !self->power_open;
+		if (self->power_failed)
+			g_debug("sampler: No RAPL packages or batteries in %s", self->sysfs_root);
+		/* Without uevents, for example in a network namespace, AC state is only polled */
+		else if ((self->uevent_fd = vala_panel_uevent_open()) >= 0)
+			self->uevent_watch = g_unix_fd_add(self->uevent_fd,
+			                                   G_IO_IN | G_IO_ERR,
+			                                   sampler_uevent_ready,
+			                                   self);
+	}
+	if (!self->power_open)
+		return false;
+	vala_panel_power_read(&self->power, &snap->power);
+	return true;
+}
+
+/* Never blocks: the scanner publishes a result per pass, and the last one is kept */
+static bool read_processes(ValaPanelSampler *self)
+{
+	if (self->scanner == NULL)
+		self->scanner = vala_panel_proc_scanner_start(PROC_DIR);
+	ValaPanelProcTop *top = vala_panel_proc_scanner_take(self->scanner);
+	if (top != NULL)
+	{
+		g_free(self->top);
+		self->top = top;
+	}
+	return self->top != NULL;
+}
+
+static void close_processes(ValaPanelSampler *self)
+{
+	g_clear_pointer(&self->scanner, vala_panel_proc_scanner_stop);
+	g_clear_pointer(&self->top, g_free);
+}
+
+static gboolean sampler_pressure_ready(int fd, GIOCondition condition, gpointer data);
+
+static void close_pressure(ValaPanelSampler *self, ValaPanelPsiResource r)
+{
+	if (self->pressure_watch[r] != 0)
+		g_source_remove(self->pressure_watch[r]);
+	self->pressure_watch[r] = 0;
+	vala_panel_proc_file_close(&self->pressure[r]);
+}
+
+static bool open_pressure(ValaPanelSampler *self, ValaPanelPsiResource r)
+{
+	g_autofree char *path   = g_build_filename(self->pressure_dir, pressure_names[r], NULL);
+	ValaPanelProcFile *file = &self->pressure[r];
+	/* Without a trigger, for example when not permitted, file is only polled on ticks */
+	if (vala_panel_proc_file_open_trigger(file, path, PRESSURE_BUFFER_SIZE, PRESSURE_TRIGGER))
+		self->pressure_watch[r] = g_unix_fd_add(file->fd,
+		                                        G_IO_PRI | G_IO_ERR,
+		                                        sampler_pressure_ready,
+		                                        self);
+	else if (!vala_panel_proc_file_open(file, path, PRESSURE_BUFFER_SIZE, false))
+		return false;
+	return true;
+}
+
+static bool read_pressure(ValaPanelSampler *self, ValaPanelSnapshot *snap)
+{
+	snap->pressure_valid = 0;
+	for (uint r = 0; r < VALA_PANEL_PSI_N_RESOURCES; r++)
+	{
+		ValaPanelProcFile *file = &self->pressure[r];
+		if (file->fd < 0 && !open_pressure(self, r))
+			continue;
+		if (vala_panel_proc_file_read(file) &&
+		    vala_panel_proc_parse_pressure(file->buf, file->len, &snap->pressure[r]))
+			snap->pressure_valid |= 1u << r;
+	}
+	return snap->pressure_valid != 0;
+}
+
+/*
+ * Dispatching
+ */
+
+static inline SamplerRate sampler_rate(const SamplerSubscriber *sub)
+{
+	return sub->fast ? SAMPLER_FAST : SAMPLER_SLOW;
+}
+
+static ValaPanelSampleSource sampler_requested_sources(ValaPanelSampler *self, SamplerRate rate)
+{
+	ValaPanelSampleSource sources = VALA_PANEL_SAMPLE_NONE;
+	for (uint i = 0; i < self->subscribers->len; i++)
+	{
+		SamplerSubscriber *sub = &g_array_index(self->subscribers, SamplerSubscriber, i);
+		if (!sub->paused && (sampler_rate(sub) & rate))
+			sources |= sub->sources;
+	}
+	return sources;
+}
+
+static void sampler_tick(void *data);
+static gboolean sampler_fast_tick(gpointer data);
+
+/* Keep scheduler task and fast timer only while some active subscriber wants data */
+static void sampler_update_task(ValaPanelSampler *self)
+{
+	ValaPanelSampleSource sources = sampler_requested_sources(self, SAMPLER_SLOW);
+	ValaPanelSampleSource fast    = sampler_requested_sources(self, SAMPLER_FAST);
+	bool needed                   = sources != VALA_PANEL_SAMPLE_NONE;
+	/* Closing a pressure file also disarms its trigger */
+	if (!((sources | fast) & VALA_PANEL_SAMPLE_PRESSURE))
+		for (uint r = 0; r < VALA_PANEL_PSI_N_RESOURCES; r++)
+			close_pressure(self, r);
+	if (!((sources | fast) & VALA_PANEL_SAMPLE_NET))
+		close_netlink(self);
+	if (!((sources | fast) & VALA_PANEL_SAMPLE_SENSORS))
+		vala_panel_sensors_close(&self->sensors);
+	if (!((sources | fast) & VALA_PANEL_SAMPLE_PROCESSES))
+		close_processes(self);
+	if (!((sources | fast) & VALA_PANEL_SAMPLE_POWER))
+		close_power(self);
+	/* Scheduler runs on whole seconds, so fast rate gets a plain timeout of its own */
+	if (fast != VALA_PANEL_SAMPLE_NONE && self->fast_timer == 0)
+		self->fast_timer = g_timeout_add(SAMPLER_FAST_PERIOD, sampler_fast_tick, self);
+	else if (fast == VALA_PANEL_SAMPLE_NONE && self->fast_timer != 0)
+	{
+		g_source_remove(self->fast_timer);
+		self->fast_timer = 0;
+	}
+	if (needed && self->task == 0)
+		self->task = vala_panel_scheduler_add(vala_panel_scheduler_get_default(),
+		                                       SAMPLER_PERIOD,
+		                                       SAMPLER_TOLERANCE,
+		                                       sampler_tick,
+		                                       self,
+		                                       NULL);
+	else if (!needed && self->task != 0)
+	{
+		vala_panel_scheduler_remove(vala_panel_scheduler_get_default(), self->task);
+		self->task = 0;
+	}
+}
+
+static void sampler_read(ValaPanelSampler *self, ValaPanelSampleSource sources)
+{
+	ValaPanelSnapshot *snap = &self->snapshot;
+	snap->valid             = VALA_PANEL_SAMPLE_NONE;
+	snap->time              = g_get_monotonic_time();
+	if ((sources & VALA_PANEL_SAMPLE_CPU_CORES) && read_cores(self, &snap->cpu))
+		snap->valid |= VALA_PANEL_SAMPLE_CPU | VALA_PANEL_SAMPLE_CPU_CORES;
+	else if ((sources & VALA_PANEL_SAMPLE_CPU) && read_cpu(self, &snap->cpu))
+		snap->valid |= VALA_PANEL_SAMPLE_CPU;
+	if ((sources & VALA_PANEL_SAMPLE_MEM) && read_mem(self, &snap->mem))
+		snap->valid |= VALA_PANEL_SAMPLE_MEM;
+	if ((sources & VALA_PANEL_SAMPLE_NET) && read_net(self))
+		snap->valid |= VALA_PANEL_SAMPLE_NET;
+	if ((sources & VALA_PANEL_SAMPLE_PRESSURE) && read_pressure(self, snap))
+		snap->valid |= VALA_PANEL_SAMPLE_PRESSURE;
+	if ((sources & VALA_PANEL_SAMPLE_DISK) && read_disks(self))
+		snap->valid |= VALA_PANEL_SAMPLE_DISK;
+	if ((sources & VALA_PANEL_SAMPLE_SENSORS) && read_sensors(self))
+		snap->valid |= VALA_PANEL_SAMPLE_SENSORS;
+	if ((sources & VALA_PANEL_SAMPLE_PROCESSES) && read_processes(self))
+		snap->valid |= VALA_PANEL_SAMPLE_PROCESSES;
+	if ((sources & VALA_PANEL_SAMPLE_POWER) && read_power(self, snap))
+		snap->valid |= VALA_PANEL_SAMPLE_POWER;
+	if (sources & VALA_PANEL_SAMPLE_CLOCK)
+		snap->valid |= VALA_PANEL_SAMPLE_CLOCK;
+	snap->net     = (ValaPanelNetSample *)self->net->data;
+	snap->n_net   = self->net->len;
+	snap->disks   = (ValaPanelDiskSample *)self->disks->data;
+	snap->n_disks = self->disks->len;
+	if (snap->valid & VALA_PANEL_SAMPLE_NET)
+		snap->net_digest = vala_panel_net_digest(snap->net, snap->n_net);
+	if (snap->valid & VALA_PANEL_SAMPLE_DISK)
+		snap->disk_digest = vala_panel_disk_digest(snap->disks, snap->n_disks);
+	snap->cores   = self->cores;
+	snap->n_cores = self->n_cores;
+	snap->freqs   = self->sensors.freqs;
+	snap->n_freqs = self->sensors.n_freqs;
+	snap->temps   = self->sensors.temps;
+	snap->n_temps = self->sensors.n_temps;
+	snap->top     = self->top;
+}
+
+static void sampler_compact(ValaPanelSampler *self)
+{
+	for (uint i = self->subscribers->len; i > 0; i--)
+		if (g_array_index(self->subscribers, SamplerSubscriber, i - 1).func == NULL)
+			g_array_remove_index(self->subscribers, i - 1);
+}
+
+static void sampler_dispatch(ValaPanelSampler *self, SamplerRate rate)
+{
+	ValaPanelSnapshot *snap = &self->snapshot;
+	/* Subscribers added from callbacks will get the next tick */
+	uint len          = self->subscribers->len;
+	self->dispatching = true;
+	for (uint i = 0; i < len; i++)
+	{
+		SamplerSubscriber *sub = &g_array_index(self->subscribers, SamplerSubscriber, i);
+		if (sub->func != NULL && !sub->paused && (sampler_rate(sub) & rate) &&
+		    (sub->sources & snap->valid))
+			sub->func(snap, sub->user_data);
+	}
+	self->dispatching = false;
+	sampler_compact(self);
+}
+
+static void sampler_tick(void *data)
+{
+	ValaPanelSampler *self = VALA_PANEL_SAMPLER(data);
+	/* Every source is read once, no matter how many applets need it */
+	sampler_read(self, sampler_requested_sources(self, SAMPLER_SLOW));
+	sampler_dispatch(self, SAMPLER_SLOW);
+}
+
+/* Fast subscribers are never mixed into slow ticks, so slow ones cost the same as before */
+static gboolean sampler_fast_tick(gpointer data)
+{
+	ValaPanelSampler *self = VALA_PANEL_SAMPLER(data);
+	sampler_read(self, sampler_requested_sources(self, SAMPLER_FAST));
+	sampler_dispatch(self, SAMPLER_FAST);
+	return G_SOURCE_CONTINUE;
+}
+
+/* Trigger fired: stall crossed the threshold, deliver pressure before the next tick */
+static gboolean sampler_pressure_ready(int fd, GIOCondition condition, gpointer data)
+{
+	ValaPanelSampler *self = VALA_PANEL_SAMPLER(data);
+	if (self->dispatching)
+		return G_SOURCE_CONTINUE;
+	if (condition & G_IO_ERR)
+	{
+		/* Monitored group went away, reopen on next read */
+		for (uint r = 0; r < VALA_PANEL_PSI_N_RESOURCES; r++)
+			if (self->pressure[r].fd == fd)
+			{
+				self->pressure_watch[r] = 0;
+				vala_panel_proc_file_close(&self->pressure[r]);
+			}
+		return G_SOURCE_REMOVE;
+	}
+	sampler_read(self, VALA_PANEL_SAMPLE_PRESSURE);
+	sampler_dispatch(self, SAMPLER_ANY);
+	return G_SOURCE_CONTINUE;
+}
+
+/* Supply changed, like a charger plugged in: deliver power state before the next tick */
+static gboolean sampler_uevent_ready(int fd, G_GNUC_UNUSED GIOCondition condition,
+                                     gpointer data)
+{
+	ValaPanelSampler *self = VALA_PANEL_SAMPLER(data);
+	if (self->dispatching)
+		return G_SOURCE_CONTINUE;
+	/* Queue is drained anyway, events of other devices are not kept waiting */
+	if (!vala_panel_uevent_read(fd, "power_supply"))
+		return G_SOURCE_CONTINUE;
+	sampler_read(self, VALA_PANEL_SAMPLE_POWER);
+	sampler_dispatch(self, SAMPLER_ANY);
+	return G_SOURCE_CONTINUE;
+}
+
+/* Link appeared, changed state, got renamed or went away. Lost events show up as G_IO_ERR */
+static gboolean sampler_netlink_ready(G_GNUC_UNUSED int fd, G_GNUC_UNUSED GIOCondition condition,
+                                      gpointer data)
+{
+	ValaPanelSampler *self = VALA_PANEL_SAMPLER(data);
+	/* Shared snapshot points into the link table */
+	if (self->dispatching)
+		return G_SOURCE_CONTINUE;
+	if (vala_panel_netlink_read_events(&self->netlink, self->net))
+		return G_SOURCE_CONTINUE;
+	/* Reopen on next read */
+	self->netlink_watch = 0;
+	vala_panel_netlink_close(&self->netlink);
+	return G_SOURCE_REMOVE;
+}
+
+uint vala_panel_sampler_subscribe(ValaPanelSampler *self, ValaPanelSampleSource sources,
+                                  ValaPanelSamplerFunc func, gpointer user_data)
+{
+	g_return_val_if_fail(VALA_PANEL_IS_SAMPLER(self), 0);
+	g_return_val_if_fail(func != NULL, 0);
+	SamplerSubscriber sub = {
+		.id = ++self->last_id, .sources = sources, .func = func, .user_data = user_data
+	};
+	g_array_append_val(self->subscribers, sub);
+	sampler_update_task(self);
+	return sub.id;
+}
+
+void vala_panel_sampler_unsubscribe(ValaPanelSampler *self, uint id)
+{
+	g_return_if_fail(VALA_PANEL_IS_SAMPLER(self));
+	for (uint i = 0; i < self->subscribers->len; i++)
+	{
+		SamplerSubscriber *sub = &g_array_index(self->subscribers, SamplerSubscriber, i);
+		if (sub->id != id)
+			continue;
+		/* Do not shift the array under sampler_tick() */
+		if (self->dispatching)
+		{
+			sub->sources = VALA_PANEL_SAMPLE_NONE;
+			sub->func    = NULL;
+		}
+		else
+			g_array_remove_index(self->subscribers, i);
+		break;
+	}
+	sampler_update_task(self);
+}
+
+void vala_panel_sampler_set_paused(ValaPanelSampler *self, uint id, bool paused)
+{
+	g_return_if_fail(VALA_PANEL_IS_SAMPLER(self));
+	SamplerSubscriber *sub = NULL;
+	for (uint i = 0; i < self->subscribers->len && sub == NULL; i++)
+		if (g_array_index(self->subscribers, SamplerSubscriber, i).id == id)
+			sub = &g_array_index(self->subscribers, SamplerSubscriber, i);
+	if (sub == NULL || sub->func == NULL || sub->paused == paused)
+		return;
+	sub->paused = paused;
+	sampler_update_task(self);
+	/*
+	 * Catch up right away with one snapshot instead of waiting for next tick.
+	 * It covers the whole pause, as subscribers keep their previous sample.
+	 * Inside of dispatch the shared snapshot is in use, so next tick will do.
+	 */
+	if (paused || self->dispatching)
+		return;
+	ValaPanelSampleSource sources = sub->sources;
+	ValaPanelSamplerFunc func     = sub->func;
+	gpointer user_data            = sub->user_data;
+	sampler_read(self, sources);
+	if (sources & self->snapshot.valid)
+	{
+		self->dispatching = true;
+		func(&self->snapshot, user_data);
+		self->dispatching = false;
+		sampler_compact(self);
+	}
+}
+
+bool vala_panel_sampler_follow_visibility(ValaPanelSampler *self, uint id,
+                                          ValaPanelToplevel *toplevel)
+{
+	g_return_val_if_fail(VALA_PANEL_IS_SAMPLER(self), false);
+	g_return_val_if_fail(VALA_PANEL_IS_TOPLEVEL(toplevel), false);
+	bool paused = vala_panel_toplevel_get_visibility(toplevel) != VALA_PANEL_VISIBILITY_VISIBLE;
+	if (id != 0)
+		vala_panel_sampler_set_paused(self, id, paused);
+	return paused;
+}
+
+void vala_panel_sampler_set_fast(ValaPanelSampler *self, uint id, bool fast)
+{
+	g_return_if_fail(VALA_PANEL_IS_SAMPLER(self));
+	for (uint i = 0; i < self->subscribers->len; i++)
+	{
+		SamplerSubscriber *sub = &g_array_index(self->subscribers, SamplerSubscriber, i);
+		if (sub->id != id || sub->func == NULL || sub->fast == fast)
+			continue;
+		sub->fast = fast;
+		sampler_update_task(self);
+		break;
+	}
+}
+
+ValaPanelSampler *vala_panel_sampler_get_default()
+{
+	if (default_sampler != NULL)
+		return default_sampler;
+	/* Fixture trees, like those of bench/fixtures, let the whole panel run against them */
+	const char *sysfs_root   = g_getenv(SYSFS_ROOT_ENV);
+	const char *pressure_dir = g_getenv(PRESSURE_DIR_ENV);
+	default_sampler          = g_object_new(vala_panel_sampler_get_type(),
+	                                        "sysfs-root",
+	                                        sysfs_root != NULL ? sysfs_root : SYSFS_ROOT,
+	                                        "pressure-dir",
+	                                        pressure_dir != NULL ? pressure_dir : PRESSURE_DIR,
+	                                        NULL);
+	return default_sampler;
+}
+
+static void vala_panel_sampler_finalize(GObject *obj)
+{
+	ValaPanelSampler *self = VALA_PANEL_SAMPLER(obj);
+	if (self->task != 0)
+		vala_panel_scheduler_remove(vala_panel_scheduler_get_default(), self->task);
+	if (self->fast_timer != 0)
+		g_source_remove(self->fast_timer);
+	g_clear_pointer(&self->subscribers, g_array_unref);
+	close_netlink(self);
+	g_clear_pointer(&self->net, g_array_unref);
+	g_clear_pointer(&self->disks, g_array_unref);
+	g_clear_pointer(&self->cores, g_free);
+	for (uint r = 0; r < VALA_PANEL_PSI_N_RESOURCES; r++)
+		close_pressure(self, r);
+	g_clear_pointer(&self->pressure_dir, g_free);
+	vala_panel_sensors_close(&self->sensors);
+	close_power(self);
+	g_clear_pointer(&self->sysfs_root, g_free);
+	close_processes(self);
+	vala_panel_proc_file_close(&self->stat);
+	vala_panel_proc_file_close(&self->meminfo);
+	vala_panel_proc_file_close(&self->net_dev);
+	vala_panel_proc_file_close(&self->diskstats);
+	G_OBJECT_CLASS(vala_panel_sampler_parent_class)->finalize(obj);
+}
+
+static void vala_panel_sampler_init(ValaPanelSampler *self)
+{
+	self->subscribers       = g_array_new(false, true, sizeof(SamplerSubscriber));
+	self->net               = g_array_new(false, true, sizeof(ValaPanelNetSample));
+	self->disks             = g_array_new(false, true, sizeof(ValaPanelDiskSample));
+	self->stat.fd           = -1;
+	self->meminfo.fd        = -1;
+	self->net_dev.fd        = -1;
+	self->diskstats.fd      = -1;
+	self->netlink.fd        = -1;
+	self->netlink.events_fd = -1;
+	self->uevent_fd         = -1;
+	for (uint r = 0; r < VALA_PANEL_PSI_N_RESOURCES; r++)
+		self->pressure[r].fd = -1;
+}
+
+static void vala_panel_sampler_get_property(GObject *object, uint property_id, GValue *value,
+                                            GParamSpec *pspec)
+{
+	ValaPanelSampler *self = VALA_PANEL_SAMPLER(object);
+	switch (property_id)
+	{
+	case PROP_PRESSURE_DIR:
+		g_value_set_string(value, self->pressure_dir);
+		break;
+	case PROP_SYSFS_ROOT:
+		g_value_set_string(value, self->sysfs_root);
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+	}
+}
+
+static void vala_panel_sampler_set_property(GObject *object, uint property_id,
+                                            const GValue *value, GParamSpec *pspec)
+{
+	ValaPanelSampler *self = VALA_PANEL_SAMPLER(object);
+	switch (property_id)
+	{
+	case PROP_PRESSURE_DIR:
+		g_free(self->pressure_dir);
+		self->pressure_dir = g_value_dup_string(value);
+		break;
+	case PROP_SYSFS_ROOT:
+		g_free(self->sysfs_root);
+		self->sysfs_root = g_value_dup_string(value);
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+	}
+}
+
+static void vala_panel_sampler_class_init(ValaPanelSamplerClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS(klass);
+	object_class->set_property = vala_panel_sampler_set_property;
+	object_class->get_property = vala_panel_sampler_get_property;
+	object_class->finalize     = vala_panel_sampler_finalize;
+	/* Fixture directories stand in for /proc/pressure, see vala_panel_sampler_get_default() */
+	sampler_spec[PROP_PRESSURE_DIR] =
+	    g_param_spec_string("pressure-dir",
+	                        "",
+	                        "",
+	                        PRESSURE_DIR,
+	                        G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE |
+	                            G_PARAM_STATIC_STRINGS);
+	/* Same for cpufreq, hwmon, powercap and power_supply, in trees like bench/fixtures/sys */
+	sampler_spec[PROP_SYSFS_ROOT] =
+	    g_param_spec_string("sysfs-root",
+	                        "",
+	                        "",
+	                        SYSFS_ROOT,
+	                        G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE |
+	                            G_PARAM_STATIC_STRINGS);
+	g_object_class_install_properties(object_class, N_PROPERTIES, sampler_spec);
+}
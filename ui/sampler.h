@@ -0,0 +1,162 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <glib-object.h>
+#include <stdbool.h>
+
+#include "power.h"
+#include "procfs.h"
+#include "proctable.h"
+#include "sensors.h"
+#include "toplevel.h"
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+	VALA_PANEL_SAMPLE_NONE      = 0,
+	VALA_PANEL_SAMPLE_CPU       = 1 << 0,
+	VALA_PANEL_SAMPLE_MEM       = 1 << 1,
+	VALA_PANEL_SAMPLE_NET       = 1 << 2,
+	VALA_PANEL_SAMPLE_PRESSURE  = 1 << 3,
+	VALA_PANEL_SAMPLE_CPU_CORES = 1 << 4, /* Also provides VALA_PANEL_SAMPLE_CPU */
+	VALA_PANEL_SAMPLE_DISK      = 1 << 5,
+	VALA_PANEL_SAMPLE_SENSORS   = 1 << 6, /* CPU clocks and temperatures from sysfs */
+	VALA_PANEL_SAMPLE_PROCESSES = 1 << 7, /* Top consumers, from a background thread */
+	VALA_PANEL_SAMPLE_POWER     = 1 << 8, /* RAPL energy and battery discharge from sysfs */
+	VALA_PANEL_SAMPLE_CLOCK     = 1 << 9, /* Only ticks, for subscribers reading on their own */
+} ValaPanelSampleSource;
+
+typedef struct
+{
+	ValaPanelSampleSource valid;
+	gint64 time; /* Monotonic time of reading, in microseconds */
+	ValaPanelCpuSample cpu;
+	ValaPanelMemSample mem;
+	ValaPanelNetSample *net;
+	uint n_net;
+	guint net_digest;           /* vala_panel_net_digest() of net */
+	ValaPanelDiskSample *disks; /* Partitions and virtual devices included */
+	uint n_disks;
+	guint disk_digest;         /* vala_panel_disk_digest() of disks */
+	ValaPanelCpuSample *cores; /* Indexed by core number */
+	uint n_cores;
+	ValaPanelPsiSample pressure[VALA_PANEL_PSI_N_RESOURCES];
+	uint pressure_valid;        /* Bit per ValaPanelPsiResource */
+	ValaPanelFreqSample *freqs; /* Indexed by CPU number */
+	uint n_freqs;
+	ValaPanelTempSample *temps; /* Keep their places until a chip is hotplugged */
+	uint n_temps;
+	const ValaPanelProcTop *top; /* Latest pass over processes, a few seconds old at most */
+	ValaPanelPowerSample power;
+} ValaPanelSnapshot;
+
+/**
+ * vala_panel_snapshot_lookup_net:
+ * @self: a #ValaPanelSnapshot
+ * @iface: (not nullable): interface name
+ *
+ * Returns: (nullable) (transfer none): counters of @iface, or %NULL if it is absent
+ */
+const ValaPanelNetSample *vala_panel_snapshot_lookup_net(const ValaPanelSnapshot *self,
+                                                         const char *iface);
+
+typedef void (*ValaPanelSamplerFunc)(const ValaPanelSnapshot *snapshot, gpointer user_data);
+
+G_DECLARE_FINAL_TYPE(ValaPanelSampler, vala_panel_sampler, VALA_PANEL, SAMPLER, GObject)
+
+/**
+ * vala_panel_sampler_get_default:
+ *
+ * Process-wide sampler shared by all panels. It reads every requested source
+ * once per tick and hands the same snapshot to all subscribers, so subscribers
+ * must keep their own delta state. Ticks slip when the main loop is busy, so
+ * rates must be computed against the time of the snapshot, never per tick.
+ *
+ * Network counters come from route netlink when it is available, where
+ * link events keep the interface table current between ticks, and from
+ * /proc/net/dev otherwise.
+ *
+ * Pressure is also delivered out of tick, as soon as a kernel PSI trigger
+ * fires. Such snapshots carry only %VALA_PANEL_SAMPLE_PRESSURE. Likewise,
+ * kernel uevents of power supplies, like a charger being plugged in, bring
+ * snapshots with only %VALA_PANEL_SAMPLE_POWER.
+ *
+ * Processes are walked on a worker thread, in batches, so that thousands
+ * of them never stall the main loop. Ticks pick up its latest result, which
+ * is immutable and stays valid until the next tick.
+ *
+ * Environment variables VALA_PANEL_SYSFS_ROOT and VALA_PANEL_PRESSURE_DIR,
+ * when set at startup, replace /sys and /proc/pressure with fixture trees.
+ *
+ * Returns: (transfer none): the default #ValaPanelSampler
+ */
+ValaPanelSampler *vala_panel_sampler_get_default(void);
+/**
+ * vala_panel_sampler_subscribe:
+ * @self: a #ValaPanelSampler
+ * @sources: sources which @func is interested in
+ * @func: (scope forever): function called on every tick with fresh snapshot
+ * @user_data: (closure func): data for @func
+ *
+ * Returns: subscription id for vala_panel_sampler_unsubscribe()
+ */
+uint vala_panel_sampler_subscribe(ValaPanelSampler *self, ValaPanelSampleSource sources,
+                                  ValaPanelSamplerFunc func, gpointer user_data);
+void vala_panel_sampler_unsubscribe(ValaPanelSampler *self, uint id);
+/**
+ * vala_panel_sampler_set_paused:
+ * @self: a #ValaPanelSampler
+ * @id: subscription id
+ * @paused: whether subscription should stop receiving snapshots
+ *
+ * Paused subscriptions cost nothing: their sources are not read unless some
+ * other subscriber needs them. Resuming delivers one fresh snapshot at once.
+ */
+void vala_panel_sampler_set_paused(ValaPanelSampler *self, uint id, bool paused);
+/**
+ * vala_panel_sampler_follow_visibility:
+ * @self: a #ValaPanelSampler
+ * @id: subscription id, or 0 when there is none
+ * @toplevel: panel which shows the subscriber
+ *
+ * Pauses @id while @toplevel is not visible, as graphs are not looked at
+ * then. Meant to be called from notify::visibility of @toplevel.
+ *
+ * Returns: whether @id is paused now
+ */
+bool vala_panel_sampler_follow_visibility(ValaPanelSampler *self, uint id,
+                                          ValaPanelToplevel *toplevel);
+/**
+ * vala_panel_sampler_set_fast:
+ * @self: a #ValaPanelSampler
+ * @id: subscription id
+ * @fast: whether subscription should receive snapshots ten times per second
+ *
+ * Fast subscriptions are read on a timer of their own, which only runs while
+ * any of them is active. Sources shared with slow subscriptions are read at
+ * both rates, so slow subscribers still get exactly one snapshot per second.
+ */
+void vala_panel_sampler_set_fast(ValaPanelSampler *self, uint id, bool fast);
+
+G_END_DECLS
+
+#endif // SAMPLER_H
@@ -0,0 +1,240 @@
+/*
+ * vala-panel
+ * Copyright (C) 2015-2016 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scheduler.h"
+
+/* Wake up slightly after the boundary, so wall clock is already past it */
+#define SCHEDULER_LATENCY 1000 /* Microseconds */
+/* How late past its wakeup a timer may fire and still count as on time */
+#define SCHEDULER_JITTER 50000 /* Microseconds */
+/* Windows at least this wide are left to g_timeout_add_seconds(), which
+ * GLib coalesces with every other seconds timeout on the system */
+#define SCHEDULER_COARSE_WINDOW (2 * G_USEC_PER_SEC)
+
+typedef struct
+{
+	uint id;
+	uint period;    /* Seconds */
+	uint tolerance; /* Seconds */
+	gint64 due;     /* Wall clock time of next run */
+	guint64 wakeups;
+	ValaPanelSchedulerFunc func;
+	gpointer user_data;
+	GDestroyNotify notify;
+} SchedulerTask;
+
+struct _ValaPanelScheduler
+{
+	GObject __parent__;
+	GArray *tasks; /* Array of SchedulerTask */
+	guint64 wakeups;
+	uint last_id;
+	uint timer;
+	bool dispatching;
+};
+
+G_DEFINE_TYPE(ValaPanelScheduler, vala_panel_scheduler, G_TYPE_OBJECT)
+
+static ValaPanelScheduler *default_scheduler = NULL;
+
+/* First boundary of period strictly after time */
+static gint64 scheduler_next_boundary(gint64 time, uint period)
+{
+	gint64 step = (gint64)period * G_USEC_PER_SEC;
+	return (time / step + 1) * step;
+}
+
+/* Wall clock stepped back by more than a period, so the deadline would only
+ * be reached after the step is caught up: move it to the next boundary */
+static void scheduler_realign(SchedulerTask *task, gint64 now)
+{
+	if (task->due - now > (gint64)task->period * G_USEC_PER_SEC)
+		task->due = scheduler_next_boundary(now, task->period);
+}
+
+/* Kept under half a period, so a delayed run never lands in the window of the next one */
+static inline gint64 scheduler_slack(const SchedulerTask *task)
+{
+	return MIN((gint64)task->tolerance * G_USEC_PER_SEC,
+	           (gint64)task->period * G_USEC_PER_SEC / 2);
+}
+
+static int scheduler_tick(void *data);
+
+/* Wake up at the latest time which still satisfies every task, so tasks
+ * with tolerance join wakeups of more urgent ones */
+static void scheduler_rearm(ValaPanelScheduler *self)
+{
+	gint64 now      = g_get_real_time();
+	gint64 earliest = G_MAXINT64;
+	gint64 wakeup   = G_MAXINT64;
+	for (uint i = 0; i < self->tasks->len; i++)
+	{
+		SchedulerTask *task = &g_array_index(self->tasks, SchedulerTask, i);
+		if (task->func == NULL)
+			continue;
+		scheduler_realign(task, now);
+		earliest = MIN(earliest, task->due);
+		wakeup   = MIN(wakeup, task->due + scheduler_slack(task));
+	}
+	if (self->timer != 0)
+		g_source_remove(self->timer);
+	self->timer = 0;
+	if (wakeup == G_MAXINT64)
+		return;
+	/* Seconds timeouts fire up to a second late, so aim one second early */
+	if (wakeup - earliest >= SCHEDULER_COARSE_WINDOW && wakeup - now >= SCHEDULER_COARSE_WINDOW)
+	{
+		uint seconds = (uint)((wakeup - now) / G_USEC_PER_SEC) - 1;
+		self->timer  = g_timeout_add_seconds(seconds, scheduler_tick, self);
+		return;
+	}
+	gint64 delay = MAX(wakeup - now, 0) + SCHEDULER_LATENCY;
+	self->timer  = g_timeout_add((uint)((delay + 999) / 1000), scheduler_tick, self);
+}
+
+static void scheduler_compact(ValaPanelScheduler *self)
+{
+	for (uint i = self->tasks->len; i > 0; i--)
+		if (g_array_index(self->tasks, SchedulerTask, i - 1).func == NULL)
+			g_array_remove_index(self->tasks, i - 1);
+}
+
+static int scheduler_tick(void *data)
+{
+	ValaPanelScheduler *self = VALA_PANEL_SCHEDULER(data);
+	gint64 now               = g_get_real_time();
+	self->timer              = 0;
+	self->wakeups++;
+
+	/* Run every task whose window is open, tasks added from callbacks wait */
+	uint len          = self->tasks->len;
+	self->dispatching = true;
+	for (uint i = 0; i < len; i++)
+	{
+		SchedulerTask *task = &g_array_index(self->tasks, SchedulerTask, i);
+		if (task->func == NULL)
+			continue;
+		scheduler_realign(task, now);
+		if (task->due > now + SCHEDULER_LATENCY)
+			continue;
+		/* Late within slack keeps cadence, a window missed entirely is skipped */
+		gint64 late = now - task->due;
+		if (late <= scheduler_slack(task) + SCHEDULER_JITTER)
+			task->due = scheduler_next_boundary(task->due, task->period);
+		else
+			task->due = scheduler_next_boundary(now, task->period);
+		task->wakeups++;
+		task->func(task->user_data);
+	}
+	self->dispatching = false;
+	scheduler_compact(self);
+	scheduler_rearm(self);
+	return G_SOURCE_REMOVE;
+}
+
+uint vala_panel_scheduler_add(ValaPanelScheduler *self, uint period, uint tolerance,
+                              ValaPanelSchedulerFunc func, gpointer user_data,
+                              GDestroyNotify notify)
+{
+	g_return_val_if_fail(VALA_PANEL_IS_SCHEDULER(self), 0);
+	g_return_val_if_fail(func != NULL, 0);
+	g_return_val_if_fail(period > 0, 0);
+	SchedulerTask task = { 0 };
+	task.id            = ++self->last_id;
+	task.period        = period;
+	task.tolerance     = tolerance;
+	task.due           = scheduler_next_boundary(g_get_real_time(), period);
+	task.func          = func;
+	task.user_data     = user_data;
+	task.notify        = notify;
+	g_array_append_val(self->tasks, task);
+	/* Tick rearms itself when it is done */
+	if (!self->dispatching)
+		scheduler_rearm(self);
+	return task.id;
+}
+
+void vala_panel_scheduler_remove(ValaPanelScheduler *self, uint id)
+{
+	g_return_if_fail(VALA_PANEL_IS_SCHEDULER(self));
+	for (uint i = 0; i < self->tasks->len; i++)
+	{
+		SchedulerTask *task = &g_array_index(self->tasks, SchedulerTask, i);
+		if (task->id != id || task->func == NULL)
+			continue;
+		GDestroyNotify notify = task->notify;
+		gpointer user_data    = task->user_data;
+		/* Do not shift the array under scheduler_tick() */
+		task->func = NULL;
+		if (!self->dispatching)
+			g_array_remove_index(self->tasks, i);
+		if (notify != NULL)
+			notify(user_data);
+		break;
+	}
+	if (!self->dispatching)
+		scheduler_rearm(self);
+}
+
+guint64 vala_panel_scheduler_get_wakeups(ValaPanelScheduler *self, uint id)
+{
+	g_return_val_if_fail(VALA_PANEL_IS_SCHEDULER(self), 0);
+	if (id == 0)
+		return self->wakeups;
+	for (uint i = 0; i < self->tasks->len; i++)
+	{
+		SchedulerTask *task = &g_array_index(self->tasks, SchedulerTask, i);
+		if (task->id == id && task->func != NULL)
+			return task->wakeups;
+	}
+	return 0;
+}
+
+ValaPanelScheduler *vala_panel_scheduler_get_default()
+{
+	if (default_scheduler == NULL)
+		default_scheduler =
+		    VALA_PANEL_SCHEDULER(g_object_new(vala_panel_scheduler_get_type(), NULL));
+	return default_scheduler;
+}
+
+static void vala_panel_scheduler_finalize(GObject *obj)
+{
+	ValaPanelScheduler *self = VALA_PANEL_SCHEDULER(obj);
+	if (self->timer != 0)
+		g_source_remove(self->timer);
+	for (uint i = 0; i < self->tasks->len; i++)
+	{
+		SchedulerTask *task = &g_array_index(self->tasks, SchedulerTask, i);
+		if (task->func != NULL && task->notify != NULL)
+			task->notify(task->user_data);
+	}
+	g_clear_pointer(&self->tasks, g_array_unref);
+	G_OBJECT_CLASS(vala_panel_scheduler_parent_class)->finalize(obj);
+}
+
+static void vala_panel_scheduler_init(ValaPanelScheduler *self)
+{
+	self->tasks = g_array_new(false, true, sizeof(SchedulerTask));
+}
+
+static void vala_panel_scheduler_class_init(ValaPanelSchedulerClass *klass)
+{
+	G_OBJECT_CLASS(klass)->finalize = vala_panel_scheduler_finalize;
+}
@@ -0,0 +1,69 @@
+/*
+ * vala-panel
+ * Copyright (C) 2015-2016 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <glib-object.h>
+#include <stdbool.h>
+
+G_BEGIN_DECLS
+
+typedef void (*ValaPanelSchedulerFunc)(gpointer user_data);
+
+G_DECLARE_FINAL_TYPE(ValaPanelScheduler, vala_panel_scheduler, VALA_PANEL, SCHEDULER, GObject)
+
+/**
+ * vala_panel_scheduler_get_default:
+ *
+ * Process-wide scheduler for periodic applet work. Every task runs on wall
+ * clock boundaries which are multiples of its period, and tasks which are
+ * due together share one wakeup.
+ *
+ * Returns: (transfer none): the default #ValaPanelScheduler
+ */
+ValaPanelScheduler *vala_panel_scheduler_get_default(void);
+/**
+ * vala_panel_scheduler_add:
+ * @self: a #ValaPanelScheduler
+ * @period: period in seconds, 60 aligns to minute boundaries
+ * @tolerance: how many seconds @func may be delayed to share a wakeup, at most half
+ *   of @period is used
+ * @func: (scope notified): function to call every @period
+ * @user_data: (closure func): data for @func
+ * @notify: (destroy user_data): called when the task is removed
+ *
+ * Returns: task id for vala_panel_scheduler_remove()
+ */
+uint vala_panel_scheduler_add(ValaPanelScheduler *self, uint period, uint tolerance,
+                              ValaPanelSchedulerFunc func, gpointer user_data,
+                              GDestroyNotify notify);
+void vala_panel_scheduler_remove(ValaPanelScheduler *self, uint id);
+/**
+ * vala_panel_scheduler_get_wakeups:
+ * @self: a #ValaPanelScheduler
+ * @id: task id, or 0 for the scheduler itself
+ *
+ * Returns: how many times task @id was run, or how many times scheduler
+ * woke up if @id is 0
+ */
+guint64 vala_panel_scheduler_get_wakeups(ValaPanelScheduler *self, uint id);
+
+G_END_DECLS
+
+#endif // SCHEDULER_H
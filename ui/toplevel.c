@@ -90,6 +90,7 @@ enum
 	TOP_STRUT,
 	TOP_IS_DYNAMIC,
 	TOP_AUTOHIDE,
+	TOP_VISIBILITY,
 	TOP_LAST
 };
 static GParamSpec *top_specs[TOP_LAST];
@@ -100,6 +101,9 @@ struct _ValaPanelToplevel
 	ValaPanelLayout *layout;
 	GtkRevealer *ah_rev;
 	PanelAutohideState ah_state;
+	uint ah_timer; /* Pending hide, at most one */
+	ValaPanelVisibility visibility;
+	bool obscured; /* Last visibility-notify said fully obscured */
 	ValaPanelUnitSettings *settings;
 	GtkCssProvider *provider;
 	bool initialized;
@@ -173,6 +177,11 @@ static void stop_ui(ValaPanelToplevel *self)
 static void vala_panel_toplevel_destroy(GObject *base)
 {
 	ValaPanelToplevel *self = VALA_PANEL_TOPLEVEL(base);
+	if (self->ah_timer != 0)
+	{
+		g_source_remove(self->ah_timer);
+		self->ah_timer = 0;
+	}
 	stop_ui(self);
 	G_OBJECT_CLASS(vala_panel_toplevel_parent_class)->dispose(base);
 }
@@ -196,7 +205,7 @@ static void start_ui(ValaPanelToplevel *self)
 	gtk_window_set_application(GTK_WINDOW(self), gtk_window_get_application(GTK_WINDOW(self)));
 	gtk_widget_add_events(GTK_WIDGET(self),
 	                      GDK_BUTTON_PRESS_MASK | GDK_ENTER_NOTIFY_MASK |
-	                          GDK_LEAVE_NOTIFY_MASK);
+	                          GDK_LEAVE_NOTIFY_MASK | GDK_VISIBILITY_NOTIFY_MASK);
 	gtk_widget_realize(GTK_WIDGET(self));
 	self->ah_rev = GTK_REVEALER(gtk_revealer_new());
 	self->layout = vp_layout_new(VALA_PANEL_TOPLEVEL(self),
@@ -785,30 +794,86 @@ void vala_panel_toplevel_update_visibility(ValaPanelToplevel *panel, int mons)
 		vala_panel_toplevel_update_geometry(panel);
 	}
 }
+/****************************************************
+ *         visibility                               *
+ ****************************************************/
+static void update_visibility_state(ValaPanelToplevel *self)
+{
+	ValaPanelVisibility visibility = VALA_PANEL_VISIBILITY_VISIBLE;
+	if (!gtk_widget_get_mapped(GTK_WIDGET(self)) ||
+	    (self->autohide && self->ah_state == AH_HIDDEN))
+		visibility = VALA_PANEL_VISIBILITY_HIDDEN;
+	else if (self->obscured)
+		visibility = VALA_PANEL_VISIBILITY_OBSCURED;
+	if (visibility == self->visibility)
+		return;
+	self->visibility = visibility;
+	g_object_notify_by_pspec(G_OBJECT(self), top_specs[TOP_VISIBILITY]);
+}
+
+ValaPanelVisibility vala_panel_toplevel_get_visibility(ValaPanelToplevel *self)
+{
+	g_return_val_if_fail(VALA_PANEL_IS_TOPLEVEL(self), VALA_PANEL_VISIBILITY_HIDDEN);
+	return self->visibility;
+}
+
+static void map(GtkWidget *w)
+{
+	GTK_WIDGET_CLASS(vala_panel_toplevel_parent_class)->map(w);
+	update_visibility_state(VALA_PANEL_TOPLEVEL(w));
+}
+
+static void unmap(GtkWidget *w)
+{
+	ValaPanelToplevel *self = VALA_PANEL_TOPLEVEL(w);
+	GTK_WIDGET_CLASS(vala_panel_toplevel_parent_class)->unmap(w);
+	/* Unmapped window gets no more visibility events, so start unobscured next time */
+	self->obscured = false;
+	update_visibility_state(self);
+}
+
+/* Only plain X servers send these. Compositing managers and Wayland keep every window
+ * unobscured, there a fullscreen window over the panel does not pause sampling,
+ * only autohide and unmapping do */
+static int visibility_notify_event(GtkWidget *w, GdkEventVisibility *event)
+{
+	ValaPanelToplevel *self = VALA_PANEL_TOPLEVEL(w);
+	self->obscured          = event->state == GDK_VISIBILITY_FULLY_OBSCURED;
+	update_visibility_state(self);
+	return false;
+}
+
 /****************************************************
  *         autohide : new version                   *
  ****************************************************/
 static uint timeout_func(ValaPanelToplevel *self)
 {
+	self->ah_timer = 0;
 	if (self->autohide && self->ah_state == AH_WAITING)
 	{
 		vala_panel_style_class_toggle(GTK_WIDGET(self), "-panel-transparent", true);
 		gtk_revealer_set_reveal_child(self->ah_rev, false);
 		vala_panel_toplevel_update_geometry_no_orient(self);
 		self->ah_state = AH_HIDDEN;
-		return G_SOURCE_REMOVE;
+		update_visibility_state(self);
 	}
-	return G_SOURCE_CONTINUE;
+	return G_SOURCE_REMOVE;
 }
 
 static void ah_show(ValaPanelToplevel *self)
 {
 	if (self->ah_state >= AH_GRAB)
 		return;
+	if (self->ah_timer != 0)
+	{
+		g_source_remove(self->ah_timer);
+		self->ah_timer = 0;
+	}
 	vala_panel_style_class_toggle(GTK_WIDGET(self), "-panel-transparent", false);
 	gtk_revealer_set_reveal_child(self->ah_rev, true);
 	vala_panel_toplevel_update_geometry_no_orient(self);
 	self->ah_state = AH_VISIBLE;
+	update_visibility_state(self);
 }
 
 static void ah_hide(ValaPanelToplevel *self)
@@ -816,7 +881,11 @@ static void ah_hide(ValaPanelToplevel *self)
 	if (self->ah_state <= AH_GRAB)
 		return;
 	self->ah_state = AH_WAITING;
-	g_timeout_add_full(G_PRIORITY_HIGH, PERIOD, (GSourceFunc)timeout_func, self, NULL);
+	/* Keep at most one pending hide, ah_show() cancels it */
+	if (self->ah_timer != 0)
+		g_source_remove(self->ah_timer);
+	self->ah_timer =
+	    g_timeout_add_full(G_PRIORITY_HIGH, PERIOD, (GSourceFunc)timeout_func, self, NULL);
 }
 
 static int enter_notify_event(GtkWidget *w, G_GNUC_UNUSED GdkEventCrossing *event)
@@ -937,6 +1006,9 @@ static void vala_panel_toplevel_get_property(GObject *object, guint property_id,
 	case TOP_AUTOHIDE:
 		g_value_set_boolean(value, self->autohide);
 		break;
+	case TOP_VISIBILITY:
+		g_value_set_enum(value, self->visibility);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
 		break;
@@ -1072,6 +1144,7 @@ static void vala_panel_toplevel_set_property(GObject *object, guint property_id,
 			else
 				ah_show(self);
 		}
+		update_visibility_state(self);
 		geometry_update_required = true;
 		break;
 	default:
@@ -1095,6 +1168,7 @@ void vala_panel_toplevel_init(ValaPanelToplevel *self)
 	self->background_file = g_strdup("");
 	self->context_menu    = NULL;
 	self->ah_state        = AH_VISIBLE; // We starts as Visible to init autohide chain properly
+	self->visibility      = VALA_PANEL_VISIBILITY_HIDDEN; // Until mapped
 }
 
 void vala_panel_toplevel_class_init(ValaPanelToplevelClass *klass)
@@ -1109,6 +1183,9 @@ void vala_panel_toplevel_class_init(ValaPanelToplevelClass *klass)
 	GTK_WIDGET_CLASS(klass)->get_preferred_width_for_height = get_preferred_width_for_height;
 	GTK_WIDGET_CLASS(klass)->get_request_mode               = get_request_mode;
 	GTK_WIDGET_CLASS(klass)->grab_notify                    = grab_notify;
+	GTK_WIDGET_CLASS(klass)->map                            = map;
+	GTK_WIDGET_CLASS(klass)->unmap                          = unmap;
+	GTK_WIDGET_CLASS(klass)->visibility_notify_event        = visibility_notify_event;
 	oclass->set_property                                    = vala_panel_toplevel_set_property;
 	oclass->get_property                                    = vala_panel_toplevel_get_property;
 	oclass->dispose                                         = vala_panel_toplevel_destroy;
@@ -1270,6 +1347,13 @@ void vala_panel_toplevel_class_init(ValaPanelToplevelClass *klass)
 	                         VALA_PANEL_KEY_AUTOHIDE,
 	                         FALSE,
 	                         (GParamFlags)(G_PARAM_STATIC_STRINGS | G_PARAM_READWRITE));
+	top_specs[TOP_VISIBILITY] =
+	    g_param_spec_enum(VALA_PANEL_KEY_VISIBILITY,
+	                      VALA_PANEL_KEY_VISIBILITY,
+	                      VALA_PANEL_KEY_VISIBILITY,
+	                      vala_panel_visibility_get_type(),
+	                      VALA_PANEL_VISIBILITY_HIDDEN,
+	                      (GParamFlags)(G_PARAM_STATIC_STRINGS | G_PARAM_READABLE));
 
 	g_object_class_install_properties(oclass, TOP_LAST, top_specs);
 }
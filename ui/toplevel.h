@@ -29,6 +29,23 @@
 
 G_BEGIN_DECLS
 
+/**
+ * ValaPanelVisibility:
+ * @VALA_PANEL_VISIBILITY_VISIBLE: panel is on screen
+ * @VALA_PANEL_VISIBILITY_HIDDEN: panel is unmapped or collapsed by autohide
+ * @VALA_PANEL_VISIBILITY_OBSCURED: panel is mapped, but fully covered by other windows.
+ *   Only reported on X11 without a compositing manager.
+ *
+ * Applets may skip their periodic work while panel is not visible and
+ * refresh once when it becomes visible again.
+ */
+typedef enum
+{
+	VALA_PANEL_VISIBILITY_VISIBLE  = 0,
+	VALA_PANEL_VISIBILITY_HIDDEN   = 1,
+	VALA_PANEL_VISIBILITY_OBSCURED = 2,
+} ValaPanelVisibility;
+
 G_DECLARE_FINAL_TYPE(ValaPanelToplevel, vala_panel_toplevel, VALA_PANEL, TOPLEVEL,
                      GtkApplicationWindow)
 
@@ -46,6 +63,7 @@ void vala_panel_toplevel_configure(ValaPanelToplevel *self, const char *page);
 void vala_panel_toplevel_configure_applet(ValaPanelToplevel *self, const char *uuid);
 void vala_panel_toplevel_get_menu_anchors(ValaPanelToplevel *self, GdkGravity *menu_anchor,
                                           GdkGravity *widget_anchor);
+ValaPanelVisibility vala_panel_toplevel_get_visibility(ValaPanelToplevel *self);
 G_END_DECLS
 
 #endif // TOPLEVEL_H
@@ -10,6 +10,8 @@ G_BEGIN_DECLS
 #include "applet-info.h"
 #include "applet-widget-api.h"
 #include "definitions.h"
+#include "sampler.h"
+#include "scheduler.h"
 #include "util-gtk.h"
 #include "panel-platform.h"
 #include "settings-manager.h"
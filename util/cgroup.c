@@ -0,0 +1,134 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "cgroup.h"
+
+#define CGROUP_ROOT "/sys/fs/cgroup"
+#define CGROUP_BUFFER_SIZE 512 /* Holds cpu.stat of current kernels, grows for longer ones */
+
+enum
+{
+	CGROUP_MEMORY_CURRENT = 0,
+	CGROUP_MEMORY_MAX,
+	CGROUP_MEMORY_EVENTS,
+	CGROUP_CPU_STAT,
+	CGROUP_CPU_MAX,
+};
+
+static const char *cgroup_files[VALA_PANEL_CGROUP_N_FILES] = {
+	"memory.current", "memory.max", "memory.events", "cpu.stat", "cpu.max",
+};
+
+/* Unified hierarchy is the "0::" line of /proc/self/cgroup */
+static char *cgroup_self(void)
+{
+	g_autofree char *contents = NULL;
+	if (!g_file_get_contents("/proc/self/cgroup", &contents, NULL, NULL))
+		return NULL;
+	g_auto(GStrv) lines = g_strsplit(contents, "\n", 0);
+	for (uint i = 0; lines[i] != NULL; i++)
+		if (g_str_has_prefix(lines[i], "0::"))
+			return g_strdup(lines[i] + 3);
+	return NULL;
+}
+
+bool vala_panel_cgroup_open(ValaPanelCgroup *self, const char *cgroup)
+{
+	g_autofree char *own = NULL;
+	if (!g_strcmp0(cgroup, VALA_PANEL_CGROUP_SELF) && (cgroup = own = cgroup_self()) == NULL)
+		return false;
+	g_autofree char *path = g_str_has_prefix(cgroup, CGROUP_ROOT "/")
+	                            ? g_strdup(cgroup)
+	                            : g_build_filename(CGROUP_ROOT, cgroup, NULL);
+	/* Present in every cgroup v2 directory, and only there */
+	g_autofree char *controllers = g_build_filename(path, "cgroup.controllers", NULL);
+	if (!g_file_test(controllers, G_FILE_TEST_EXISTS))
+		return false;
+	for (uint i = 0; i < VALA_PANEL_CGROUP_N_FILES; i++)
+	{
+		g_autofree char *file = g_build_filename(path, cgroup_files[i], NULL);
+		self->files[i].fd     = -1;
+		vala_panel_proc_file_open(&self->files[i], file, CGROUP_BUFFER_SIZE, true);
+	}
+	self->path = g_steal_pointer(&path);
+	return true;
+}
+
+static inline bool read_file(ValaPanelCgroup *self, uint file)
+{
+	return self->files[file].fd >= 0 && vala_panel_proc_file_read(&self->files[file]);
+}
+
+static ValaPanelCgroupSource read_memory(ValaPanelCgroup *self, ValaPanelCgroupSample *sample)
+{
+	ValaPanelCgroupSource sources = VALA_PANEL_CGROUP_NONE;
+	ValaPanelProcFile *files      = self->files;
+	if (read_file(self, CGROUP_MEMORY_CURRENT) &&
+	    vala_panel_proc_parse_limit(files[CGROUP_MEMORY_CURRENT].buf,
+	                                files[CGROUP_MEMORY_CURRENT].len,
+	                                &sample->memory_current))
+		sources |= VALA_PANEL_CGROUP_MEMORY;
+	if (read_file(self, CGROUP_MEMORY_MAX))
+		vala_panel_proc_parse_limit(files[CGROUP_MEMORY_MAX].buf,
+		                            files[CGROUP_MEMORY_MAX].len,
+		                            &sample->memory_max);
+	if (read_file(self, CGROUP_MEMORY_EVENTS))
+		vala_panel_proc_parse_memory_events(files[CGROUP_MEMORY_EVENTS].buf,
+		                                    files[CGROUP_MEMORY_EVENTS].len,
+		                                    sample);
+	return sources;
+}
+
+static ValaPanelCgroupSource read_cpu(ValaPanelCgroup *self, ValaPanelCgroupSample *sample)
+{
+	ValaPanelCgroupSource sources = VALA_PANEL_CGROUP_NONE;
+	ValaPanelProcFile *files      = self->files;
+	/* Basic usage is there even without cpu controller, only throttling needs it */
+	if (read_file(self, CGROUP_CPU_STAT) &&
+	    vala_panel_proc_parse_cpu_stat(files[CGROUP_CPU_STAT].buf,
+	                                   files[CGROUP_CPU_STAT].len,
+	                                   sample))
+		sources |= VALA_PANEL_CGROUP_CPU;
+	if (read_file(self, CGROUP_CPU_MAX))
+		vala_panel_proc_parse_cpu_max(files[CGROUP_CPU_MAX].buf,
+		                              files[CGROUP_CPU_MAX].len,
+		                              &sample->cpu_limit);
+	return sources;
+}
+
+ValaPanelCgroupSource vala_panel_cgroup_read(ValaPanelCgroup *self, ValaPanelCgroupSource wanted,
+                                             ValaPanelCgroupSample *sample)
+{
+	ValaPanelCgroupSource sources = VALA_PANEL_CGROUP_NONE;
+	memset(sample, 0, sizeof(ValaPanelCgroupSample));
+	sample->memory_max = G_MAXUINT64;
+	if (wanted & VALA_PANEL_CGROUP_MEMORY)
+		sources |= read_memory(self, sample);
+	if (wanted & VALA_PANEL_CGROUP_CPU)
+		sources |= read_cpu(self, sample);
+	return sources;
+}
+
+void vala_panel_cgroup_close(ValaPanelCgroup *self)
+{
+	for (uint i = 0; self->path != NULL && i < VALA_PANEL_CGROUP_N_FILES; i++)
+		vala_panel_proc_file_close(&self->files[i]);
+	g_clear_pointer(&self->path, g_free);
+}
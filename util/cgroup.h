@@ -0,0 +1,74 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CGROUP_H
+#define CGROUP_H
+
+#include <glib.h>
+#include <stdbool.h>
+
+#include "procfs.h"
+
+G_BEGIN_DECLS
+
+#define VALA_PANEL_CGROUP_SELF "self" /* Cgroup which the panel itself runs in */
+#define VALA_PANEL_CGROUP_N_FILES 5
+
+/* Sources which a cgroup sample has */
+typedef enum
+{
+	VALA_PANEL_CGROUP_NONE   = 0,
+	VALA_PANEL_CGROUP_MEMORY = 1 << 0, /* Memory controller is enabled */
+	VALA_PANEL_CGROUP_CPU    = 1 << 1,
+} ValaPanelCgroupSource;
+
+/*
+ * Files of one cgroup v2 directory, kept open and reread in place like
+ * other ValaPanelProcFile users, so a tick costs a pread() per file.
+ * Files of controllers which are not enabled for the cgroup stay closed.
+ */
+typedef struct
+{
+	char *path; /* Directory, under the cgroup2 mount */
+	ValaPanelProcFile files[VALA_PANEL_CGROUP_N_FILES];
+} ValaPanelCgroup;
+
+/**
+ * vala_panel_cgroup_open:
+ * @self: cgroup to open
+ * @cgroup: %VALA_PANEL_CGROUP_SELF, or a path like "/user.slice/user-1000.slice",
+ * either relative to the cgroup2 mount or including it
+ *
+ * Returns: %FALSE if there is no such cgroup v2 directory, then @self stays closed
+ */
+bool vala_panel_cgroup_open(ValaPanelCgroup *self, const char *cgroup);
+/**
+ * vala_panel_cgroup_read:
+ * @self: open cgroup
+ * @wanted: sources to read, files of others are not touched
+ * @sample: (out caller-allocates): counters, fields of missing sources are zero
+ *
+ * Returns: sources which were read
+ */
+ValaPanelCgroupSource vala_panel_cgroup_read(ValaPanelCgroup *self, ValaPanelCgroupSource wanted,
+                                             ValaPanelCgroupSample *sample);
+void vala_panel_cgroup_close(ValaPanelCgroup *self);
+
+G_END_DECLS
+
+#endif // CGROUP_H
@@ -0,0 +1,219 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gio/gio.h>
+#include <math.h>
+#include <signal.h>
+#include <string.h>
+
+#include "childstream.h"
+
+#define STREAM_BUFFER_SIZE 4096 /* Longest line kept, longer ones are skipped */
+#define STREAM_MIN_BACKOFF 1    /* Seconds */
+#define STREAM_MAX_BACKOFF 60
+
+struct _ValaPanelChildStream
+{
+	char *command;
+	GStrv argv;
+	ValaPanelChildStreamFunc func;
+	gpointer user_data;
+	GSubprocess *process;
+	GCancellable *cancellable; /* Of waiting for exit, while child runs */
+	GSource *source;           /* Readable stdout, until end of file */
+	uint restart;              /* Timeout, while child waits to be started again */
+	uint backoff;              /* Seconds before next start */
+	bool sampled;              /* Child printed some sample */
+	bool overlong;             /* Rest of a too long line is skipped */
+	size_t len;
+	char buf[STREAM_BUFFER_SIZE];
+};
+
+static void stream_spawn(ValaPanelChildStream *self);
+
+/*
+ * Parsing
+ */
+
+static void stream_line(ValaPanelChildStream *self, const char *line, gint64 time)
+{
+	char *end;
+	double value = g_ascii_strtod(line, &end);
+	if (end == line || !isfinite(value))
+		return;
+	self->sampled = true;
+	self->func(value, time, self->user_data);
+}
+
+/* Splits complete lines, a partial one stays at start of buffer for the next read */
+static void stream_parse(ValaPanelChildStream *self, size_t len, gint64 time)
+{
+	char *start = self->buf;
+	char *end   = self->buf + self->len + len;
+	char *nl;
+	while ((nl = memchr(start, '\n', (size_t)(end - start))) != NULL)
+	{
+		*nl = '\0';
+		if (!self->overlong)
+			stream_line(self, start, time);
+		self->overlong = false;
+		start          = nl + 1;
+	}
+	self->len = (size_t)(end - start);
+	if (self->len == sizeof(self->buf))
+	{
+		self->overlong = true;
+		self->len      = 0;
+	}
+	else
+		memmove(self->buf, start, self->len);
+}
+
+/*
+ * Child
+ */
+
+static gboolean stream_readable(GObject *pollable, gpointer data)
+{
+	ValaPanelChildStream *self = (ValaPanelChildStream *)data;
+	g_autoptr(GError) error    = NULL;
+	/* Source fires only when there is data, so this read never has to wait */
+	gssize res = g_pollable_input_stream_read_nonblocking(G_POLLABLE_INPUT_STREAM(pollable),
+	                                                      self->buf + self->len,
+	                                                      sizeof(self->buf) - self->len,
+	                                                      NULL,
+	                                                      &error);
+	if (res < 0 && g_error_matches(error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+		return G_SOURCE_CONTINUE;
+	if (res > 0)
+	{
+		stream_parse(self, (size_t)res, g_get_monotonic_time());
+		return G_SOURCE_CONTINUE;
+	}
+	/* End of file, exit of child starts it again */
+	g_clear_pointer(&self->source, g_source_unref);
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean stream_restart(gpointer data)
+{
+	ValaPanelChildStream *self = (ValaPanelChildStream *)data;
+	self->restart              = 0;
+	stream_spawn(self);
+	return G_SOURCE_REMOVE;
+}
+
+static void stream_schedule_restart(ValaPanelChildStream *self)
+{
+	if (self->sampled)
+		self->backoff = STREAM_MIN_BACKOFF;
+	self->restart = g_timeout_add_seconds(self->backoff, stream_restart, self);
+	self->backoff = MIN(self->backoff * 2, STREAM_MAX_BACKOFF);
+}
+
+static void stream_exited(GObject *process, GAsyncResult *res, gpointer data)
+{
+	g_autoptr(GError) error = NULL;
+	/* Stream is already freed then */
+	if (!g_subprocess_wait_finish(G_SUBPROCESS(process), res, &error) &&
+	    g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		return;
+	ValaPanelChildStream *self = (ValaPanelChildStream *)data;
+	g_debug("childstream: %s exited with status %d, restarting in %us",
+	        self->command,
+	        g_subprocess_get_status(G_SUBPROCESS(process)),
+	        self->sampled ? STREAM_MIN_BACKOFF : self->backoff);
+	/* Stdout source is kept, samples still in the pipe are read before restart */
+	g_clear_object(&self->cancellable);
+	g_clear_object(&self->process);
+	stream_schedule_restart(self);
+}
+
+static void stream_close_child(ValaPanelChildStream *self)
+{
+	if (self->source != NULL)
+		g_source_destroy(self->source);
+	g_clear_pointer(&self->source, g_source_unref);
+	if (self->cancellable != NULL)
+		g_cancellable_cancel(self->cancellable);
+	g_clear_object(&self->cancellable);
+	if (self->process != NULL)
+		g_subprocess_send_signal(self->process, SIGTERM);
+	g_clear_object(&self->process);
+}
+
+static void stream_spawn(ValaPanelChildStream *self)
+{
+	g_autoptr(GError) error = NULL;
+	stream_close_child(self);
+	self->len      = 0;
+	self->overlong = false;
+	self->sampled  = false;
+	self->process  = g_subprocess_newv((const char *const *)self->argv,
+	                                  G_SUBPROCESS_FLAGS_STDOUT_PIPE,
+	                                  &error);
+	if (self->process == NULL)
+	{
+		g_warning("childstream: %s", error->message);
+		stream_schedule_restart(self);
+		return;
+	}
+	/* Pipe is a GUnixInputStream, which is pollable */
+	GInputStream *out = g_subprocess_get_stdout_pipe(self->process);
+	self->source = g_pollable_input_stream_create_source(G_POLLABLE_INPUT_STREAM(out), NULL);
+	g_source_set_callback(self->source, (GSourceFunc)stream_readable, self, NULL);
+	g_source_attach(self->source, NULL);
+	self->cancellable = g_cancellable_new();
+	g_subprocess_wait_async(self->process, self->cancellable, stream_exited, self);
+}
+
+/*
+ * Stream
+ */
+
+ValaPanelChildStream *vala_panel_child_stream_start(const char *command,
+                                                    ValaPanelChildStreamFunc func,
+                                                    gpointer user_data, GError **error)
+{
+	GStrv argv = NULL;
+	if (!g_shell_parse_argv(command, NULL, &argv, error))
+		return NULL;
+	ValaPanelChildStream *self = g_new0(ValaPanelChildStream, 1);
+	self->command              = g_strdup(command);
+	self->argv                 = argv;
+	self->func                 = func;
+	self->user_data            = user_data;
+	self->backoff              = STREAM_MIN_BACKOFF;
+	stream_spawn(self);
+	return self;
+}
+
+const char *vala_panel_child_stream_get_command(ValaPanelChildStream *self)
+{
+	return self->command;
+}
+
+void vala_panel_child_stream_stop(ValaPanelChildStream *self)
+{
+	stream_close_child(self);
+	if (self->restart != 0)
+		g_source_remove(self->restart);
+	g_strfreev(self->argv);
+	g_free(self->command);
+	g_free(self);
+}
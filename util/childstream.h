@@ -0,0 +1,59 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHILDSTREAM_H
+#define CHILDSTREAM_H
+
+#include <glib.h>
+#include <stdbool.h>
+
+G_BEGIN_DECLS
+
+typedef void (*ValaPanelChildStreamFunc)(double value, gint64 time, gpointer user_data);
+
+/*
+ * Long-lived child process which prints one number per line, like a script
+ * following a queue depth. Its stdout is read without blocking from the
+ * main loop, so costs nothing between samples, unlike spawning a command
+ * on every tick. Text after the number, like a unit, is ignored.
+ *
+ * A child which exits is started again, after one second at first and
+ * twice as long on every failure in a row, up to a minute. A child which
+ * printed some sample before exiting gets one second again.
+ */
+typedef struct _ValaPanelChildStream ValaPanelChildStream;
+
+/**
+ * vala_panel_child_stream_start:
+ * @command: command line, split like a shell would, without running one
+ * @func: (scope notified): called for every sample, with monotonic time of reading
+ * @user_data: (closure func): data for @func
+ * @error: return location for parse error of @command
+ *
+ * Returns: (transfer full) (nullable): a running stream, or %NULL if @command is invalid
+ */
+ValaPanelChildStream *vala_panel_child_stream_start(const char *command,
+                                                    ValaPanelChildStreamFunc func,
+                                                    gpointer user_data, GError **error);
+const char *vala_panel_child_stream_get_command(ValaPanelChildStream *self);
+/* Terminates the child, @func is never called again */
+void vala_panel_child_stream_stop(ValaPanelChildStream *self);
+
+G_END_DECLS
+
+#endif // CHILDSTREAM_H
@@ -68,6 +68,7 @@
 #define VALA_PANEL_KEY_WIDTH "width"
 #define VALA_PANEL_KEY_DYNAMIC "is-dynamic"
 #define VALA_PANEL_KEY_AUTOHIDE "autohide"
+#define VALA_PANEL_KEY_VISIBILITY "visibility"
 #define VALA_PANEL_KEY_SHOW_HIDDEN "show-hidden"
 #define VALA_PANEL_KEY_STRUT "strut"
 #define VALA_PANEL_KEY_DOCK "dock"
@@ -0,0 +1,85 @@
+/*
+ * vala-panel
+ * Copyright (C) 2015-2016 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __VALA_PANEL_GRAPH_PRIVATE_H__
+#define __VALA_PANEL_GRAPH_PRIVATE_H__
+
+#include <cairo.h>
+#include <glib.h>
+#include <stdbool.h>
+
+#include "graph.h"
+#include "history.h"
+
+/*
+ * Widget-independent part of ValaPanelGraph. Surface columns map 1:1 to
+ * history slots, so the image is a ring too: pushing a sample overwrites
+ * one column in place, and the widget paints the ring in two pieces.
+ *
+ * Samples which fall into the newest column are accumulated, so with fast
+ * sampling a column keeps their mean and, if the envelope is enabled, their
+ * minimum and maximum. Stacked graphs keep the envelope of running totals.
+ *
+ * Autoscaled rings store raw values and divide by full scale only while
+ * rendering. Full scale follows the highest value in the window, which a
+ * monotonic deque of column peaks keeps in O(1) per pushed column.
+ */
+typedef struct
+{
+	guint64 column; /* Number of the column in push order */
+	double value;   /* Highest value drawn in it */
+} GraphPeak;
+
+typedef struct
+{
+	double *history; /* n_series runs of width samples, 0.0..1.0 unless autoscaled */
+	double *low;     /* Envelope runs like history, NULL unless enabled */
+	double *high;
+	double *acc;     /* Sum, minimum and maximum of every series in the newest column */
+	uint acc_count;  /* Samples in acc */
+	guint32 *colors; /* Premultiplied ARGB32, one per series */
+	double floor;      /* Smallest full scale when autoscaled, 0 otherwise */
+	double full_scale; /* Value drawn at full height, 1.0 unless autoscaled */
+	GraphPeak *peaks;  /* Deque with decreasing values, width long while autoscaled */
+	uint peaks_head;
+	uint n_peaks;
+	guint64 pushed; /* Columns pushed so far */
+	uint n_series;
+	uint width;  /* In samples, one sample per logical pixel column */
+	uint height; /* In logical pixels */
+	uint cursor; /* Oldest sample, which is overwritten next */
+	ValaPanelGraphStyle style;
+} GraphRing;
+
+G_GNUC_INTERNAL void graph_ring_init(GraphRing *ring, uint n_series);
+G_GNUC_INTERNAL void graph_ring_clear(GraphRing *ring);
+G_GNUC_INTERNAL void graph_ring_resize(GraphRing *ring, uint width, uint height);
+G_GNUC_INTERNAL uint graph_ring_push(GraphRing *ring, const double *values);
+G_GNUC_INTERNAL uint graph_ring_replace(GraphRing *ring, const double *values);
+G_GNUC_INTERNAL void graph_ring_set_envelope(GraphRing *ring, bool envelope);
+G_GNUC_INTERNAL void graph_ring_set_autoscale(GraphRing *ring, double floor);
+G_GNUC_INTERNAL bool graph_ring_rescale(GraphRing *ring);
+G_GNUC_INTERNAL void graph_ring_accumulate(GraphRing *ring, const double *values, bool merge);
+G_GNUC_INTERNAL void graph_ring_store_accumulated(GraphRing *ring, uint column);
+G_GNUC_INTERNAL gint64 graph_ring_load(GraphRing *ring, ValaPanelHistory *history,
+                                       ValaPanelHistoryLevel level);
+G_GNUC_INTERNAL void graph_ring_render_column(GraphRing *ring, cairo_surface_t *surface,
+                                              uint column);
+G_GNUC_INTERNAL void graph_ring_render(GraphRing *ring, cairo_surface_t *surface);
+
+#endif
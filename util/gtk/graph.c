@@ -0,0 +1,927 @@
+/*
+ * vala-panel
+ * Copyright (C) 2015-2016 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "graph-private.h"
+#include "graph.h"
+#include "vala-panel-util-enums.h"
+
+#define BORDER_SIZE 2    /* Pixels */
+#define MAX_FILL 10      /* Columns, longer stalls are left as gaps */
+#define SHRINK_RATIO 0.1 /* Autoscale shrinks when window peak falls below this share */
+#define ACC_SUM 0
+#define ACC_LOW 1
+#define ACC_HIGH 2
+
+/*
+ * Ring
+ */
+
+G_GNUC_INTERNAL void graph_ring_init(GraphRing *ring, uint n_series)
+{
+	memset(ring, 0, sizeof(GraphRing));
+	ring->n_series   = n_series;
+	ring->colors     = g_new0(guint32, n_series);
+	ring->acc        = g_new0(double, (size_t)n_series * 3);
+	ring->style      = VALA_PANEL_GRAPH_BARS;
+	ring->full_scale = 1.0;
+}
+
+G_GNUC_INTERNAL void graph_ring_clear(GraphRing *ring)
+{
+	g_clear_pointer(&ring->history, g_free);
+	g_clear_pointer(&ring->low, g_free);
+	g_clear_pointer(&ring->high, g_free);
+	g_clear_pointer(&ring->acc, g_free);
+	g_clear_pointer(&ring->colors, g_free);
+	g_clear_pointer(&ring->peaks, g_free);
+	ring->width = ring->cursor = ring->acc_count = ring->n_peaks = 0;
+}
+
+/* Autoscaled rings keep values as they come */
+static inline double graph_ring_ceiling(GraphRing *ring)
+{
+	return ring->floor > 0.0 ? G_MAXDOUBLE : 1.0;
+}
+
+static inline double graph_value(GraphRing *ring, double value)
+{
+	return isnan(value) ? 0.0 : CLAMP(value, 0.0, graph_ring_ceiling(ring));
+}
+
+/* Value which envelope of series follows: the value itself, or running total when stacked */
+static inline double graph_ring_edge(GraphRing *ring, double value, double *total)
+{
+	*total = MIN(*total + value, graph_ring_ceiling(ring));
+	return ring->style == VALA_PANEL_GRAPH_STACKED ? *total : value;
+}
+
+static inline GraphPeak *graph_ring_peak(GraphRing *ring, uint i)
+{
+	return &ring->peaks[(ring->peaks_head + i) % ring->width];
+}
+
+/*
+ * Adds peak of a new column, or raises peak of the newest one if @replace.
+ * Entries which can not be the maximum any more are dropped from the back,
+ * the column leaving the window from the front.
+ */
+static void graph_ring_add_peak(GraphRing *ring, double value, bool replace)
+{
+	if (ring->peaks == NULL || ring->width == 0)
+		return;
+	if (!replace)
+		ring->pushed++;
+	else if (ring->n_peaks > 0 &&
+	         graph_ring_peak(ring, ring->n_peaks - 1)->column == ring->pushed)
+	{
+		ring->n_peaks--;
+		value = MAX(value, graph_ring_peak(ring, ring->n_peaks)->value);
+	}
+	while (ring->n_peaks > 0 && graph_ring_peak(ring, ring->n_peaks - 1)->value <= value)
+		ring->n_peaks--;
+	if (ring->n_peaks > 0 && graph_ring_peak(ring, 0)->column + ring->width <= ring->pushed)
+	{
+		ring->peaks_head = (ring->peaks_head + 1) % ring->width;
+		ring->n_peaks--;
+	}
+	*graph_ring_peak(ring, ring->n_peaks++) = (GraphPeak){ ring->pushed, value };
+}
+
+/* Rebuilds the deque after stored columns were changed all at once */
+static void graph_ring_rescan(GraphRing *ring)
+{
+	ring->peaks_head = ring->n_peaks = 0;
+	for (uint n = 0; n < ring->width && ring->peaks != NULL; n++)
+	{
+		uint column  = (ring->cursor + n) % ring->width;
+		double total = 0.0;
+		double peak  = 0.0;
+		for (uint s = 0; s < ring->n_series; s++)
+		{
+			size_t i    = (size_t)s * ring->width + column;
+			double edge = graph_ring_edge(ring, ring->history[i], &total);
+			peak        = MAX(peak, ring->high != NULL ? ring->high[i] : edge);
+		}
+		graph_ring_add_peak(ring, peak, false);
+	}
+}
+
+/*
+ * Full scale grows at once and shrinks only when it is far too large, so
+ * full redraws stay rare. Returns whether it changed.
+ */
+G_GNUC_INTERNAL bool graph_ring_rescale(GraphRing *ring)
+{
+	if (ring->peaks == NULL)
+		return false;
+	double peak  = ring->n_peaks > 0 ? graph_ring_peak(ring, 0)->value : 0.0;
+	double scale = MAX(peak, ring->floor);
+	if (scale <= ring->full_scale && scale >= ring->full_scale * SHRINK_RATIO)
+		return false;
+	ring->full_scale = scale;
+	return true;
+}
+
+G_GNUC_INTERNAL void graph_ring_set_autoscale(GraphRing *ring, double floor)
+{
+	ring->floor = MAX(floor, 0.0);
+	g_clear_pointer(&ring->peaks, g_free);
+	ring->full_scale = 1.0;
+	if (ring->floor == 0.0)
+		return;
+	ring->peaks = g_new(GraphPeak, MAX(ring->width, 1));
+	graph_ring_rescan(ring);
+	ring->full_scale = ring->floor;
+	graph_ring_rescale(ring);
+}
+
+static double *graph_ring_resize_run(GraphRing *ring, double *run, uint width)
+{
+	double *resized = g_new0(double, (size_t)width * ring->n_series);
+	uint keep       = MIN(width, ring->width);
+	for (uint s = 0; s < ring->n_series && run != NULL; s++)
+	{
+		const double *src = run + (size_t)s * ring->width;
+		double *dst       = resized + (size_t)s * width + (width - keep);
+		for (uint i = 0; i < keep; i++)
+			dst[i] = src[(ring->cursor + ring->width - keep + i) % ring->width];
+	}
+	g_free(run);
+	return resized;
+}
+
+/* Keeps the newest samples, oldest ones are dropped or padded with zeroes */
+G_GNUC_INTERNAL void graph_ring_resize(GraphRing *ring, uint width, uint height)
+{
+	ring->height = height;
+	if (width == ring->width)
+		return;
+	ring->history = graph_ring_resize_run(ring, ring->history, width);
+	if (ring->low != NULL)
+	{
+		ring->low  = graph_ring_resize_run(ring, ring->low, width);
+		ring->high = graph_ring_resize_run(ring, ring->high, width);
+	}
+	ring->width  = width;
+	ring->cursor = 0;
+	if (ring->peaks != NULL)
+	{
+		ring->peaks = g_renew(GraphPeak, ring->peaks, MAX(width, 1));
+		graph_ring_rescan(ring);
+		graph_ring_rescale(ring);
+	}
+}
+
+/* Envelope of a single sample is the sample itself. Returns peak of the column. */
+static double graph_ring_store(GraphRing *ring, uint column, const double *values)
+{
+	double total = 0.0;
+	double peak  = 0.0;
+	for (uint s = 0; s < ring->n_series; s++)
+	{
+		size_t i         = (size_t)s * ring->width + column;
+		ring->history[i] = graph_value(ring, values[s]);
+		double edge      = graph_ring_edge(ring, ring->history[i], &total);
+		if (ring->low != NULL)
+			ring->low[i] = ring->high[i] = edge;
+		peak = MAX(peak, edge);
+	}
+	return peak;
+}
+
+/* Envelope starts collapsed onto stored samples, history of the widget widens it */
+G_GNUC_INTERNAL void graph_ring_set_envelope(GraphRing *ring, bool envelope)
+{
+	g_clear_pointer(&ring->low, g_free);
+	g_clear_pointer(&ring->high, g_free);
+	if (!envelope)
+		return;
+	size_t len     = (size_t)ring->width * ring->n_series;
+	double *values = g_newa(double, ring->n_series);
+	ring->low      = g_new0(double, len);
+	ring->high     = g_new0(double, len);
+	for (uint i = 0; i < ring->width; i++)
+	{
+		for (uint s = 0; s < ring->n_series; s++)
+			values[s] = ring->history[(size_t)s * ring->width + i];
+		graph_ring_store(ring, i, values);
+	}
+}
+
+/*
+ * Adds a sample to the newest column, or starts it over unless @merge. Then
+ * graph_ring_store_accumulated() writes the column, so it is redrawn once
+ * per sample, without keeping every sample around.
+ */
+G_GNUC_INTERNAL void graph_ring_accumulate(GraphRing *ring, const double *values, bool merge)
+{
+	double total = 0.0;
+	if (!merge)
+		ring->acc_count = 0;
+	for (uint s = 0; s < ring->n_series; s++)
+	{
+		double *acc  = ring->acc + (size_t)s * 3;
+		double value = graph_value(ring, values[s]);
+		double edge  = graph_ring_edge(ring, value, &total);
+		if (ring->acc_count == 0)
+		{
+			acc[ACC_SUM] = value;
+			acc[ACC_LOW] = acc[ACC_HIGH] = edge;
+			continue;
+		}
+		acc[ACC_SUM] += value;
+		acc[ACC_LOW]  = MIN(acc[ACC_LOW], edge);
+		acc[ACC_HIGH] = MAX(acc[ACC_HIGH], edge);
+	}
+	ring->acc_count++;
+}
+
+G_GNUC_INTERNAL void graph_ring_store_accumulated(GraphRing *ring, uint column)
+{
+	double peak = 0.0;
+	if (ring->acc_count == 0 || column >= ring->width)
+		return;
+	for (uint s = 0; s < ring->n_series; s++)
+	{
+		const double *acc = ring->acc + (size_t)s * 3;
+		size_t i          = (size_t)s * ring->width + column;
+		ring->history[i]  = graph_value(ring, acc[ACC_SUM] / ring->acc_count);
+		/* Scale covers the highest sample, even when only the mean is drawn */
+		peak = MAX(peak, graph_value(ring, acc[ACC_HIGH]));
+		if (ring->low == NULL)
+			continue;
+		ring->low[i]  = graph_value(ring, acc[ACC_LOW]);
+		ring->high[i] = graph_value(ring, acc[ACC_HIGH]);
+	}
+	graph_ring_add_peak(ring, peak, true);
+}
+
+/* Returns column which got the sample */
+G_GNUC_INTERNAL uint graph_ring_push(GraphRing *ring, const double *values)
+{
+	uint column = ring->cursor;
+	if (ring->width == 0)
+		return 0;
+	graph_ring_add_peak(ring, graph_ring_store(ring, column, values), false);
+	ring->cursor = (column + 1) % ring->width;
+	return column;
+}
+
+/* Overwrites the newest sample, returns its column */
+G_GNUC_INTERNAL uint graph_ring_replace(GraphRing *ring, const double *values)
+{
+	if (ring->width == 0)
+		return 0;
+	uint column = (ring->cursor + ring->width - 1) % ring->width;
+	graph_ring_add_peak(ring, graph_ring_store(ring, column, values), true);
+	return column;
+}
+
+/*
+ * Stores average of every series in bucket as a new column or over the newest
+ * one, periods without samples read as zero. Returns column of the bucket.
+ */
+static uint graph_ring_push_bucket(GraphRing *ring, ValaPanelHistory *history,
+                                   ValaPanelHistoryLevel level, gint64 index, bool replace)
+{
+	const ValaPanelHistoryBucket *bucket = vala_panel_history_get(history, level, index);
+	double *values                       = g_newa(double, ring->n_series);
+	for (uint s = 0; s < ring->n_series; s++)
+		values[s] = bucket != NULL && bucket[s].count > 0
+		                ? bucket[s].sum / bucket[s].count
+		                : 0.0;
+	uint column = replace ? graph_ring_replace(ring, values) : graph_ring_push(ring, values);
+	double peak = 0.0;
+	/* Envelope of a stacked total can not be told from envelopes of its series */
+	if (bucket == NULL || ring->style == VALA_PANEL_GRAPH_STACKED)
+		return column;
+	for (uint s = 0; s < ring->n_series && ring->width > 0; s++)
+	{
+		size_t i = (size_t)s * ring->width + column;
+		if (bucket[s].count == 0)
+			continue;
+		peak = MAX(peak, graph_value(ring, bucket[s].max));
+		if (ring->low == NULL)
+			continue;
+		ring->low[i]  = graph_value(ring, bucket[s].min);
+		ring->high[i] = graph_value(ring, bucket[s].max);
+	}
+	graph_ring_add_peak(ring, peak, true);
+	return column;
+}
+
+/* Fills the ring with newest buckets of @level, returns index of the newest one */
+G_GNUC_INTERNAL gint64 graph_ring_load(GraphRing *ring, ValaPanelHistory *history,
+                                       ValaPanelHistoryLevel level)
+{
+	gint64 newest = vala_panel_history_get_newest(history, level);
+	gint64 oldest = newest - ring->width + 1;
+	ring->cursor  = 0;
+	ring->n_peaks = 0;
+	for (uint i = 0; i < ring->width; i++)
+		graph_ring_push_bucket(ring, history, level, oldest + i, false);
+	graph_ring_rescale(ring);
+	return newest;
+}
+
+/* Share of full height which @value takes */
+static inline double graph_ring_level(GraphRing *ring, double value)
+{
+	return CLAMP(value / ring->full_scale, 0.0, 1.0);
+}
+
+static inline int graph_ring_row(GraphRing *ring, double value, int rows)
+{
+	return rows - (int)lround(graph_ring_level(ring, value) * rows);
+}
+
+/* Scales premultiplied color by value, two channels at a time */
+static inline guint32 graph_ring_shade(guint32 color, double value)
+{
+	guint32 k = (guint32)lround(value * 256);
+	return (((color & 0x00ff00ff) * k >> 8) & 0x00ff00ff) |
+	       (((color >> 8 & 0x00ff00ff) * k) & 0xff00ff00);
+}
+
+/* Every pixel row shows the hottest of series sharing it, so one busy core stays visible */
+static void graph_ring_render_heatmap(GraphRing *ring, guchar *data, int stride, int x,
+                                      int scale, int rows, uint column)
+{
+	for (int y = 0; y < rows; y++)
+	{
+		uint first   = (uint)((guint64)y * ring->n_series / (guint64)rows);
+		uint last    = (uint)((guint64)(y + 1) * ring->n_series / (guint64)rows);
+		double value = 0.0;
+		for (uint s = first; s < MAX(last, first + 1); s++)
+			value = MAX(value, ring->history[(size_t)s * ring->width + column]);
+		guint32 color  = graph_ring_shade(ring->colors[0], graph_ring_level(ring, value));
+		guint32 *pixel = (guint32 *)(data + y * stride) + x;
+		for (int i = 0; i < scale; i++)
+			pixel[i] = color;
+	}
+}
+
+static void graph_ring_fill(guchar *data, int stride, int x, int scale, int top, int bottom,
+                            guint32 color)
+{
+	for (int y = top; y < bottom; y++)
+	{
+		guint32 *pixel = (guint32 *)(data + y * stride) + x;
+		for (int i = 0; i < scale; i++)
+			pixel[i] = color;
+	}
+}
+
+/* Range between minimum and maximum of sample @i, in half of @color */
+static void graph_ring_render_band(GraphRing *ring, guchar *data, int stride, int x, int scale,
+                                   int rows, size_t i, guint32 color)
+{
+	int top    = graph_ring_row(ring, ring->high[i], rows);
+	int bottom = MIN(graph_ring_row(ring, ring->low[i], rows) + scale, rows);
+	graph_ring_fill(data, stride, x, scale, top, bottom, graph_ring_shade(color, 0.5));
+}
+
+/* Writes pixels of one column directly, without going through cairo */
+G_GNUC_INTERNAL void graph_ring_render_column(GraphRing *ring, cairo_surface_t *surface,
+                                              uint column)
+{
+	double scale_x, scale_y;
+	cairo_surface_get_device_scale(surface, &scale_x, &scale_y);
+	int scale     = (int)scale_x;
+	int rows      = cairo_image_surface_get_height(surface);
+	int stride    = cairo_image_surface_get_stride(surface);
+	guchar *data  = cairo_image_surface_get_data(surface);
+	int x         = (int)column * scale;
+	uint previous = column == ring->cursor ? column : (column + ring->width - 1) % ring->width;
+	if (data == NULL || column >= ring->width)
+		return;
+	cairo_surface_flush(surface);
+	if (ring->style == VALA_PANEL_GRAPH_HEATMAP)
+	{
+		graph_ring_render_heatmap(ring, data, stride, x, scale, rows, column);
+		cairo_surface_mark_dirty_rectangle(surface, x, 0, scale, rows);
+		return;
+	}
+	for (int y = 0; y < rows; y++)
+		memset(data + y * stride + x * 4, 0, (size_t)scale * 4);
+	/* Stacked total has one envelope, it is kept by the topmost series */
+	bool stacked_style = ring->style == VALA_PANEL_GRAPH_STACKED;
+	size_t total       = (size_t)(ring->n_series - 1) * ring->width + column;
+	if (ring->low != NULL && stacked_style)
+		graph_ring_render_band(ring, data, stride, x, scale, rows, total, ring->colors[0]);
+	double stacked = 0.0;
+	for (uint s = 0; s < ring->n_series; s++)
+	{
+		const double *history = ring->history + (size_t)s * ring->width;
+		int top               = graph_ring_row(ring, history[column], rows);
+		int bottom            = rows;
+		size_t i              = (size_t)s * ring->width + column;
+		if (ring->low != NULL && !stacked_style)
+		{
+			guint32 color = ring->colors[s];
+			graph_ring_render_band(ring, data, stride, x, scale, rows, i, color);
+		}
+		if (stacked_style)
+		{
+			bottom  = graph_ring_row(ring, stacked, rows);
+			stacked = MIN(stacked + history[column], graph_ring_ceiling(ring));
+			top     = graph_ring_row(ring, stacked, rows);
+		}
+		else if (ring->style == VALA_PANEL_GRAPH_LINES)
+		{
+			/* Connect to previous sample with a vertical run, line is one pixel thick */
+			int prev_top = graph_ring_row(ring, history[previous], rows);
+			bottom       = MIN(MAX(top, prev_top) + scale, rows);
+			top          = MIN(MIN(top, prev_top), rows - scale);
+		}
+		graph_ring_fill(data, stride, x, scale, top, bottom, ring->colors[s]);
+	}
+	cairo_surface_mark_dirty_rectangle(surface, x, 0, scale, rows);
+}
+
+G_GNUC_INTERNAL void graph_ring_render(GraphRing *ring, cairo_surface_t *surface)
+{
+	for (uint i = 0; i < ring->width; i++)
+		graph_ring_render_column(ring, surface, i);
+}
+
+/*
+ * Widget
+ */
+
+struct _ValaPanelGraph
+{
+	GtkDrawingArea __parent__;
+	GraphRing ring;
+	cairo_surface_t *surface;    /* Ring image, created when realized */
+	ValaPanelHistory *history;   /* Optional, outlives the ring */
+	ValaPanelHistoryLevel level; /* Time scale shown from history */
+	gint64 shown;                /* Newest bucket of level in the ring */
+	gint64 pushed;               /* Wall clock second of the newest column, 0 if none */
+};
+
+enum
+{
+	PROP_DUMMY,
+	PROP_N_SERIES,
+	PROP_STYLE,
+	PROP_ENVELOPE,
+	N_PROPERTIES
+};
+
+static GParamSpec *graph_spec[N_PROPERTIES];
+
+G_DEFINE_TYPE(ValaPanelGraph, vala_panel_graph, GTK_TYPE_DRAWING_AREA)
+
+static cairo_surface_t *vala_panel_graph_ensure_surface(ValaPanelGraph *self)
+{
+	GtkWidget *widget = GTK_WIDGET(self);
+	if (self->surface != NULL || !gtk_widget_get_realized(widget) || self->ring.width == 0 ||
+	    self->ring.height == 0)
+		return self->surface;
+	int scale     = gtk_widget_get_scale_factor(widget);
+	self->surface = gdk_window_create_similar_image_surface(gtk_widget_get_window(widget),
+	                                                        CAIRO_FORMAT_ARGB32,
+	                                                        (int)self->ring.width * scale,
+	                                                        (int)self->ring.height * scale,
+	                                                        scale);
+	graph_ring_render(&self->ring, self->surface);
+	return self->surface;
+}
+
+static void vala_panel_graph_invalidate(ValaPanelGraph *self)
+{
+	g_clear_pointer(&self->surface, cairo_surface_destroy);
+	gtk_widget_queue_draw(GTK_WIDGET(self));
+}
+
+static void vala_panel_graph_size_allocate(GtkWidget *widget, GtkAllocation *allocation)
+{
+	ValaPanelGraph *self = VALA_PANEL_GRAPH(widget);
+	GTK_WIDGET_CLASS(vala_panel_graph_parent_class)->size_allocate(widget, allocation);
+	uint width  = (uint)MAX(allocation->width - BORDER_SIZE * 2, 0);
+	uint height = (uint)MAX(allocation->height - BORDER_SIZE * 2, 0);
+	if (width != self->ring.width || height != self->ring.height)
+	{
+		graph_ring_resize(&self->ring, width, height);
+		/* Widening shows older samples instead of zeroes */
+		if (self->history != NULL)
+			self->shown = graph_ring_load(&self->ring, self->history, self->level);
+		vala_panel_graph_invalidate(self);
+	}
+}
+
+static gboolean vala_panel_graph_draw(GtkWidget *widget, cairo_t *cr)
+{
+	ValaPanelGraph *self     = VALA_PANEL_GRAPH(widget);
+	cairo_surface_t *surface = vala_panel_graph_ensure_surface(self);
+	if (surface == NULL)
+		return false;
+	/* Oldest samples start at the cursor, so paint the ring in two pieces */
+	int older = (int)(self->ring.width - self->ring.cursor);
+	int newer = (int)self->ring.cursor;
+	cairo_set_source_surface(cr, surface, BORDER_SIZE - newer, BORDER_SIZE);
+	cairo_rectangle(cr, BORDER_SIZE, BORDER_SIZE, older, self->ring.height);
+	cairo_fill(cr);
+	if (newer > 0)
+	{
+		cairo_set_source_surface(cr, surface, BORDER_SIZE + older, BORDER_SIZE);
+		cairo_rectangle(cr, BORDER_SIZE + older, BORDER_SIZE, newer, self->ring.height);
+		cairo_fill(cr);
+	}
+	return false;
+}
+
+static gboolean vala_panel_graph_scroll_event(GtkWidget *widget, GdkEventScroll *event)
+{
+	ValaPanelGraph *self = VALA_PANEL_GRAPH(widget);
+	int step             = 0;
+	if (self->history == NULL)
+		return false;
+	if (event->direction == GDK_SCROLL_UP)
+		step = -1;
+	else if (event->direction == GDK_SCROLL_DOWN)
+		step = 1;
+	else if (event->direction == GDK_SCROLL_SMOOTH && event->delta_y != 0)
+		step = event->delta_y > 0 ? 1 : -1;
+	/* Scrolling down zooms out to a coarser level */
+	int level = CLAMP((int)self->level + step, 0, VALA_PANEL_HISTORY_N_LEVELS - 1);
+	vala_panel_graph_set_level(self, (ValaPanelHistoryLevel)level);
+	return true;
+}
+
+static void vala_panel_graph_unrealize(GtkWidget *widget)
+{
+	g_clear_pointer(&VALA_PANEL_GRAPH(widget)->surface, cairo_surface_destroy);
+	GTK_WIDGET_CLASS(vala_panel_graph_parent_class)->unrealize(widget);
+}
+
+static void vala_panel_graph_scale_factor_changed(GObject *obj, G_GNUC_UNUSED GParamSpec *pspec,
+                                                  G_GNUC_UNUSED gpointer data)
+{
+	vala_panel_graph_invalidate(VALA_PANEL_GRAPH(obj));
+}
+
+void vala_panel_graph_set_color(ValaPanelGraph *self, uint series, const GdkRGBA *color)
+{
+	g_return_if_fail(VALA_PANEL_IS_GRAPH(self));
+	g_return_if_fail(series < self->ring.n_series);
+	double alpha = CLAMP(color->alpha, 0.0, 1.0);
+	guint32 a    = (guint32)lround(alpha * 255);
+	guint32 r    = (guint32)lround(CLAMP(color->red, 0.0, 1.0) * alpha * 255);
+	guint32 g    = (guint32)lround(CLAMP(color->green, 0.0, 1.0) * alpha * 255);
+	guint32 b    = (guint32)lround(CLAMP(color->blue, 0.0, 1.0) * alpha * 255);
+	self->ring.colors[series] = a << 24 | r << 16 | g << 8 | b;
+	vala_panel_graph_invalidate(self);
+}
+
+static void vala_panel_graph_reset_envelope(ValaPanelGraph *self, bool envelope)
+{
+	graph_ring_set_envelope(&self->ring, envelope);
+	/* Buckets of history know minimum and maximum of their samples */
+	if (envelope && self->history != NULL)
+		self->shown = graph_ring_load(&self->ring, self->history, self->level);
+}
+
+void vala_panel_graph_set_style(ValaPanelGraph *self, ValaPanelGraphStyle style)
+{
+	g_return_if_fail(VALA_PANEL_IS_GRAPH(self));
+	if (style == self->ring.style)
+		return;
+	self->ring.style = style;
+	/* Stacked envelope follows totals instead of series, so it is collected anew */
+	self->ring.acc_count = 0;
+	if (self->ring.low != NULL)
+		vala_panel_graph_reset_envelope(self, true);
+	vala_panel_graph_invalidate(self);
+	g_object_notify_by_pspec(G_OBJECT(self), graph_spec[PROP_STYLE]);
+}
+
+void vala_panel_graph_set_envelope(ValaPanelGraph *self, bool envelope)
+{
+	g_return_if_fail(VALA_PANEL_IS_GRAPH(self));
+	if (envelope == (self->ring.low != NULL))
+		return;
+	vala_panel_graph_reset_envelope(self, envelope);
+	vala_panel_graph_invalidate(self);
+	g_object_notify_by_pspec(G_OBJECT(self), graph_spec[PROP_ENVELOPE]);
+}
+
+bool vala_panel_graph_get_envelope(ValaPanelGraph *self)
+{
+	g_return_val_if_fail(VALA_PANEL_IS_GRAPH(self), false);
+	return self->ring.low != NULL;
+}
+
+void vala_panel_graph_set_autoscale(ValaPanelGraph *self, double floor)
+{
+	g_return_if_fail(VALA_PANEL_IS_GRAPH(self));
+	graph_ring_set_autoscale(&self->ring, floor);
+	vala_panel_graph_invalidate(self);
+}
+
+double vala_panel_graph_get_full_scale(ValaPanelGraph *self)
+{
+	g_return_val_if_fail(VALA_PANEL_IS_GRAPH(self), 1.0);
+	return self->ring.full_scale;
+}
+
+/* Stored values stay as they are, only the image is redrawn for a new full scale */
+static void vala_panel_graph_follow_scale(ValaPanelGraph *self)
+{
+	if (graph_ring_rescale(&self->ring) && self->surface != NULL)
+		graph_ring_render(&self->ring, self->surface);
+}
+
+/* Brings the ring up to the newest bucket of history */
+static void vala_panel_graph_follow(ValaPanelGraph *self)
+{
+	GraphRing *ring = &self->ring;
+	gint64 newest   = vala_panel_history_get_newest(self->history, self->level);
+	if (newest - self->shown >= ring->width)
+	{
+		self->shown = graph_ring_load(ring, self->history, self->level);
+		if (self->surface != NULL)
+			graph_ring_render(ring, self->surface);
+		gtk_widget_queue_draw(GTK_WIDGET(self));
+		return;
+	}
+	/* Bucket in the newest column may have got more samples, then come new ones */
+	for (gint64 i = self->shown; i <= newest; i++)
+	{
+		bool replace = i == self->shown;
+		uint column  = graph_ring_push_bucket(ring, self->history, self->level, i, replace);
+		/* Buckets do not keep envelope of stacked totals, samples of live column do */
+		if (i == newest && self->level == VALA_PANEL_HISTORY_1S)
+			graph_ring_store_accumulated(ring, column);
+		if (self->surface != NULL)
+			graph_ring_render_column(ring, self->surface, column);
+	}
+	self->shown = newest;
+	vala_panel_graph_follow_scale(self);
+	gtk_widget_queue_draw(GTK_WIDGET(self));
+}
+
+bool vala_panel_graph_push(ValaPanelGraph *self, const double *values)
+{
+	return vala_panel_graph_push_at(self, values, g_get_monotonic_time());
+}
+
+bool vala_panel_graph_push_at(ValaPanelGraph *self, const double *values, gint64 time)
+{
+	g_return_val_if_fail(VALA_PANEL_IS_GRAPH(self), false);
+	GraphRing *ring = &self->ring;
+	/* Columns are wall clock seconds, like buckets of history, so ticks right after
+	 * a boundary and fast samples all land in the column of their second */
+	gint64 now     = (g_get_real_time() - (g_get_monotonic_time() - time)) / G_USEC_PER_SEC;
+	gint64 periods = self->pushed != 0 ? now - self->pushed : 1;
+	/* Wall clock stepped back: start columns over from now instead of merging
+	 * every sample into one column until the clock catches up */
+	if (periods < 0)
+		periods = 1;
+	gint64 gap  = periods > MAX_FILL ? periods - 1 : 0;
+	gint64 fill = gap > 0 ? 1 : MAX(periods, 0);
+	if (periods > 0)
+		self->pushed = now;
+	graph_ring_accumulate(ring, values, fill == 0);
+	if (self->history != NULL)
+	{
+		double *clamped = g_newa(double, ring->n_series);
+		for (uint s = 0; s < ring->n_series; s++)
+			clamped[s] = graph_value(ring, values[s]);
+		/* Late tick fills skipped seconds, history clears a longer gap by itself */
+		for (gint64 i = MAX(fill, 1) - 1; i >= 0; i--)
+			vala_panel_history_push(self->history, now - i, clamped);
+		vala_panel_graph_follow(self);
+		return fill > 0;
+	}
+	double *zeroes = g_newa(double, ring->n_series);
+	gint64 empty   = MIN(gap, (gint64)ring->width);
+	memset(zeroes, 0, sizeof(double) * ring->n_series);
+	for (gint64 i = 0; i < empty + MAX(fill, 1); i++)
+	{
+		uint column = fill == 0    ? graph_ring_replace(ring, values)
+		              : i < empty ? graph_ring_push(ring, zeroes)
+		                          : graph_ring_push(ring, values);
+		/* Samples of the same second are merged in the newest column */
+		if (fill == 0)
+			graph_ring_store_accumulated(ring, column);
+		if (self->surface != NULL)
+			graph_ring_render_column(ring, self->surface, column);
+	}
+	vala_panel_graph_follow_scale(self);
+	gtk_widget_queue_draw(GTK_WIDGET(self));
+	return fill > 0;
+}
+
+void vala_panel_graph_set_history(ValaPanelGraph *self, const char *name)
+{
+	g_return_if_fail(VALA_PANEL_IS_GRAPH(self));
+	g_clear_pointer(&self->history, vala_panel_history_close);
+	if (name != NULL)
+		self->history = vala_panel_history_open(name, self->ring.n_series);
+	/* Autoscaled graphs used to be fed values normalized by full scale of the file */
+	double full_scale = self->history != NULL ? vala_panel_history_get_full_scale(self->history)
+	                                          : 0.0;
+	if (self->ring.floor > 0.0 && full_scale > 0.0)
+	{
+		vala_panel_history_scale(self->history, full_scale);
+		vala_panel_history_set_full_scale(self->history, 0.0);
+	}
+	if (self->history != NULL)
+		self->shown = graph_ring_load(&self->ring, self->history, self->level);
+	vala_panel_graph_invalidate(self);
+}
+
+ValaPanelHistory *vala_panel_graph_get_history(ValaPanelGraph *self)
+{
+	g_return_val_if_fail(VALA_PANEL_IS_GRAPH(self), NULL);
+	return self->history;
+}
+
+void vala_panel_graph_set_level(ValaPanelGraph *self, ValaPanelHistoryLevel level)
+{
+	g_return_if_fail(VALA_PANEL_IS_GRAPH(self));
+	g_return_if_fail(level < VALA_PANEL_HISTORY_N_LEVELS);
+	if (level == self->level)
+		return;
+	self->level = level;
+	/* Levels are precomputed, so switching is one pass over visible buckets */
+	if (self->history != NULL)
+		self->shown = graph_ring_load(&self->ring, self->history, self->level);
+	vala_panel_graph_invalidate(self);
+}
+
+ValaPanelHistoryLevel vala_panel_graph_get_level(ValaPanelGraph *self)
+{
+	g_return_val_if_fail(VALA_PANEL_IS_GRAPH(self), VALA_PANEL_HISTORY_1S);
+	return self->level;
+}
+
+double vala_panel_graph_get_last(ValaPanelGraph *self, uint series)
+{
+	g_return_val_if_fail(VALA_PANEL_IS_GRAPH(self), 0.0);
+	g_return_val_if_fail(series < self->ring.n_series, 0.0);
+	if (self->ring.width == 0)
+		return 0.0;
+	uint last = (self->ring.cursor + self->ring.width - 1) % self->ring.width;
+	return self->ring.history[(size_t)series * self->ring.width + last];
+}
+
+double vala_panel_graph_get_max(ValaPanelGraph *self, uint series)
+{
+	g_return_val_if_fail(VALA_PANEL_IS_GRAPH(self), 0.0);
+	g_return_val_if_fail(series < self->ring.n_series, 0.0);
+	/* With envelope, the highest sample is larger than the highest mean */
+	const double *run = (self->ring.high != NULL ? self->ring.high : self->ring.history) +
+	                    (size_t)series * self->ring.width;
+	double max        = 0.0;
+	for (uint i = 0; i < self->ring.width; i++)
+		max = MAX(max, run[i]);
+	return max;
+}
+
+void vala_panel_graph_scale(ValaPanelGraph *self, double factor)
+{
+	g_return_if_fail(VALA_PANEL_IS_GRAPH(self));
+	GraphRing *ring = &self->ring;
+	size_t len      = (size_t)ring->width * ring->n_series;
+	for (size_t i = 0; i < len; i++)
+		ring->history[i] = graph_value(ring, ring->history[i] * factor);
+	for (size_t i = 0; i < len && ring->low != NULL; i++)
+	{
+		ring->low[i]  = graph_value(ring, ring->low[i] * factor);
+		ring->high[i] = graph_value(ring, ring->high[i] * factor);
+	}
+	graph_ring_rescan(ring);
+	graph_ring_rescale(ring);
+	/* Samples of the newest column are still merged, so they are rescaled as well */
+	for (size_t i = 0; i < (size_t)ring->n_series * 3; i++)
+		ring->acc[i] *= factor;
+	if (self->history != NULL)
+		vala_panel_history_scale(self->history, factor);
+	if (self->surface != NULL)
+		graph_ring_render(&self->ring, self->surface);
+	gtk_widget_queue_draw(GTK_WIDGET(self));
+}
+
+ValaPanelGraph *vala_panel_graph_new(uint n_series)
+{
+	return VALA_PANEL_GRAPH(
+	    g_object_new(vala_panel_graph_get_type(), "n-series", n_series, NULL));
+}
+
+static void vala_panel_graph_get_property(GObject *object, uint property_id, GValue *value,
+                                          GParamSpec *pspec)
+{
+	ValaPanelGraph *self = VALA_PANEL_GRAPH(object);
+	switch (property_id)
+	{
+	case PROP_N_SERIES:
+		g_value_set_uint(value, self->ring.n_series);
+		break;
+	case PROP_STYLE:
+		g_value_set_enum(value, self->ring.style);
+		break;
+	case PROP_ENVELOPE:
+		g_value_set_boolean(value, self->ring.low != NULL);
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+	}
+}
+
+static void vala_panel_graph_set_property(GObject *object, uint property_id, const GValue *value,
+                                          GParamSpec *pspec)
+{
+	ValaPanelGraph *self = VALA_PANEL_GRAPH(object);
+	switch (property_id)
+	{
+	case PROP_N_SERIES:
+		graph_ring_clear(&self->ring);
+		graph_ring_init(&self->ring, g_value_get_uint(value));
+		break;
+	case PROP_STYLE:
+		vala_panel_graph_set_style(self, (ValaPanelGraphStyle)g_value_get_enum(value));
+		break;
+	case PROP_ENVELOPE:
+		vala_panel_graph_set_envelope(self, g_value_get_boolean(value));
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID(object, property_id, pspec);
+	}
+}
+
+static void vala_panel_graph_finalize(GObject *obj)
+{
+	ValaPanelGraph *self = VALA_PANEL_GRAPH(obj);
+	g_clear_pointer(&self->surface, cairo_surface_destroy);
+	g_clear_pointer(&self->history, vala_panel_history_close);
+	graph_ring_clear(&self->ring);
+	G_OBJECT_CLASS(vala_panel_graph_parent_class)->finalize(obj);
+}
+
+static void vala_panel_graph_init(ValaPanelGraph *self)
+{
+	graph_ring_init(&self->ring, 1);
+	gtk_widget_add_events(GTK_WIDGET(self), GDK_SCROLL_MASK);
+	g_signal_connect(self,
+	                 "notify::scale-factor",
+	                 G_CALLBACK(vala_panel_graph_scale_factor_changed),
+	                 NULL);
+}
+
+static void vala_panel_graph_class_init(ValaPanelGraphClass *klass)
+{
+	GObjectClass *object_class   = G_OBJECT_CLASS(klass);
+	GtkWidgetClass *widget_class = GTK_WIDGET_CLASS(klass);
+
+	object_class->set_property  = vala_panel_graph_set_property;
+	object_class->get_property  = vala_panel_graph_get_property;
+	object_class->finalize      = vala_panel_graph_finalize;
+	widget_class->size_allocate = vala_panel_graph_size_allocate;
+	widget_class->draw          = vala_panel_graph_draw;
+	widget_class->unrealize     = vala_panel_graph_unrealize;
+	widget_class->scroll_event  = vala_panel_graph_scroll_event;
+
+	graph_spec[PROP_N_SERIES] =
+	    g_param_spec_uint("n-series",
+	                      "",
+	                      "",
+	                      1,
+	                      G_MAXUINT16,
+	                      1,
+	                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE |
+	                          G_PARAM_STATIC_STRINGS);
+	graph_spec[PROP_STYLE] = g_param_spec_enum("style",
+	                                           "",
+	                                           "",
+	                                           vala_panel_graph_style_get_type(),
+	                                           VALA_PANEL_GRAPH_BARS,
+	                                           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+	graph_spec[PROP_ENVELOPE] =
+	    g_param_spec_boolean("envelope",
+	                         "",
+	                         "",
+	                         false,
+	                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+	g_object_class_install_properties(object_class, N_PROPERTIES, graph_spec);
+}
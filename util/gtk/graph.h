@@ -0,0 +1,132 @@
+/*
+ * vala-panel
+ * Copyright (C) 2015-2016 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <gtk/gtk.h>
+#include <stdbool.h>
+
+#include "history.h"
+
+G_BEGIN_DECLS
+
+typedef enum
+{
+	VALA_PANEL_GRAPH_BARS,
+	VALA_PANEL_GRAPH_LINES,
+	VALA_PANEL_GRAPH_HEATMAP, /* Series are rows, color of series 0 shows values */
+	VALA_PANEL_GRAPH_STACKED, /* Series are bars on top of each other, from the bottom */
+} ValaPanelGraphStyle;
+
+G_DECLARE_FINAL_TYPE(ValaPanelGraph, vala_panel_graph, VALA_PANEL, GRAPH, GtkDrawingArea)
+
+/**
+ * vala_panel_graph_new:
+ * @n_series: number of values in every sample, drawn in order
+ *
+ * Scrolling history graph, one sample per pixel column. A new sample only
+ * rasterizes its own column, older columns are kept in the image as is.
+ *
+ * Returns: (transfer floating): a new #ValaPanelGraph
+ */
+ValaPanelGraph *vala_panel_graph_new(uint n_series);
+void vala_panel_graph_set_color(ValaPanelGraph *self, uint series, const GdkRGBA *color);
+void vala_panel_graph_set_style(ValaPanelGraph *self, ValaPanelGraphStyle style);
+/**
+ * vala_panel_graph_set_envelope:
+ * @self: a #ValaPanelGraph
+ * @envelope: whether to draw minimum and maximum of samples in every column
+ *
+ * With several samples per column, bars and lines are drawn at their mean
+ * over a lighter band from their minimum to their maximum, so short bursts
+ * stay visible. Stacked graphs draw the band for their total.
+ */
+void vala_panel_graph_set_envelope(ValaPanelGraph *self, bool envelope);
+bool vala_panel_graph_get_envelope(ValaPanelGraph *self);
+/**
+ * vala_panel_graph_set_autoscale:
+ * @self: a #ValaPanelGraph
+ * @floor: smallest full scale, or 0 to take values in 0.0..1.0 range
+ *
+ * Lets the graph take raw values, like byte rates, and keep them unchanged.
+ * They are drawn relative to the highest value in visible columns, which is
+ * followed as columns come and go, so nothing is rescaled when it changes.
+ * Call it before vala_panel_graph_set_history().
+ */
+void vala_panel_graph_set_autoscale(ValaPanelGraph *self, double floor);
+/* Value drawn at full height, 1.0 unless autoscaled */
+double vala_panel_graph_get_full_scale(ValaPanelGraph *self);
+/**
+ * vala_panel_graph_push:
+ * @self: a #ValaPanelGraph
+ * @values: (array): one value for every series, in 0.0..1.0 range unless autoscaled
+ *
+ * Returns: same as vala_panel_graph_push_at()
+ */
+bool vala_panel_graph_push(ValaPanelGraph *self, const double *values);
+/**
+ * vala_panel_graph_push_at:
+ * @self: a #ValaPanelGraph
+ * @values: (array): mean of every series over time since previous sample
+ * @time: monotonic time of the sample, as g_get_monotonic_time()
+ *
+ * Columns are wall clock seconds. Samples of the same second are merged
+ * in its column, which shows their mean. When ticks come late, @values
+ * fill every skipped column instead of leaving a dip. Stalls longer than
+ * a few seconds stay visible as gaps.
+ *
+ * Returns: %TRUE if @values started a new column, so text which shows
+ * the newest values needs to be refreshed only then
+ */
+bool vala_panel_graph_push_at(ValaPanelGraph *self, const double *values, gint64 time);
+double vala_panel_graph_get_last(ValaPanelGraph *self, uint series);
+double vala_panel_graph_get_max(ValaPanelGraph *self, uint series);
+/**
+ * vala_panel_graph_scale:
+ * @self: a #ValaPanelGraph
+ * @factor: multiplier for every stored value
+ *
+ * Rescales whole history, for graphs which normalize by a changing maximum.
+ * This redraws all columns, so it should not be done on every sample.
+ * Autoscaled graphs never need it.
+ */
+void vala_panel_graph_scale(ValaPanelGraph *self, double factor);
+/**
+ * vala_panel_graph_set_history:
+ * @self: a #ValaPanelGraph
+ * @name: (nullable): name of metric file, unique per applet instance, or %NULL to detach
+ *
+ * Keeps pushed samples in a file, so they outlive the panel and the widget
+ * width. Then graph can also show coarser time scales, which are selected
+ * with vala_panel_graph_set_level() or by scrolling over the graph.
+ */
+void vala_panel_graph_set_history(ValaPanelGraph *self, const char *name);
+/**
+ * vala_panel_graph_get_history: (skip)
+ * @self: a #ValaPanelGraph
+ *
+ * Returns: (nullable) (transfer none): attached history
+ */
+ValaPanelHistory *vala_panel_graph_get_history(ValaPanelGraph *self);
+void vala_panel_graph_set_level(ValaPanelGraph *self, ValaPanelHistoryLevel level);
+ValaPanelHistoryLevel vala_panel_graph_get_level(ValaPanelGraph *self);
+
+G_END_DECLS
+
+#endif // GRAPH_H
@@ -21,6 +21,7 @@
 
 #include "css.h"
 #include "generic-config-dialog.h"
+#include "graph.h"
 #include "launcher-gtk.h"
 #include "misc-gtk.h"
 #include "util.h"
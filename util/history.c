@@ -0,0 +1,246 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "history.h"
+
+#define HISTORY_MAGIC 0x31485056 /* "VPH1" */
+#define HISTORY_VERSION 1
+#define HISTORY_SUFFIX ".hist"
+
+static const uint history_periods[VALA_PANEL_HISTORY_N_LEVELS] = { 1, 10, 60, 600 };
+
+/* File starts with this header, then levels follow from finest to coarsest */
+typedef struct
+{
+	guint32 magic;
+	guint32 version;
+	guint32 n_series;
+	guint32 capacity;
+	guint32 n_levels;
+	guint32 reserved;
+	double full_scale;
+	gint64 newest[VALA_PANEL_HISTORY_N_LEVELS];
+} HistoryHeader;
+
+struct _ValaPanelHistory
+{
+	HistoryHeader *header;          /* Start of mapping */
+	ValaPanelHistoryBucket *levels; /* Right after header */
+	size_t size;                    /* Of mapping */
+};
+
+static size_t history_file_size(uint n_series)
+{
+	return sizeof(HistoryHeader) + sizeof(ValaPanelHistoryBucket) * n_series *
+	                                   VALA_PANEL_HISTORY_CAPACITY *
+	                                   VALA_PANEL_HISTORY_N_LEVELS;
+}
+
+static bool history_header_valid(const HistoryHeader *header, uint n_series)
+{
+	return header->magic == HISTORY_MAGIC && header->version == HISTORY_VERSION &&
+	       header->n_series == n_series && header->capacity == VALA_PANEL_HISTORY_CAPACITY &&
+	       header->n_levels == VALA_PANEL_HISTORY_N_LEVELS;
+}
+
+/* Files not opened for the span of the coarsest level hold nothing readable */
+static void history_expire(const char *dir)
+{
+	static gsize expired = 0;
+	if (!g_once_init_enter(&expired))
+		return;
+	gint64 span            = (gint64)history_periods[VALA_PANEL_HISTORY_N_LEVELS - 1] *
+	                         VALA_PANEL_HISTORY_CAPACITY;
+	gint64 now             = g_get_real_time() / G_USEC_PER_SEC;
+	g_autoptr(GDir) handle = g_dir_open(dir, 0, NULL);
+	const char *file;
+	while (handle != NULL && (file = g_dir_read_name(handle)) != NULL)
+	{
+		g_autofree char *path = g_build_filename(dir, file, NULL);
+		GStatBuf st;
+		if (g_str_has_suffix(file, HISTORY_SUFFIX) && g_stat(path, &st) == 0 &&
+		    now - (gint64)st.st_mtime > span)
+			g_unlink(path);
+	}
+	g_once_init_leave(&expired, 1);
+}
+
+static inline ValaPanelHistoryBucket *history_slot(ValaPanelHistory *self,
+                                                   ValaPanelHistoryLevel level, gint64 index)
+{
+	size_t n_series = self->header->n_series;
+	size_t slot     = (size_t)(index % VALA_PANEL_HISTORY_CAPACITY);
+	return self->levels + ((size_t)level * VALA_PANEL_HISTORY_CAPACITY + slot) * n_series;
+}
+
+ValaPanelHistory *vala_panel_history_open(const char *name, uint n_series)
+{
+	g_return_val_if_fail(name != NULL && n_series > 0, NULL);
+	const char *cache     = g_get_user_cache_dir();
+	g_autofree char *dir  = g_build_filename(cache, "vala-panel", "history", NULL);
+	g_autofree char *file = g_strconcat(name, HISTORY_SUFFIX, NULL);
+	g_autofree char *path = g_build_filename(dir, file, NULL);
+	size_t size           = history_file_size(n_series);
+	struct stat st;
+	if (g_mkdir_with_parents(dir, 0700) < 0)
+		return NULL;
+	history_expire(dir);
+	int fd = g_open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+	if (fd < 0)
+	{
+		g_warning("history: cannot open %s: %s", path, g_strerror(errno));
+		return NULL;
+	}
+	bool fresh = fstat(fd, &st) < 0 || (size_t)st.st_size != size;
+	/* Applets which still use the file keep it from expiring */
+	futimens(fd, NULL);
+	/* Truncating to zero first discards old contents, the file reads back as zeroes */
+	if (fresh && (ftruncate(fd, 0) < 0 || ftruncate(fd, (off_t)size) < 0))
+	{
+		g_warning("history: cannot resize %s: %s", path, g_strerror(errno));
+		close(fd);
+		return NULL;
+	}
+	void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+	{
+		g_warning("history: cannot map %s: %s", path, g_strerror(errno));
+		return NULL;
+	}
+	ValaPanelHistory *self = g_new0(ValaPanelHistory, 1);
+	self->header           = (HistoryHeader *)map;
+	self->levels           = (ValaPanelHistoryBucket *)(self->header + 1);
+	self->size             = size;
+	if (fresh || !history_header_valid(self->header, n_series))
+	{
+		memset(map, 0, size);
+		self->header->magic    = HISTORY_MAGIC;
+		self->header->version  = HISTORY_VERSION;
+		self->header->n_series = n_series;
+		self->header->capacity = VALA_PANEL_HISTORY_CAPACITY;
+		self->header->n_levels = VALA_PANEL_HISTORY_N_LEVELS;
+	}
+	return self;
+}
+
+void vala_panel_history_close(ValaPanelHistory *self)
+{
+	if (self == NULL)
+		return;
+	munmap(self->header, self->size);
+	g_free(self);
+}
+
+uint vala_panel_history_get_n_series(ValaPanelHistory *self)
+{
+	return self->header->n_series;
+}
+
+uint vala_panel_history_get_period(ValaPanelHistoryLevel level)
+{
+	g_return_val_if_fail(level < VALA_PANEL_HISTORY_N_LEVELS, 1);
+	return history_periods[level];
+}
+
+void vala_panel_history_push(ValaPanelHistory *self, gint64 time_s, const double *values)
+{
+	uint n_series = self->header->n_series;
+	size_t stride = sizeof(ValaPanelHistoryBucket) * n_series;
+	for (uint l = 0; l < VALA_PANEL_HISTORY_N_LEVELS; l++)
+	{
+		gint64 *newest = &self->header->newest[l];
+		gint64 index   = time_s / history_periods[l];
+		/* Wall clock went back: buckets ahead of it would never be reached again
+		 * in order, so the level starts over from the current period */
+		if (index < *newest)
+		{
+			memset(history_slot(self, l, 0), 0, stride * VALA_PANEL_HISTORY_CAPACITY);
+			*newest = index;
+		}
+		/* Periods without samples must not show what the ring held a lap ago */
+		gint64 skipped = MIN(index - *newest, VALA_PANEL_HISTORY_CAPACITY);
+		for (gint64 i = index - skipped + 1; i <= index; i++)
+			memset(history_slot(self, l, i), 0, stride);
+		*newest = index;
+
+		ValaPanelHistoryBucket *bucket = history_slot(self, l, index);
+		for (uint s = 0; s < n_series; s++)
+		{
+			float value = (float)values[s];
+			if (bucket[s].count == 0)
+			{
+				bucket[s].min = bucket[s].max = value;
+				bucket[s].sum                 = 0;
+			}
+			bucket[s].min = MIN(bucket[s].min, value);
+			bucket[s].max = MAX(bucket[s].max, value);
+			bucket[s].sum += value;
+			bucket[s].count++;
+		}
+	}
+}
+
+gint64 vala_panel_history_get_newest(ValaPanelHistory *self, ValaPanelHistoryLevel level)
+{
+	g_return_val_if_fail(level < VALA_PANEL_HISTORY_N_LEVELS, 0);
+	return self->header->newest[level];
+}
+
+const ValaPanelHistoryBucket *vala_panel_history_get(ValaPanelHistory *self,
+                                                     ValaPanelHistoryLevel level, gint64 index)
+{
+	g_return_val_if_fail(level < VALA_PANEL_HISTORY_N_LEVELS, NULL);
+	gint64 newest = self->header->newest[level];
+	if (index > newest || index <= newest - VALA_PANEL_HISTORY_CAPACITY || index < 0)
+		return NULL;
+	return history_slot(self, level, index);
+}
+
+void vala_panel_history_scale(ValaPanelHistory *self, double factor)
+{
+	size_t len = (size_t)self->header->n_series * VALA_PANEL_HISTORY_CAPACITY *
+	             VALA_PANEL_HISTORY_N_LEVELS;
+	for (size_t i = 0; i < len; i++)
+	{
+		ValaPanelHistoryBucket *bucket = &self->levels[i];
+		if (bucket->count == 0)
+			continue;
+		bucket->min = (float)(bucket->min * factor);
+		bucket->max = (float)(bucket->max * factor);
+		bucket->sum = (float)(bucket->sum * factor);
+	}
+}
+
+double vala_panel_history_get_full_scale(ValaPanelHistory *self)
+{
+	return self->header->full_scale;
+}
+
+void vala_panel_history_set_full_scale(ValaPanelHistory *self, double full_scale)
+{
+	self->header->full_scale = full_scale;
+}
@@ -0,0 +1,88 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <glib.h>
+#include <stdbool.h>
+
+G_BEGIN_DECLS
+
+/* Aggregation levels, each one keeps VALA_PANEL_HISTORY_CAPACITY buckets */
+typedef enum
+{
+	VALA_PANEL_HISTORY_1S    = 0,
+	VALA_PANEL_HISTORY_10S   = 1,
+	VALA_PANEL_HISTORY_1MIN  = 2,
+	VALA_PANEL_HISTORY_10MIN = 3,
+	VALA_PANEL_HISTORY_N_LEVELS
+} ValaPanelHistoryLevel;
+
+#define VALA_PANEL_HISTORY_CAPACITY 3600 /* An hour of 1s samples */
+
+/* Samples of one series which fell into one period of a level */
+typedef struct
+{
+	float min;
+	float max;
+	float sum;
+	guint32 count; /* 0 for periods without samples */
+} ValaPanelHistoryBucket;
+
+/*
+ * Metric history in a memory-mapped file under $XDG_CACHE_HOME. Every level
+ * is a ring of buckets indexed by wall-clock time divided by level period,
+ * and every sample updates one bucket of each level, so reading any time
+ * scale is a plain array walk. Opening validates only the header.
+ */
+typedef struct _ValaPanelHistory ValaPanelHistory;
+
+/**
+ * vala_panel_history_open: (skip)
+ * @name: file name of metric, unique per applet instance
+ * @n_series: number of values in every sample
+ *
+ * File is created, or recreated when it does not match @n_series.
+ *
+ * Returns: (nullable): history, or %NULL if file could not be mapped
+ */
+ValaPanelHistory *vala_panel_history_open(const char *name, uint n_series);
+void vala_panel_history_close(ValaPanelHistory *self);
+uint vala_panel_history_get_n_series(ValaPanelHistory *self);
+/* Length of bucket on @level, in seconds */
+uint vala_panel_history_get_period(ValaPanelHistoryLevel level);
+void vala_panel_history_push(ValaPanelHistory *self, gint64 time_s, const double *values);
+/* Index of newest bucket on @level, which is time of it divided by period */
+gint64 vala_panel_history_get_newest(ValaPanelHistory *self, ValaPanelHistoryLevel level);
+/**
+ * vala_panel_history_get: (skip)
+ *
+ * Returns: (nullable): n_series buckets of @index, or %NULL if it is not kept
+ */
+const ValaPanelHistoryBucket *vala_panel_history_get(ValaPanelHistory *self,
+                                                     ValaPanelHistoryLevel level, gint64 index);
+/* Multiplies stored values, for writers which normalize by a changing maximum */
+void vala_panel_history_scale(ValaPanelHistory *self, double factor);
+/* Value which 1.0 stands for, owned by the writer. Zero in new files. */
+double vala_panel_history_get_full_scale(ValaPanelHistory *self);
+void vala_panel_history_set_full_scale(ValaPanelHistory *self, double full_scale);
+
+G_END_DECLS
+
+#endif // HISTORY_H
@@ -0,0 +1,332 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <linux/if_link.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "netlink.h"
+
+/* Kernel builds dump replies in chunks of at most 32 KiB, so every one fits */
+#define NETLINK_BUFFER_SIZE 32768
+
+typedef void (*NetlinkFunc)(struct nlmsghdr *msg, GArray *links, uint *hint);
+
+/*
+ * Sockets
+ */
+
+static int netlink_socket(int protocol, int flags, guint32 groups)
+{
+	int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | flags, protocol);
+	if (fd < 0)
+		return -1;
+	struct sockaddr_nl addr = { .nl_family = AF_NETLINK, .nl_groups = groups };
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+bool vala_panel_netlink_open(ValaPanelNetlink *self)
+{
+	self->fd        = netlink_socket(NETLINK_ROUTE, 0, 0);
+	self->events_fd = netlink_socket(NETLINK_ROUTE, SOCK_NONBLOCK, RTMGRP_LINK);
+	if (self->fd < 0 || self->events_fd < 0)
+	{
+		vala_panel_netlink_close(self);
+		return false;
+	}
+	self->buf    = g_malloc(NETLINK_BUFFER_SIZE);
+	self->size   = NETLINK_BUFFER_SIZE;
+	self->seq    = 0;
+	self->legacy = false;
+	return true;
+}
+
+void vala_panel_netlink_close(ValaPanelNetlink *self)
+{
+	if (self->fd >= 0)
+		close(self->fd);
+	if (self->events_fd >= 0)
+		close(self->events_fd);
+	self->fd = self->events_fd = -1;
+	g_clear_pointer(&self->buf, g_free);
+	self->size = 0;
+}
+
+/*
+ * Link table
+ */
+
+/* Dumps come in the order of the table, so search starts after the last match */
+static ValaPanelNetSample *lookup_index(GArray *links, int index, uint *hint)
+{
+	for (uint n = 0; n < links->len; n++)
+	{
+		uint i                   = (*hint + n) % links->len;
+		ValaPanelNetSample *link = &g_array_index(links, ValaPanelNetSample, i);
+		if (link->index == index)
+		{
+			*hint = i + 1;
+			return link;
+		}
+	}
+	return NULL;
+}
+
+/* Newer kernels append fields to the structure, only the leading byte counts are read */
+static void set_counters(ValaPanelNetSample *link, struct rtattr *attr)
+{
+	const char *stats = RTA_DATA(attr);
+	if (RTA_PAYLOAD(attr) < offsetof(struct rtnl_link_stats64, tx_bytes) + sizeof(guint64))
+		return;
+	/* Attributes are only 4-byte aligned */
+	memcpy(&link->rx_bytes,
+	       stats + offsetof(struct rtnl_link_stats64, rx_bytes),
+	       sizeof(guint64));
+	memcpy(&link->tx_bytes,
+	       stats + offsetof(struct rtnl_link_stats64, tx_bytes),
+	       sizeof(guint64));
+}
+
+static void apply_link(struct nlmsghdr *msg, GArray *links, uint *hint)
+{
+	if (msg->nlmsg_type != RTM_NEWLINK && msg->nlmsg_type != RTM_DELLINK)
+		return;
+	if (msg->nlmsg_len < NLMSG_LENGTH(sizeof(struct ifinfomsg)))
+		return;
+	struct ifinfomsg *ifi    = NLMSG_DATA(msg);
+	ValaPanelNetSample *link = lookup_index(links, ifi->ifi_index, hint);
+	if (msg->nlmsg_type == RTM_DELLINK)
+	{
+		ValaPanelNetSample *first = (ValaPanelNetSample *)links->data;
+		if (link != NULL)
+			g_array_remove_index(links, (uint)(link - first));
+		*hint = 0;
+		return;
+	}
+	if (link == NULL)
+	{
+		ValaPanelNetSample added = { .index = ifi->ifi_index };
+		g_array_append_val(links, added);
+		link  = &g_array_index(links, ValaPanelNetSample, links->len - 1);
+		*hint = links->len;
+	}
+	/* Operational state, an administratively up link may still have no carrier */
+	link->up = (ifi->ifi_flags & IFF_RUNNING) != 0;
+	int len  = (int)IFLA_PAYLOAD(msg);
+	for (struct rtattr *attr = IFLA_RTA(ifi); RTA_OK(attr, len); attr = RTA_NEXT(attr, len))
+	{
+		if (attr->rta_type == IFLA_IFNAME)
+		{
+			/* Renames arrive as a new name for the same index */
+			size_t name_len = MIN(RTA_PAYLOAD(attr), VALA_PANEL_SAMPLE_IFNAME_SIZE - 1);
+			memcpy(link->name, RTA_DATA(attr), name_len);
+			link->name[name_len] = '\0';
+		}
+		else if (attr->rta_type == IFLA_STATS64)
+			set_counters(link, attr);
+	}
+}
+
+#ifdef RTM_GETSTATS
+static void apply_stats(struct nlmsghdr *msg, GArray *links, uint *hint)
+{
+	if (msg->nlmsg_type != RTM_NEWSTATS ||
+	    msg->nlmsg_len < NLMSG_LENGTH(sizeof(struct if_stats_msg)))
+		return;
+	struct if_stats_msg *ifsm = NLMSG_DATA(msg);
+	ValaPanelNetSample *link  = lookup_index(links, (int)ifsm->ifindex, hint);
+	if (link == NULL)
+		return;
+	int len             = (int)(msg->nlmsg_len - NLMSG_LENGTH(sizeof(struct if_stats_msg)));
+	struct rtattr *attr = (struct rtattr *)((char *)ifsm + NLMSG_ALIGN(sizeof(*ifsm)));
+	for (; RTA_OK(attr, len); attr = RTA_NEXT(attr, len))
+		if (attr->rta_type == IFLA_STATS_LINK_64)
+			set_counters(link, attr);
+}
+#endif
+
+/*
+ * Requests
+ */
+
+/* Returns 0 or negative errno, as kernel reports it */
+static int netlink_dump(ValaPanelNetlink *self, struct nlmsghdr *req, NetlinkFunc func,
+                        GArray *links)
+{
+	struct sockaddr_nl kernel = { .nl_family = AF_NETLINK };
+	struct sockaddr *addr     = (struct sockaddr *)&kernel;
+	req->nlmsg_flags          = NLM_F_REQUEST | NLM_F_DUMP;
+	req->nlmsg_seq            = ++self->seq;
+	while (sendto(self->fd, req, req->nlmsg_len, 0, addr, sizeof(kernel)) < 0)
+		if (errno != EINTR)
+			return -errno;
+	uint hint = 0;
+	while (true)
+	{
+		ssize_t res = recv(self->fd, self->buf, self->size, 0);
+		if (res < 0 && errno == EINTR)
+			continue;
+		if (res <= 0)
+			return res < 0 ? -errno : -EIO;
+		int len              = (int)res;
+		struct nlmsghdr *msg = (struct nlmsghdr *)self->buf;
+		for (; NLMSG_OK(msg, len); msg = NLMSG_NEXT(msg, len))
+		{
+			/* Rest of a request abandoned on error */
+			if (msg->nlmsg_seq != self->seq)
+				continue;
+			if (msg->nlmsg_type == NLMSG_DONE)
+				return 0;
+			if (msg->nlmsg_type == NLMSG_ERROR)
+			{
+				struct nlmsgerr *err = NLMSG_DATA(msg);
+				return err->error != 0 ? err->error : -EIO;
+			}
+			func(msg, links, &hint);
+		}
+	}
+}
+
+bool vala_panel_netlink_request_links(ValaPanelNetlink *self, GArray *links)
+{
+	struct
+	{
+		struct nlmsghdr hdr;
+		struct ifinfomsg ifi;
+	} req = {
+		.hdr.nlmsg_len  = NLMSG_LENGTH(sizeof(struct ifinfomsg)),
+		.hdr.nlmsg_type = RTM_GETLINK,
+		.ifi.ifi_family = AF_UNSPEC,
+	};
+	g_array_set_size(links, 0);
+	return netlink_dump(self, &req.hdr, apply_link, links) == 0;
+}
+
+bool vala_panel_netlink_request_stats(ValaPanelNetlink *self, GArray *links)
+{
+#ifdef RTM_GETSTATS
+	if (!self->legacy)
+	{
+		/* Only 64-bit link counters, which is a fraction of a full link dump */
+		struct
+		{
+			struct nlmsghdr hdr;
+			struct if_stats_msg ifsm;
+		} req = {
+			.hdr.nlmsg_len    = NLMSG_LENGTH(sizeof(struct if_stats_msg)),
+			.hdr.nlmsg_type   = RTM_GETSTATS,
+			.ifsm.family      = AF_UNSPEC,
+			.ifsm.filter_mask = IFLA_STATS_FILTER_BIT(IFLA_STATS_LINK_64),
+		};
+		int res = netlink_dump(self, &req.hdr, apply_stats, links);
+		/* Kernels before 4.7 do not know the request */
+		if (res != -EOPNOTSUPP && res != -EINVAL)
+			return res == 0;
+		self->legacy = true;
+	}
+#endif
+	return vala_panel_netlink_request_links(self, links);
+}
+
+bool vala_panel_netlink_read_events(ValaPanelNetlink *self, GArray *links)
+{
+	uint hint = 0;
+	while (true)
+	{
+		ssize_t res = recv(self->events_fd, self->buf, self->size, 0);
+		if (res < 0 && errno == EINTR)
+			continue;
+		if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return true;
+		/* Queue overran while main loop was busy, so the table may be stale */
+		if (res < 0 && errno == ENOBUFS)
+			return vala_panel_netlink_request_links(self, links);
+		if (res <= 0)
+			return false;
+		int len              = (int)res;
+		struct nlmsghdr *msg = (struct nlmsghdr *)self->buf;
+		for (; NLMSG_OK(msg, len); msg = NLMSG_NEXT(msg, len))
+			apply_link(msg, links, &hint);
+	}
+}
+
+/*
+ * Uevents
+ */
+
+/* Kernel multicasts uevents to group 1, udev rebroadcasts its own ones to group 2 */
+#define UEVENT_KERNEL_GROUP 1
+/* As UEVENT_BUFFER_SIZE of the kernel, plus room for the header line */
+#define UEVENT_BUFFER_SIZE 4096
+
+int vala_panel_uevent_open(void)
+{
+	return netlink_socket(NETLINK_KOBJECT_UEVENT, SOCK_NONBLOCK, UEVENT_KERNEL_GROUP);
+}
+
+/* Message is "action@devpath" followed by NUL separated KEY=value pairs */
+static bool uevent_has_subsystem(const char *buf, size_t len, const char *subsystem)
+{
+	size_t subsystem_len = strlen(subsystem);
+	for (const char *p = buf, *end = buf + len; p < end; p += strlen(p) + 1)
+		if (g_str_has_prefix(p, "SUBSYSTEM=") && strlen(p) == subsystem_len + 10 &&
+		    !memcmp(p + 10, subsystem, subsystem_len))
+			return true;
+	return false;
+}
+
+bool vala_panel_uevent_read(int fd, const char *subsystem)
+{
+	char buf[UEVENT_BUFFER_SIZE + 1];
+	bool found = false;
+	while (true)
+	{
+		struct sockaddr_nl addr = { 0 };
+		socklen_t addr_len      = sizeof(addr);
+		ssize_t res =
+		    recvfrom(fd, buf, UEVENT_BUFFER_SIZE, 0, (struct sockaddr *)&addr, &addr_len);
+		if (res < 0 && errno == EINTR)
+			continue;
+		if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return found;
+		/* Lost events may have been the interesting ones */
+		if (res < 0 && errno == ENOBUFS)
+		{
+			found = true;
+			continue;
+		}
+		if (res <= 0)
+			return found;
+		/* Only the kernel speaks for devices */
+		if (addr.nl_pid != 0)
+			continue;
+		buf[res] = '\0';
+		found    = found || uevent_has_subsystem(buf, (size_t)res, subsystem);
+	}
+}
@@ -0,0 +1,103 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NETLINK_H
+#define NETLINK_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "procfs.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Route netlink connection for interface counters. Requests are answered
+ * into a buffer allocated once on open, and 64-bit counters of all links
+ * arrive in one dump instead of a text file to parse.
+ *
+ * Link tables are GArrays of ValaPanelNetSample, kept in kernel order and
+ * updated in place, so they only reallocate when interfaces appear.
+ */
+typedef struct
+{
+	int fd;        /* Request socket */
+	int events_fd; /* Joined to link multicast group, nonblocking */
+	guint32 seq;
+	char *buf;
+	size_t size;
+	bool legacy; /* Kernel has no RTM_GETSTATS, counters come with full link dumps */
+} ValaPanelNetlink;
+
+bool vala_panel_netlink_open(ValaPanelNetlink *self);
+void vala_panel_netlink_close(ValaPanelNetlink *self);
+/**
+ * vala_panel_netlink_request_links:
+ * @self: an open #ValaPanelNetlink
+ * @links: (element-type ValaPanelNetSample): link table to fill
+ *
+ * Replaces @links with every link the kernel has, with names, states and
+ * counters. Needed once after open, later events keep the table current.
+ *
+ * Returns: %FALSE on socket error
+ */
+bool vala_panel_netlink_request_links(ValaPanelNetlink *self, GArray *links);
+/**
+ * vala_panel_netlink_request_stats:
+ * @self: an open #ValaPanelNetlink
+ * @links: (element-type ValaPanelNetSample): link table to update
+ *
+ * Refreshes counters of every link in @links with one dump request. Links
+ * unknown to @links are skipped, their RTM_NEWLINK event is still pending.
+ *
+ * Returns: %FALSE on socket error
+ */
+bool vala_panel_netlink_request_stats(ValaPanelNetlink *self, GArray *links);
+/**
+ * vala_panel_netlink_read_events:
+ * @self: an open #ValaPanelNetlink
+ * @links: (element-type ValaPanelNetSample): link table to update
+ *
+ * Applies pending link events: new links, state changes, renames and
+ * removals. When events were lost, @links is requested again.
+ *
+ * Returns: %FALSE on socket error
+ */
+bool vala_panel_netlink_read_events(ValaPanelNetlink *self, GArray *links);
+
+/*
+ * Kernel uevent socket, the one udev listens to, for reacting to device
+ * changes like plugging a charger without polling sysfs.
+ */
+int vala_panel_uevent_open(void);
+/**
+ * vala_panel_uevent_read:
+ * @fd: a socket from vala_panel_uevent_open()
+ * @subsystem: subsystem of interest, like "power_supply"
+ *
+ * Drains pending uevents. A queue overrun counts as a match, as the lost
+ * events may have been of @subsystem.
+ *
+ * Returns: %TRUE if some event was of @subsystem
+ */
+bool vala_panel_uevent_read(int fd, const char *subsystem);
+
+G_END_DECLS
+
+#endif // NETLINK_H
@@ -0,0 +1,215 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "power.h"
+
+#define POWER_BUFFER_SIZE 32 /* Holds any number or status sysfs prints */
+
+/*
+ * Scanning
+ */
+
+static char *read_attribute(const char *dir, const char *name)
+{
+	g_autofree char *path = g_build_filename(dir, name, NULL);
+	char *contents        = NULL;
+	if (!g_file_get_contents(path, &contents, NULL, NULL))
+		return NULL;
+	return g_strstrip(contents);
+}
+
+static int compare_names(const void *a, const void *b)
+{
+	return g_strcmp0(*(const char *const *)a, *(const char *const *)b);
+}
+
+static GPtrArray *list_class(const char *root, const char *class)
+{
+	g_autofree char *class_dir = g_build_filename(root, "class", class, NULL);
+	g_autoptr(GDir) dir        = g_dir_open(class_dir, 0, NULL);
+	GPtrArray *paths           = g_ptr_array_new_with_free_func(g_free);
+	const char *name;
+	while (dir != NULL && (name = g_dir_read_name(dir)) != NULL)
+		g_ptr_array_add(paths, g_build_filename(class_dir, name, NULL));
+	/* Packages and batteries should keep their order between opens */
+	g_ptr_array_sort(paths, compare_names);
+	return paths;
+}
+
+/* Top level RAPL zones are "intel-rapl:N", also on AMD, subzones have a second ':' */
+static bool is_package_zone(const char *path)
+{
+	g_autofree char *base = g_path_get_basename(path);
+	g_autofree char *name = NULL;
+	if (!g_str_has_prefix(base, "intel-rapl:") || strchr(base + 11, ':') != NULL)
+		return false;
+	/* Platform zone "psys" already covers packages */
+	name = read_attribute(path, "name");
+	return name != NULL && g_str_has_prefix(name, "package");
+}
+
+static void scan_zones(const char *root, GArray *zones)
+{
+	g_autoptr(GPtrArray) paths = list_class(root, "powercap");
+	for (uint i = 0; i < paths->len; i++)
+	{
+		const char *path        = g_ptr_array_index(paths, i);
+		ValaPanelPowerZone zone = { .energy = { .fd = -1 } };
+		g_autofree char *range  = NULL;
+		g_autofree char *energy = NULL;
+		gint64 value;
+		if (!is_package_zone(path))
+			continue;
+		range = read_attribute(path, "max_energy_range_uj");
+		if (range == NULL || !vala_panel_proc_parse_int(range, strlen(range), &value) ||
+		    value <= 0)
+			continue;
+		zone.range = (guint64)value;
+		energy     = g_build_filename(path, "energy_uj", NULL);
+		/* Since CVE-2020-8694 energy_uj is readable by root only */
+		if (vala_panel_proc_file_open(&zone.energy, energy, POWER_BUFFER_SIZE, false))
+			g_array_append_val(zones, zone);
+	}
+}
+
+static void open_supply_file(ValaPanelProcFile *file, const char *dir, const char *name)
+{
+	g_autofree char *path = g_build_filename(dir, name, NULL);
+	file->fd              = -1;
+	vala_panel_proc_file_open(file, path, POWER_BUFFER_SIZE, false);
+}
+
+static void scan_batteries(const char *root, GArray *batteries)
+{
+	g_autoptr(GPtrArray) paths = list_class(root, "power_supply");
+	for (uint i = 0; i < paths->len; i++)
+	{
+		const char *path         = g_ptr_array_index(paths, i);
+		g_autofree char *type    = read_attribute(path, "type");
+		g_autofree char *scope   = read_attribute(path, "scope");
+		ValaPanelBattery battery = { 0 };
+		/* Mice and headsets have batteries too, but do not power the system */
+		if (g_strcmp0(type, "Battery") || !g_strcmp0(scope, "Device"))
+			continue;
+		open_supply_file(&battery.status, path, "status");
+		if (battery.status.fd < 0)
+			continue;
+		open_supply_file(&battery.power, path, "power_now");
+		battery.current.fd = battery.voltage.fd = -1;
+		if (battery.power.fd < 0)
+		{
+			open_supply_file(&battery.current, path, "current_now");
+			open_supply_file(&battery.voltage, path, "voltage_now");
+		}
+		g_array_append_val(batteries, battery);
+	}
+}
+
+/*
+ * Power
+ */
+
+bool vala_panel_power_open(ValaPanelPower *self, const char *root)
+{
+	GArray *zones     = g_array_new(false, false, sizeof(ValaPanelPowerZone));
+	GArray *batteries = g_array_new(false, false, sizeof(ValaPanelBattery));
+	scan_zones(root, zones);
+	scan_batteries(root, batteries);
+	self->n_zones     = zones->len;
+	self->n_batteries = batteries->len;
+	self->zones       = (ValaPanelPowerZone *)(void *)g_array_free(zones, false);
+	self->batteries   = (ValaPanelBattery *)(void *)g_array_free(batteries, false);
+	self->energy_uj   = 0;
+	if (self->n_zones == 0 && self->n_batteries == 0)
+	{
+		vala_panel_power_close(self);
+		return false;
+	}
+	return true;
+}
+
+static bool read_int(ValaPanelProcFile *file, gint64 *value)
+{
+	return file->fd >= 0 && vala_panel_proc_file_read(file) &&
+	       vala_panel_proc_parse_int(file->buf, file->len, value);
+}
+
+static void read_zone(ValaPanelPower *self, ValaPanelPowerZone *zone)
+{
+	gint64 value;
+	if (!read_int(&zone->energy, &value) || value < 0)
+		return;
+	guint64 energy = (guint64)value;
+	/* Counter wraps at max_energy_range_uj, every minute or so on big servers */
+	if (zone->primed)
+		self->energy_uj += energy >= zone->last ? energy - zone->last
+		                                        : energy + zone->range - zone->last;
+	zone->last   = energy;
+	zone->primed = true;
+}
+
+/* Returns: discharge rate in watts, or a negative value if not discharging */
+static double read_battery(ValaPanelBattery *battery)
+{
+	gint64 power, current, voltage;
+	if (battery->status.fd < 0 || !vala_panel_proc_file_read(&battery->status) ||
+	    !g_str_has_prefix(battery->status.buf, "Discharging"))
+		return -1.0;
+	/* Some firmware reports negative values while discharging */
+	if (read_int(&battery->power, &power))
+		return ABS(power) / 1e6;
+	if (read_int(&battery->current, &current) && read_int(&battery->voltage, &voltage))
+		return ABS(current) / 1e6 * (ABS(voltage) / 1e6);
+	return 0.0;
+}
+
+void vala_panel_power_read(ValaPanelPower *self, ValaPanelPowerSample *sample)
+{
+	memset(sample, 0, sizeof(*sample));
+	for (uint i = 0; i < self->n_zones; i++)
+		read_zone(self, &self->zones[i]);
+	for (uint i = 0; i < self->n_batteries; i++)
+	{
+		double watts = read_battery(&self->batteries[i]);
+		if (watts < 0)
+			continue;
+		sample->battery_watts += watts;
+		sample->on_battery = true;
+	}
+	sample->energy_uj   = self->energy_uj;
+	sample->has_energy  = self->n_zones > 0;
+	sample->has_battery = self->n_batteries > 0;
+}
+
+void vala_panel_power_close(ValaPanelPower *self)
+{
+	for (uint i = 0; self->zones != NULL && i < self->n_zones; i++)
+		vala_panel_proc_file_close(&self->zones[i].energy);
+	for (uint i = 0; self->batteries != NULL && i < self->n_batteries; i++)
+	{
+		vala_panel_proc_file_close(&self->batteries[i].power);
+		vala_panel_proc_file_close(&self->batteries[i].current);
+		vala_panel_proc_file_close(&self->batteries[i].voltage);
+		vala_panel_proc_file_close(&self->batteries[i].status);
+	}
+	g_clear_pointer(&self->zones, g_free);
+	g_clear_pointer(&self->batteries, g_free);
+	self->n_zones = self->n_batteries = 0;
+}
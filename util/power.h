@@ -0,0 +1,78 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <glib.h>
+#include <stdbool.h>
+
+#include "procfs.h"
+
+G_BEGIN_DECLS
+
+/* Energy and battery state, as seen by the power monitor */
+typedef struct
+{
+	guint64 energy_uj;    /* Of all packages since open, corrected for counter wraps */
+	double battery_watts; /* Drawn from batteries, zero while charging or full */
+	bool has_energy;      /* Some RAPL package is readable, which often needs root */
+	bool has_battery;
+	bool on_battery; /* Some battery is discharging */
+} ValaPanelPowerSample;
+
+/* RAPL package zone of powercap */
+typedef struct
+{
+	ValaPanelProcFile energy; /* energy_uj */
+	guint64 range;            /* max_energy_range_uj, where energy_uj wraps to zero */
+	guint64 last;
+	bool primed;
+} ValaPanelPowerZone;
+
+/* System battery of power_supply, peripheral ones are left out */
+typedef struct
+{
+	ValaPanelProcFile power;   /* power_now in uW, closed if battery only reports current */
+	ValaPanelProcFile current; /* current_now in uA */
+	ValaPanelProcFile voltage; /* voltage_now in uV */
+	ValaPanelProcFile status;  /* Like "Discharging" */
+} ValaPanelBattery;
+
+/*
+ * Power sources found under a sysfs root, like /sys, with every file kept
+ * open like in #ValaPanelSensors. Subzones of packages, like core and
+ * uncore, and platform zones are skipped, as packages already count them.
+ */
+typedef struct
+{
+	ValaPanelPowerZone *zones;
+	uint n_zones;
+	ValaPanelBattery *batteries;
+	uint n_batteries;
+	guint64 energy_uj;
+} ValaPanelPower;
+
+/* Returns: %FALSE if there are neither RAPL packages nor batteries */
+bool vala_panel_power_open(ValaPanelPower *self, const char *root);
+void vala_panel_power_read(ValaPanelPower *self, ValaPanelPowerSample *sample);
+void vala_panel_power_close(ValaPanelPower *self);
+
+G_END_DECLS
+
+#endif // POWER_H
@@ -0,0 +1,661 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <string.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+
+#include "procfs.h"
+
+/*
+ * Files
+ */
+
+bool vala_panel_proc_file_open(ValaPanelProcFile *self, const char *path, size_t size, bool grow)
+{
+	self->fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (self->fd < 0)
+		return false;
+	self->buf  = g_malloc(size + 1);
+	self->size = size;
+	self->len  = 0;
+	self->grow = grow;
+	return true;
+}
+
+/* seq_file content is regenerated on every read at offset 0 */
+bool vala_panel_proc_file_read(ValaPanelProcFile *self)
+{
+	size_t len = 0;
+	while (true)
+	{
+		if (len == self->size)
+		{
+			if (!self->grow)
+				break;
+			self->size *= 2;
+			self->buf = g_realloc(self->buf, self->size + 1);
+		}
+		ssize_t res = pread(self->fd, self->buf + len, self->size - len, (off_t)len);
+		if (res < 0 && errno == EINTR)
+			continue;
+		if (res < 0)
+			return false;
+		if (res == 0)
+			break;
+		len += (size_t)res;
+	}
+	self->buf[len] = '\0';
+	self->len      = len;
+	return true;
+}
+
+#define PROC_SUPER_MAGIC 0x9fa0
+
+bool vala_panel_proc_file_open_trigger(ValaPanelProcFile *self, const char *path, size_t size,
+                                       const char *trigger)
+{
+	struct statfs fs;
+	self->fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+	if (self->fd < 0)
+		return false;
+	/* Kernel wants the terminating NUL too */
+	size_t trigger_len = strlen(trigger) + 1;
+	if (fstatfs(self->fd, &fs) < 0 || fs.f_type != PROC_SUPER_MAGIC ||
+	    write(self->fd, trigger, trigger_len) != (ssize_t)trigger_len)
+	{
+		close(self->fd);
+		self->fd = -1;
+		return false;
+	}
+	self->buf  = g_malloc(size + 1);
+	self->size = size;
+	self->len  = 0;
+	self->grow = false;
+	return true;
+}
+
+void vala_panel_proc_file_close(ValaPanelProcFile *self)
+{
+	if (self->fd >= 0)
+		close(self->fd);
+	self->fd = -1;
+	g_clear_pointer(&self->buf, g_free);
+	self->size = self->len = 0;
+}
+
+/*
+ * Scanners
+ */
+
+static inline const char *skip_blanks(const char *p, const char *end)
+{
+	while (p < end && (*p == ' ' || *p == '\t'))
+		p++;
+	return p;
+}
+
+static inline const char *next_line(const char *p, const char *end)
+{
+	const char *nl = memchr(p, '\n', (size_t)(end - p));
+	return nl != NULL ? nl + 1 : end;
+}
+
+/* Returns position after the number, or NULL if there is no number at p */
+static inline const char *scan_u64(const char *p, const char *end, guint64 *value)
+{
+	guint64 v = 0;
+	p         = skip_blanks(p, end);
+	if (p == end || (uint)(*p - '0') > 9)
+		return NULL;
+	while (p < end && (uint)(*p - '0') <= 9)
+		v = v * 10 + (guint64)(*p++ - '0');
+	*value = v;
+	return p;
+}
+
+static inline const char *skip_fields(const char *p, const char *end, uint n)
+{
+	for (uint i = 0; i < n; i++)
+	{
+		p = skip_blanks(p, end);
+		while (p < end && *p != ' ' && *p != '\t' && *p != '\n')
+			p++;
+	}
+	return p;
+}
+
+/*
+ * Samples
+ */
+
+/* Counters may step back a little, iowait on some kernels does */
+static inline double cpu_delta(guint64 current, guint64 previous)
+{
+	return current > previous ? (double)(current - previous) : 0.0;
+}
+
+double vala_panel_cpu_sample_load(const ValaPanelCpuSample *cpu,
+                                  const ValaPanelCpuSample *previous, double *states)
+{
+	double delta[VALA_PANEL_CPU_N_STATES];
+	delta[VALA_PANEL_CPU_USER]   = cpu_delta(cpu->user, previous->user);
+	delta[VALA_PANEL_CPU_NICE]   = cpu_delta(cpu->nice, previous->nice);
+	delta[VALA_PANEL_CPU_SYSTEM] = cpu_delta(cpu->system, previous->system);
+	delta[VALA_PANEL_CPU_IRQ] =
+	    cpu_delta(cpu->irq, previous->irq) + cpu_delta(cpu->softirq, previous->softirq);
+	delta[VALA_PANEL_CPU_STEAL]  = cpu_delta(cpu->steal, previous->steal);
+	delta[VALA_PANEL_CPU_IOWAIT] = cpu_delta(cpu->iowait, previous->iowait);
+	/* Guest time is already counted in user and nice */
+	double busy = 0.0;
+	for (uint i = 0; i < VALA_PANEL_CPU_IOWAIT; i++)
+		busy += delta[i];
+	double total = busy + delta[VALA_PANEL_CPU_IOWAIT] + cpu_delta(cpu->idle, previous->idle);
+	for (uint i = 0; states != NULL && i < VALA_PANEL_CPU_N_STATES; i++)
+		states[i] = total > 0.0 ? delta[i] / total : 0.0;
+	return total > 0.0 ? busy / total : 0.0;
+}
+
+/*
+ * Parsers
+ */
+
+#define STAT_MIN_FIELDS 4 /* Before 2.6, only user, nice, system and idle */
+
+/* Scans fields of one cpu line into @cpu, returns position after them */
+static const char *scan_cpu_fields(const char *p, const char *end, ValaPanelCpuSample *cpu)
+{
+	guint64 fields[10] = { 0 };
+	for (uint i = 0; i < G_N_ELEMENTS(fields); i++)
+	{
+		const char *next = scan_u64(p, end, &fields[i]);
+		if (next == NULL && i < STAT_MIN_FIELDS)
+			return NULL;
+		if (next == NULL)
+			break;
+		p = next;
+	}
+	cpu->user       = fields[0];
+	cpu->nice       = fields[1];
+	cpu->system     = fields[2];
+	cpu->idle       = fields[3];
+	cpu->iowait     = fields[4];
+	cpu->irq        = fields[5];
+	cpu->softirq    = fields[6];
+	cpu->steal      = fields[7];
+	cpu->guest      = fields[8];
+	cpu->guest_nice = fields[9];
+	return p;
+}
+
+bool vala_panel_proc_parse_stat(const char *buf, size_t len, ValaPanelCpuSample *cpu)
+{
+	/* Aggregate line always goes first */
+	if (len < 4 || memcmp(buf, "cpu ", 4))
+		return false;
+	return scan_cpu_fields(buf + 4, buf + len, cpu) != NULL;
+}
+
+uint vala_panel_proc_parse_stat_cores(const char *buf, size_t len, ValaPanelCpuSample *cpu,
+                                      ValaPanelCpuSample *cores, uint n_cores)
+{
+	const char *end = buf + len;
+	uint count      = 0;
+	if (!vala_panel_proc_parse_stat(buf, len, cpu))
+		return 0;
+	/* Lines of cores go right after the aggregate one, ascending, offline cores are absent */
+	for (const char *p = next_line(buf, end); end - p > 3 && !memcmp(p, "cpu", 3);
+	     p = next_line(p, end))
+	{
+		guint64 n;
+		ValaPanelCpuSample core;
+		const char *q = scan_u64(p + 3, end, &n);
+		if (q == NULL || scan_cpu_fields(q, end, &core) == NULL)
+			continue;
+		if (n < count || n >= G_MAXUINT)
+			continue;
+		for (uint i = count; i < MIN(n, n_cores); i++)
+			memset(&cores[i], 0, sizeof(ValaPanelCpuSample));
+		if (n < n_cores)
+			cores[n] = core;
+		count = (uint)n + 1;
+	}
+	return count;
+}
+
+#define MEMINFO_KEY(key, field)                                                                    \
+	{                                                                                          \
+		key, sizeof(key) - 1, G_STRUCT_OFFSET(ValaPanelMemSample, field)                   \
+	}
+
+static const struct
+{
+	const char *key; /* Including colon */
+	size_t len;
+	size_t offset;
+} meminfo_keys[] = {
+	MEMINFO_KEY("MemTotal:", mem_total),     MEMINFO_KEY("MemAvailable:", mem_available),
+	MEMINFO_KEY("SwapCached:", swap_cached), MEMINFO_KEY("SwapTotal:", swap_total),
+	MEMINFO_KEY("SwapFree:", swap_free),
+};
+
+bool vala_panel_proc_parse_meminfo(const char *buf, size_t len, ValaPanelMemSample *mem)
+{
+	const char *end = buf + len;
+	uint readmask   = (1u << G_N_ELEMENTS(meminfo_keys)) - 1;
+	for (const char *p = buf; readmask != 0 && p < end; p = next_line(p, end))
+	{
+		for (uint i = 0; i < G_N_ELEMENTS(meminfo_keys); i++)
+		{
+			if (!(readmask & (1u << i)) || (size_t)(end - p) < meminfo_keys[i].len ||
+			    memcmp(p, meminfo_keys[i].key, meminfo_keys[i].len))
+				continue;
+			guint64 *field = G_STRUCT_MEMBER_P(mem, meminfo_keys[i].offset);
+			if (scan_u64(p + meminfo_keys[i].len, end, field) != NULL)
+				readmask &= ~(1u << i);
+			break;
+		}
+	}
+	return readmask == 0;
+}
+
+/* Lines are "some avg10=0.00 avg60=0.00 avg300=0.00 total=1234", then "full ..." */
+bool vala_panel_proc_parse_pressure(const char *buf, size_t len, ValaPanelPsiSample *psi)
+{
+	const char *end = buf + len;
+	bool has_some   = false;
+	psi->full_total = 0;
+	for (const char *p = buf; p < end; p = next_line(p, end))
+	{
+		guint64 *field = NULL;
+		if ((size_t)(end - p) > 5 && !memcmp(p, "some ", 5))
+			field = &psi->some_total;
+		else if ((size_t)(end - p) > 5 && !memcmp(p, "full ", 5))
+			field = &psi->full_total;
+		else
+			continue;
+		const char *eol   = next_line(p, end);
+		const char *total = g_strstr_len(p, eol - p, "total=");
+		if (total == NULL || scan_u64(total + 6, eol, field) == NULL)
+			continue;
+		if (field == &psi->some_total)
+			has_some = true;
+	}
+	return has_some;
+}
+
+uint vala_panel_proc_parse_net_dev(const char *buf, size_t len, ValaPanelNetSample *net,
+                                   uint n_net)
+{
+	const char *end = buf + len;
+	const char *p   = buf;
+	uint count      = 0;
+	/* Ignore first two lines - header */
+	p = next_line(next_line(p, end), end);
+	for (; p < end; p = next_line(p, end))
+	{
+		const char *name  = skip_blanks(p, end);
+		const char *colon = name;
+		while (colon < end && *colon != ':' && *colon != '\n')
+			colon++;
+		if (colon == end || *colon != ':')
+			continue;
+		guint64 down, up;
+		const char *q = scan_u64(colon + 1, end, &down);
+		if (q == NULL)
+			continue;
+		/* Skip packets, errs, drop, fifo, frame, compressed, multicast */
+		q = skip_fields(q, end, 7);
+		if (scan_u64(q, end, &up) == NULL)
+			continue;
+		if (count < n_net)
+		{
+			size_t name_len = MIN((size_t)(colon - name), VALA_PANEL_SAMPLE_IFNAME_SIZE - 1);
+			memcpy(net[count].name, name, name_len);
+			net[count].name[name_len] = '\0';
+			net[count].rx_bytes       = down;
+			net[count].tx_bytes       = up;
+			net[count].index          = 0;
+			net[count].up             = true;
+		}
+		count++;
+	}
+	return count;
+}
+
+bool vala_panel_proc_parse_int(const char *buf, size_t len, gint64 *value)
+{
+	const char *end = buf + len;
+	const char *p   = skip_blanks(buf, end);
+	bool negative   = p < end && *p == '-';
+	guint64 v;
+	if (scan_u64(negative ? p + 1 : p, end, &v) == NULL)
+		return false;
+	*value = negative ? -(gint64)v : (gint64)v;
+	return true;
+}
+
+/* Fields after the device name, in order */
+enum
+{
+	DISK_READS         = 0,
+	DISK_SECTORS_READ  = 2,
+	DISK_WRITES        = 4,
+	DISK_SECTORS_WRITE = 6,
+	DISK_IO_TICKS      = 9,
+	DISK_TIME_IN_QUEUE = 10,
+	DISK_N_FIELDS
+};
+
+uint vala_panel_proc_parse_diskstats(const char *buf, size_t len, ValaPanelDiskSample *disks,
+                                     uint n_disks)
+{
+	const char *end = buf + len;
+	uint count      = 0;
+	for (const char *p = buf; p < end; p = next_line(p, end))
+	{
+		guint64 major, minor, f[DISK_N_FIELDS];
+		const char *q = scan_u64(p, end, &major);
+		if (q == NULL || (q = scan_u64(q, end, &minor)) == NULL)
+			continue;
+		const char *name = skip_blanks(q, end);
+		q                = name;
+		while (q < end && *q != ' ' && *q != '\t' && *q != '\n')
+			q++;
+		const char *name_end = q;
+		uint i;
+		for (i = 0; i < DISK_N_FIELDS && (q = scan_u64(q, end, &f[i])) != NULL; i++)
+			;
+		if (i < DISK_N_FIELDS || name_end == name)
+			continue;
+		if (count < n_disks)
+		{
+			ValaPanelDiskSample *disk = &disks[count];
+			size_t name_len =
+			    MIN((size_t)(name_end - name), VALA_PANEL_SAMPLE_DISKNAME_SIZE - 1);
+			memcpy(disk->name, name, name_len);
+			disk->name[name_len]  = '\0';
+			disk->reads           = f[DISK_READS];
+			disk->sectors_read    = f[DISK_SECTORS_READ];
+			disk->writes          = f[DISK_WRITES];
+			disk->sectors_written = f[DISK_SECTORS_WRITE];
+			disk->io_ticks        = f[DISK_IO_TICKS];
+			disk->time_in_queue   = f[DISK_TIME_IN_QUEUE];
+			disk->dev             = (guint)(major << 20 | minor);
+		}
+		count++;
+	}
+	return count;
+}
+
+/* Fields after the command name of /proc/[pid]/stat, counted from state */
+enum
+{
+	PID_UTIME     = 11,
+	PID_STIME     = 12,
+	PID_STARTTIME = 19,
+	PID_RSS       = 21,
+};
+
+bool vala_panel_proc_parse_pid_stat(const char *buf, size_t len, ValaPanelPidSample *pid)
+{
+	const char *end  = buf + len;
+	const char *comm = memchr(buf, '(', len);
+	const char *p    = end;
+	/* Command may contain anything, parentheses too, but is the only field which can */
+	while (p > buf && *(p - 1) != ')')
+		p--;
+	if (comm == NULL || p <= comm + 1)
+		return false;
+	size_t comm_len = MIN((size_t)(p - 1 - (comm + 1)), VALA_PANEL_SAMPLE_COMM_SIZE - 1);
+	guint64 utime, stime;
+	p = skip_fields(p, end, PID_UTIME);
+	if ((p = scan_u64(p, end, &utime)) == NULL || (p = scan_u64(p, end, &stime)) == NULL)
+		return false;
+	p = skip_fields(p, end, PID_STARTTIME - PID_STIME - 1);
+	if ((p = scan_u64(p, end, &pid->starttime)) == NULL)
+		return false;
+	p = skip_fields(p, end, PID_RSS - PID_STARTTIME - 1);
+	if (scan_u64(p, end, &pid->rss) == NULL)
+		return false;
+	memcpy(pid->comm, comm + 1, comm_len);
+	pid->comm[comm_len] = '\0';
+	pid->ticks          = utime + stime;
+	return true;
+}
+
+/* Values like memory.max are a number of bytes, or "max" */
+bool vala_panel_proc_parse_limit(const char *buf, size_t len, guint64 *value)
+{
+	const char *end = buf + len;
+	const char *p   = skip_blanks(buf, end);
+	if ((size_t)(end - p) >= 3 && !memcmp(p, "max", 3))
+	{
+		*value = G_MAXUINT64;
+		return true;
+	}
+	return scan_u64(p, end, value) != NULL;
+}
+
+/* Quota and period in microseconds, like "50000 100000", or "max 100000" */
+bool vala_panel_proc_parse_cpu_max(const char *buf, size_t len, double *cpus)
+{
+	const char *end = buf + len;
+	guint64 quota, period;
+	if (!vala_panel_proc_parse_limit(buf, len, &quota))
+		return false;
+	if (scan_u64(skip_fields(buf, end, 1), end, &period) == NULL || period == 0)
+		return false;
+	*cpus = quota == G_MAXUINT64 ? 0.0 : (double)quota / period;
+	return true;
+}
+
+#define CGROUP_KEY(key, field)                                                                     \
+	{                                                                                          \
+		key " ", sizeof(key), G_STRUCT_OFFSET(ValaPanelCgroupSample, field)                \
+	}
+
+typedef struct
+{
+	const char *key; /* Including separator, so that "oom" does not match "oom_kill" */
+	size_t len;
+	size_t offset;
+} CgroupKey;
+
+static const CgroupKey memory_events_keys[] = {
+	CGROUP_KEY("high", memory_high),
+	CGROUP_KEY("max", memory_limit),
+	CGROUP_KEY("oom_kill", oom_kill),
+};
+
+static const CgroupKey cpu_stat_keys[] = {
+	CGROUP_KEY("usage_usec", usage_usec),         CGROUP_KEY("user_usec", user_usec),
+	CGROUP_KEY("system_usec", system_usec),       CGROUP_KEY("nr_periods", nr_periods),
+	CGROUP_KEY("nr_throttled", nr_throttled),     CGROUP_KEY("throttled_usec", throttled_usec),
+};
+
+/* Flat keyed files, with a "key value" pair per line */
+static bool parse_cgroup_keys(const char *buf, size_t len, const CgroupKey *keys, uint n_keys,
+                              ValaPanelCgroupSample *cgroup)
+{
+	const char *end = buf + len;
+	bool found      = false;
+	for (const char *p = buf; p < end; p = next_line(p, end))
+	{
+		for (uint i = 0; i < n_keys; i++)
+		{
+			if ((size_t)(end - p) < keys[i].len || memcmp(p, keys[i].key, keys[i].len))
+				continue;
+			guint64 *field = G_STRUCT_MEMBER_P(cgroup, keys[i].offset);
+			found |= scan_u64(p + keys[i].len, end, field) != NULL;
+			break;
+		}
+	}
+	return found;
+}
+
+bool vala_panel_proc_parse_memory_events(const char *buf, size_t len,
+                                         ValaPanelCgroupSample *cgroup)
+{
+	return parse_cgroup_keys(buf,
+	                         len,
+	                         memory_events_keys,
+	                         G_N_ELEMENTS(memory_events_keys),
+	                         cgroup);
+}
+
+bool vala_panel_proc_parse_cpu_stat(const char *buf, size_t len, ValaPanelCgroupSample *cgroup)
+{
+	return parse_cgroup_keys(buf, len, cpu_stat_keys, G_N_ELEMENTS(cpu_stat_keys), cgroup);
+}
+
+/*
+ * Sample filters
+ */
+
+/* Samples of every kind start with a name, then any identity is mixed in */
+static inline guint sample_hash(guint hash, const char *name, guint id)
+{
+	return hash * 31 + (g_str_hash(name) ^ id);
+}
+
+guint vala_panel_net_digest(const ValaPanelNetSample *net, uint n_net)
+{
+	guint digest = n_net;
+	for (uint i = 0; i < n_net; i++)
+		digest = sample_hash(digest, net[i].name, (guint)net[i].index);
+	return digest;
+}
+
+guint vala_panel_disk_digest(const ValaPanelDiskSample *disks, uint n_disks)
+{
+	guint digest = n_disks;
+	for (uint i = 0; i < n_disks; i++)
+		digest = sample_hash(digest, disks[i].name, disks[i].dev);
+	return digest;
+}
+
+void vala_panel_sample_filter_init(ValaPanelSampleFilter *self, const char *patterns)
+{
+	self->name     = g_strdup(patterns);
+	self->patterns = g_strsplit(patterns, ",", -1);
+	for (char **pattern = self->patterns; *pattern != NULL; pattern++)
+		g_strstrip(*pattern);
+	self->positions = g_array_new(false, false, sizeof(uint));
+	self->rows      = g_string_new(NULL);
+	self->digest    = 0;
+	self->n_samples = 0;
+	self->valid     = false;
+}
+
+void vala_panel_sample_filter_clear(ValaPanelSampleFilter *self)
+{
+	g_clear_pointer(&self->name, g_free);
+	g_clear_pointer(&self->patterns, g_strfreev);
+	g_clear_pointer(&self->positions, g_array_unref);
+	if (self->rows != NULL)
+		g_string_free(self->rows, true);
+	self->rows  = NULL;
+	self->valid = false;
+}
+
+static bool sample_filter_match(const ValaPanelSampleFilter *self, const char *name)
+{
+	for (char **pattern = self->patterns; *pattern != NULL; pattern++)
+		if (**pattern != '\0' && fnmatch(*pattern, name, 0) == 0)
+			return true;
+	return false;
+}
+
+static inline void sample_filter_append_row(GString *rows, const char *name, size_t id_offset)
+{
+	g_string_append_len(rows, name, (gssize)strlen(name) + 1);
+	g_string_append_len(rows, name + id_offset, sizeof(guint));
+}
+
+/* Digest may collide, so matching rows are also checked to be where they were */
+static bool sample_filter_rows_kept(const ValaPanelSampleFilter *self, const char *samples,
+                                    size_t stride, size_t id_offset)
+{
+	const char *row = self->rows->str;
+	const char *end = row + self->rows->len;
+	for (uint i = 0; i < self->positions->len; i++)
+	{
+		const char *name = samples + g_array_index(self->positions, uint, i) * stride;
+		size_t len       = strlen(name) + 1;
+		if ((size_t)(end - row) < len + sizeof(guint) || memcmp(row, name, len) != 0 ||
+		    memcmp(row + len, name + id_offset, sizeof(guint)) != 0)
+			return false;
+		row += len + sizeof(guint);
+	}
+	return row == end;
+}
+
+/* Samples are an array of any kind, id_offset points to guint identity in them */
+static bool sample_filter_update(ValaPanelSampleFilter *self, const char *samples, size_t stride,
+                                 size_t id_offset, uint n_samples, guint digest)
+{
+	if (self->valid && digest == self->digest && n_samples == self->n_samples &&
+	    sample_filter_rows_kept(self, samples, stride, id_offset))
+		return false;
+	GString *rows = g_string_sized_new(self->rows->len);
+	g_array_set_size(self->positions, 0);
+	for (uint i = 0; i < n_samples; i++)
+	{
+		const char *name = samples + i * stride;
+		if (!sample_filter_match(self, name))
+			continue;
+		g_array_append_val(self->positions, i);
+		sample_filter_append_row(rows, name, id_offset);
+	}
+	bool changed = !self->valid || rows->len != self->rows->len ||
+	               memcmp(rows->str, self->rows->str, rows->len) != 0;
+	g_string_free(self->rows, true);
+	self->rows      = rows;
+	self->digest    = digest;
+	self->n_samples = n_samples;
+	self->valid     = true;
+	return changed;
+}
+
+bool vala_panel_sample_filter_update_net(ValaPanelSampleFilter *self,
+                                         const ValaPanelNetSample *net, uint n_net,
+                                         guint digest)
+{
+	return sample_filter_update(self,
+	                            (const char *)net,
+	                            sizeof(*net),
+	                            offsetof(ValaPanelNetSample, index),
+	                            n_net,
+	                            digest);
+}
+
+bool vala_panel_sample_filter_update_disks(ValaPanelSampleFilter *self,
+                                           const ValaPanelDiskSample *disks, uint n_disks,
+                                           guint digest)
+{
+	return sample_filter_update(self,
+	                            (const char *)disks,
+	                            sizeof(*disks),
+	                            offsetof(ValaPanelDiskSample, dev),
+	                            n_disks,
+	                            digest);
+}
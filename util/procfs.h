@@ -0,0 +1,275 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROCFS_H
+#define PROCFS_H
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+G_BEGIN_DECLS
+
+#define VALA_PANEL_SAMPLE_IFNAME_SIZE 16
+#define VALA_PANEL_SAMPLE_DISKNAME_SIZE 32
+#define VALA_PANEL_SAMPLE_COMM_SIZE 16 /* TASK_COMM_LEN */
+
+/* Jiffies from a "cpu" line of /proc/stat, fields missing on old kernels are zero */
+typedef struct
+{
+	guint64 user; /* Includes guest */
+	guint64 nice; /* Includes guest_nice */
+	guint64 system;
+	guint64 idle;
+	guint64 iowait;
+	guint64 irq;
+	guint64 softirq;
+	guint64 steal;
+	guint64 guest;
+	guint64 guest_nice;
+} ValaPanelCpuSample;
+
+/* States shown by CPU graphs, stacked from bottom to top */
+typedef enum
+{
+	VALA_PANEL_CPU_USER   = 0,
+	VALA_PANEL_CPU_NICE   = 1,
+	VALA_PANEL_CPU_SYSTEM = 2,
+	VALA_PANEL_CPU_IRQ    = 3, /* Hard and soft interrupts */
+	VALA_PANEL_CPU_STEAL  = 4,
+	VALA_PANEL_CPU_IOWAIT = 5,
+	VALA_PANEL_CPU_N_STATES
+} ValaPanelCpuState;
+
+/* Fields of /proc/meminfo, in kB */
+typedef struct
+{
+	guint64 mem_total;
+	guint64 mem_available;
+	guint64 swap_total;
+	guint64 swap_free;
+	guint64 swap_cached;
+} ValaPanelMemSample;
+
+/* Byte counters of one interface, from netlink or /proc/net/dev */
+typedef struct
+{
+	char name[VALA_PANEL_SAMPLE_IFNAME_SIZE];
+	guint64 rx_bytes;
+	guint64 tx_bytes;
+	int index; /* Kernel interface index, 0 when read from /proc/net/dev */
+	bool up;   /* Link is operational, always %TRUE when read from /proc/net/dev */
+} ValaPanelNetSample;
+
+/* Counters of one block device from /proc/diskstats */
+typedef struct
+{
+	char name[VALA_PANEL_SAMPLE_DISKNAME_SIZE];
+	guint64 reads;        /* Completed requests */
+	guint64 sectors_read; /* Of 512 bytes, whatever sector size device has */
+	guint64 writes;
+	guint64 sectors_written;
+	guint64 io_ticks;      /* Milliseconds which device had requests in flight */
+	guint64 time_in_queue; /* Milliseconds of all requests, so it grows faster under load */
+	guint dev;             /* Major and minor numbers */
+} ValaPanelDiskSample;
+
+/* Fields of /proc/[pid]/stat */
+typedef struct
+{
+	char comm[VALA_PANEL_SAMPLE_COMM_SIZE];
+	guint64 ticks;     /* User and system time, in clock ticks */
+	guint64 starttime; /* Clock ticks after boot, tells reused pids apart */
+	guint64 rss;       /* Resident pages, same as in statm */
+} ValaPanelPidSample;
+
+/* Counters of a cgroup v2 directory */
+typedef struct
+{
+	guint64 memory_current; /* Bytes */
+	guint64 memory_max;     /* Bytes, G_MAXUINT64 when unlimited */
+	guint64 memory_high;    /* Events: times usage went over memory.high and was throttled */
+	guint64 memory_limit;   /* Events: times usage was about to go over memory.max */
+	guint64 oom_kill;       /* Events: processes killed by OOM killer */
+	guint64 usage_usec;     /* Of all CPUs, from cpu.stat */
+	guint64 user_usec;
+	guint64 system_usec;
+	guint64 nr_periods; /* Enforcement periods of cpu.max, zero while unlimited */
+	guint64 nr_throttled;
+	guint64 throttled_usec;
+	double cpu_limit; /* CPUs granted by cpu.max, zero when unlimited */
+} ValaPanelCgroupSample;
+
+/* Pressure stall information resources, as named in /proc/pressure */
+typedef enum
+{
+	VALA_PANEL_PSI_CPU    = 0,
+	VALA_PANEL_PSI_MEMORY = 1,
+	VALA_PANEL_PSI_IO     = 2,
+	VALA_PANEL_PSI_N_RESOURCES
+} ValaPanelPsiResource;
+
+/* Cumulative stall time of one resource, in microseconds */
+typedef struct
+{
+	guint64 some_total; /* At least one task stalled */
+	guint64 full_total; /* All non-idle tasks stalled, zero for cpu on older kernels */
+} ValaPanelPsiSample;
+
+/**
+ * vala_panel_cpu_sample_load:
+ * @cpu: current sample
+ * @previous: earlier sample of the same CPU
+ * @states: (array fixed-size=6) (out caller-allocates) (nullable): share of every
+ * #ValaPanelCpuState in elapsed time
+ *
+ * Returns: share of elapsed time which CPU was busy, without I/O wait
+ */
+double vala_panel_cpu_sample_load(const ValaPanelCpuSample *cpu,
+                                  const ValaPanelCpuSample *previous, double *states);
+
+/*
+ * Kernel text file which stays open between samples. Every read is a
+ * pread() at offset 0 into a buffer allocated once on open, so sampling
+ * costs no open/close pair, no stdio buffering and no heap traffic.
+ */
+typedef struct
+{
+	int fd;
+	char *buf;   /* Always NUL-terminated after read */
+	size_t size; /* Capacity of buf, without terminator */
+	size_t len;  /* Length of last read */
+	bool grow;   /* Enlarge buf when file does not fit, instead of truncating */
+} ValaPanelProcFile;
+
+bool vala_panel_proc_file_open(ValaPanelProcFile *self, const char *path, size_t size,
+                               bool grow);
+bool vala_panel_proc_file_read(ValaPanelProcFile *self);
+void vala_panel_proc_file_close(ValaPanelProcFile *self);
+/**
+ * vala_panel_proc_file_open_trigger:
+ * @self: file to open
+ * @path: path of a /proc/pressure file
+ * @size: buffer size
+ * @trigger: PSI trigger, like "some 200000 2000000"
+ *
+ * Opens a pressure file for reading with a trigger armed on it. Then the
+ * descriptor becomes ready for POLLPRI when the stall threshold is crossed.
+ * Files which are not on procfs are never written to.
+ *
+ * Returns: %FALSE if trigger can not be armed, then @self stays closed
+ */
+bool vala_panel_proc_file_open_trigger(ValaPanelProcFile *self, const char *path, size_t size,
+                                       const char *trigger);
+
+/*
+ * Parsers. They only scan the given buffer and never allocate.
+ */
+bool vala_panel_proc_parse_stat(const char *buf, size_t len, ValaPanelCpuSample *cpu);
+bool vala_panel_proc_parse_meminfo(const char *buf, size_t len, ValaPanelMemSample *mem);
+bool vala_panel_proc_parse_pressure(const char *buf, size_t len, ValaPanelPsiSample *psi);
+/* Single number, as in sysfs attributes */
+bool vala_panel_proc_parse_int(const char *buf, size_t len, gint64 *value);
+bool vala_panel_proc_parse_pid_stat(const char *buf, size_t len, ValaPanelPidSample *pid);
+/* Cgroup v2 files, which leave fields they do not have untouched */
+bool vala_panel_proc_parse_limit(const char *buf, size_t len, guint64 *value);
+bool vala_panel_proc_parse_cpu_max(const char *buf, size_t len, double *cpus);
+bool vala_panel_proc_parse_memory_events(const char *buf, size_t len,
+                                         ValaPanelCgroupSample *cgroup);
+bool vala_panel_proc_parse_cpu_stat(const char *buf, size_t len, ValaPanelCgroupSample *cgroup);
+/**
+ * vala_panel_proc_parse_stat_cores:
+ * @buf: contents of /proc/stat
+ * @len: length of @buf
+ * @cpu: (out caller-allocates): aggregate counters
+ * @cores: (array length=n_cores) (out caller-allocates): storage for per-core counters
+ * @n_cores: capacity of @cores
+ *
+ * Parses the aggregate line and every "cpuN" line in one pass. Counters of
+ * core N go to @cores[N], offline cores are zeroed.
+ *
+ * Returns: number of cores, which may be more than @n_cores, or 0 on error
+ */
+uint vala_panel_proc_parse_stat_cores(const char *buf, size_t len, ValaPanelCpuSample *cpu,
+                                      ValaPanelCpuSample *cores, uint n_cores);
+/**
+ * vala_panel_proc_parse_net_dev:
+ * @buf: contents of /proc/net/dev
+ * @len: length of @buf
+ * @net: (array length=n_net) (out caller-allocates): storage for counters
+ * @n_net: capacity of @net
+ *
+ * Returns: total number of interfaces in @buf, which may be more than @n_net
+ */
+uint vala_panel_proc_parse_net_dev(const char *buf, size_t len, ValaPanelNetSample *net,
+                                   uint n_net);
+/* Same for /proc/diskstats, which lists partitions and virtual devices too */
+uint vala_panel_proc_parse_diskstats(const char *buf, size_t len, ValaPanelDiskSample *disks,
+                                     uint n_disks);
+
+/*
+ * Interfaces or disks picked from samples by name or by glob pattern, like
+ * "en*". Several patterns may be given, separated by commas. Positions of
+ * matches are kept until names in samples change, so a tick costs one pass
+ * over matching samples, however many others exist.
+ */
+typedef struct
+{
+	char *name;        /* Patterns as given */
+	char **patterns;   /* Split and stripped */
+	GArray *positions; /* Of matching samples, as uint */
+	guint digest;      /* Digest of samples positions come from */
+	uint n_samples;
+	GString *rows; /* Name, NUL and identity of every matching sample, in order */
+	bool valid;
+} ValaPanelSampleFilter;
+
+/**
+ * vala_panel_net_digest:
+ * @net: (array length=n_net): interface samples
+ * @n_net: length of @net
+ *
+ * Returns: hash of names and indices, which changes when interfaces appear,
+ * go away or get renamed, but not with their counters
+ */
+guint vala_panel_net_digest(const ValaPanelNetSample *net, uint n_net);
+guint vala_panel_disk_digest(const ValaPanelDiskSample *disks, uint n_disks);
+void vala_panel_sample_filter_init(ValaPanelSampleFilter *self, const char *patterns);
+void vala_panel_sample_filter_clear(ValaPanelSampleFilter *self);
+/**
+ * vala_panel_sample_filter_update_net:
+ * @self: a #ValaPanelSampleFilter
+ * @net: (array length=n_net): interface samples
+ * @n_net: length of @net
+ * @digest: vala_panel_net_digest() of @net
+ *
+ * Refreshes positions of matching interfaces, only if @digest has changed.
+ *
+ * Returns: %TRUE if interfaces which match are not the same as before
+ */
+bool vala_panel_sample_filter_update_net(ValaPanelSampleFilter *self,
+                                         const ValaPanelNetSample *net, uint n_net,
+                                         guint digest);
+/* Same for disks, with vala_panel_disk_digest() */
+bool vala_panel_sample_filter_update_disks(ValaPanelSampleFilter *self,
+                                           const ValaPanelDiskSample *disks, uint n_disks,
+                                           guint digest);
+
+G_END_DECLS
+
+#endif // PROCFS_H
@@ -0,0 +1,248 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "proctable.h"
+
+#define SCANNER_BATCH 64                    /* Processes read at once, well under a millisecond */
+#define SCANNER_SLICE 5000                  /* Pause between batches, in microseconds */
+#define SCANNER_PERIOD (2 * G_USEC_PER_SEC) /* Between starts of passes */
+
+/* Counters of one process from previous pass */
+typedef struct
+{
+	guint64 ticks;
+	guint64 starttime;
+	gint64 time;
+	guint generation;
+} ProcEntry;
+
+/*
+ * Table
+ */
+
+void vala_panel_proc_table_init(ValaPanelProcTable *self, const char *proc_root)
+{
+	memset(self, 0, sizeof(ValaPanelProcTable));
+	self->proc_root        = g_strdup(proc_root);
+	self->entries          = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+	self->ticks_per_second = (double)sysconf(_SC_CLK_TCK);
+	self->page_kb          = (guint64)sysconf(_SC_PAGESIZE) / 1024;
+}
+
+void vala_panel_proc_table_clear(ValaPanelProcTable *self)
+{
+	g_clear_pointer(&self->dir, closedir);
+	g_clear_pointer(&self->entries, g_hash_table_unref);
+	g_clear_pointer(&self->proc_root, g_free);
+}
+
+/* Keeps n largest values in order, which is cheap as n is tiny */
+static void top_insert(ValaPanelProcInfo *top, uint *n_top, const ValaPanelProcInfo *info,
+                       double key, bool by_cpu)
+{
+	uint i = *n_top;
+	while (i > 0 && key > (by_cpu ? top[i - 1].cpu : (double)top[i - 1].rss))
+		i--;
+	if (i == VALA_PANEL_PROC_TOP_SIZE)
+		return;
+	uint moved = MIN(*n_top, VALA_PANEL_PROC_TOP_SIZE - 1) - i;
+	memmove(&top[i + 1], &top[i], moved * sizeof(ValaPanelProcInfo));
+	top[i] = *info;
+	*n_top = MIN(*n_top + 1, VALA_PANEL_PROC_TOP_SIZE);
+}
+
+static bool read_pid(ValaPanelProcTable *self, int pid, ValaPanelPidSample *sample)
+{
+	char path[32];
+	g_snprintf(path, sizeof(path), "%d/stat", pid);
+	int fd = openat(dirfd(self->dir), path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+	ssize_t len;
+	while ((len = read(fd, self->buf, sizeof(self->buf) - 1)) < 0 && errno == EINTR)
+		;
+	close(fd);
+	return len > 0 && vala_panel_proc_parse_pid_stat(self->buf, (size_t)len, sample);
+}
+
+static void update_pid(ValaPanelProcTable *self, int pid)
+{
+	ValaPanelPidSample sample;
+	/* Exited since directory was listed */
+	if (!read_pid(self, pid, &sample))
+		return;
+	ValaPanelProcInfo info = { .pid = pid, .rss = sample.rss * self->page_kb };
+	ProcEntry *entry       = g_hash_table_lookup(self->entries, GINT_TO_POINTER(pid));
+	gint64 now             = g_get_monotonic_time();
+	memcpy(info.comm, sample.comm, sizeof(info.comm));
+	/* New process, or pid was reused, shows up in CPU top from next pass */
+	if (entry != NULL && entry->starttime == sample.starttime && now > entry->time &&
+	    sample.ticks >= entry->ticks)
+		info.cpu = (double)(sample.ticks - entry->ticks) / self->ticks_per_second /
+		           ((double)(now - entry->time) / G_USEC_PER_SEC);
+	if (entry == NULL)
+	{
+		entry = g_new(ProcEntry, 1);
+		g_hash_table_insert(self->entries, GINT_TO_POINTER(pid), entry);
+	}
+	entry->ticks      = sample.ticks;
+	entry->starttime  = sample.starttime;
+	entry->time       = now;
+	entry->generation = self->generation;
+	self->pass.n_processes++;
+	if (info.cpu > 0.0)
+		top_insert(self->pass.by_cpu, &self->pass.n_by_cpu, &info, info.cpu, true);
+	if (info.rss > 0)
+		top_insert(self->pass.by_rss, &self->pass.n_by_rss, &info, (double)info.rss, false);
+}
+
+static gboolean entry_is_stale(G_GNUC_UNUSED gpointer key, gpointer value, gpointer data)
+{
+	return ((ProcEntry *)value)->generation != GPOINTER_TO_UINT(data);
+}
+
+bool vala_panel_proc_table_step(ValaPanelProcTable *self, uint batch, ValaPanelProcTop *top)
+{
+	if (self->dir == NULL)
+	{
+		self->dir = opendir(self->proc_root);
+		if (self->dir == NULL)
+			return false;
+		memset(&self->pass, 0, sizeof(ValaPanelProcTop));
+		self->generation++;
+	}
+	struct dirent *ent;
+	for (uint i = 0; i < batch; i++)
+	{
+		if ((ent = readdir(self->dir)) == NULL)
+		{
+			/* Pass is over, forget processes which have exited */
+			g_clear_pointer(&self->dir, closedir);
+			g_hash_table_foreach_remove(self->entries,
+			                            entry_is_stale,
+			                            GUINT_TO_POINTER(self->generation));
+			self->pass.time = g_get_monotonic_time();
+			*top            = self->pass;
+			return true;
+		}
+		char *end;
+		long pid = strtol(ent->d_name, &end, 10);
+		if (*end == '\0' && pid > 0 && pid <= G_MAXINT)
+			update_pid(self, (int)pid);
+	}
+	return false;
+}
+
+/*
+ * Scanner
+ */
+
+struct _ValaPanelProcScanner
+{
+	ValaPanelProcTable table;
+	GThread *thread;
+	GMutex lock; /* Guards stopping only, results are passed without it */
+	GCond cond;
+	bool stopping;
+	ValaPanelProcTop *published; /* Accessed atomically */
+};
+
+/* Sleeps until @deadline, returns %TRUE if scanner should stop */
+static bool scanner_wait(ValaPanelProcScanner *self, gint64 deadline)
+{
+	g_mutex_lock(&self->lock);
+	while (!self->stopping && g_cond_wait_until(&self->cond, &self->lock, deadline))
+		;
+	bool stopping = self->stopping;
+	g_mutex_unlock(&self->lock);
+	return stopping;
+}
+
+/* Single producer and single consumer, so a swap is enough */
+static ValaPanelProcTop *scanner_exchange(ValaPanelProcScanner *self, ValaPanelProcTop *top)
+{
+	ValaPanelProcTop *old;
+	do
+		old = g_atomic_pointer_get(&self->published);
+	while (!g_atomic_pointer_compare_and_exchange(&self->published, old, top));
+	return old;
+}
+
+static gpointer scanner_thread(gpointer data)
+{
+	ValaPanelProcScanner *self = (ValaPanelProcScanner *)data;
+	ValaPanelProcTop top;
+	while (true)
+	{
+		gint64 start = g_get_monotonic_time();
+		bool done;
+		/* Pauses leave the CPU to others, however many processes there are */
+		while (!(done = vala_panel_proc_table_step(&self->table, SCANNER_BATCH, &top)) &&
+		       self->table.dir != NULL)
+			if (scanner_wait(self, g_get_monotonic_time() + SCANNER_SLICE))
+				return NULL;
+		/* Without procfs there is nothing to publish, it is tried again on next pass */
+		if (done)
+		{
+			ValaPanelProcTop *fresh = g_new(ValaPanelProcTop, 1);
+			*fresh                  = top;
+			g_free(scanner_exchange(self, fresh));
+		}
+		if (scanner_wait(self, start + SCANNER_PERIOD))
+			return NULL;
+	}
+}
+
+ValaPanelProcScanner *vala_panel_proc_scanner_start(const char *proc_root)
+{
+	ValaPanelProcScanner *self = g_new0(ValaPanelProcScanner, 1);
+	vala_panel_proc_table_init(&self->table, proc_root);
+	g_mutex_init(&self->lock);
+	g_cond_init(&self->cond);
+	self->thread = g_thread_new("proc-scanner", scanner_thread, self);
+	return self;
+}
+
+void vala_panel_proc_scanner_stop(ValaPanelProcScanner *self)
+{
+	g_mutex_lock(&self->lock);
+	self->stopping = true;
+	g_cond_signal(&self->cond);
+	g_mutex_unlock(&self->lock);
+	g_thread_join(self->thread);
+	g_free(scanner_exchange(self, NULL));
+	vala_panel_proc_table_clear(&self->table);
+	g_mutex_clear(&self->lock);
+	g_cond_clear(&self->cond);
+	g_free(self);
+}
+
+ValaPanelProcTop *vala_panel_proc_scanner_take(ValaPanelProcScanner *self)
+{
+	ValaPanelProcTop *top;
+	do
+		top = g_atomic_pointer_get(&self->published);
+	while (top != NULL && !g_atomic_pointer_compare_and_exchange(&self->published, top, NULL));
+	return top;
+}
@@ -0,0 +1,106 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROCTABLE_H
+#define PROCTABLE_H
+
+#include <dirent.h>
+#include <glib.h>
+#include <stdbool.h>
+
+#include "procfs.h"
+
+G_BEGIN_DECLS
+
+#define VALA_PANEL_PROC_TOP_SIZE 5
+
+/* One process as shown in tooltips */
+typedef struct
+{
+	int pid;
+	char comm[VALA_PANEL_SAMPLE_COMM_SIZE];
+	double cpu;  /* Share of one CPU since previous pass, so up to number of CPUs */
+	guint64 rss; /* Resident set, in kB */
+} ValaPanelProcInfo;
+
+/* Result of one pass over all processes, never changed once published */
+typedef struct
+{
+	gint64 time; /* Monotonic time when pass finished */
+	uint n_processes;
+	ValaPanelProcInfo by_cpu[VALA_PANEL_PROC_TOP_SIZE]; /* Busiest first */
+	uint n_by_cpu;
+	ValaPanelProcInfo by_rss[VALA_PANEL_PROC_TOP_SIZE]; /* Largest first */
+	uint n_by_rss;
+} ValaPanelProcTop;
+
+/*
+ * Processes under a procfs mount, keyed by pid, with counters of the
+ * previous pass. A pass reads /proc/[pid]/stat of every process, a batch
+ * at a time, so that it can be spread over time.
+ */
+typedef struct
+{
+	char *proc_root;
+	GHashTable *entries;   /* Of counters by pid, from previous pass */
+	DIR *dir;              /* Pass in progress, or %NULL */
+	ValaPanelProcTop pass; /* Result of pass in progress */
+	guint generation;      /* Of current pass, entries not seen in it are dropped */
+	double ticks_per_second;
+	guint64 page_kb;
+	char buf[1024]; /* Holds any /proc/[pid]/stat */
+} ValaPanelProcTable;
+
+void vala_panel_proc_table_init(ValaPanelProcTable *self, const char *proc_root);
+void vala_panel_proc_table_clear(ValaPanelProcTable *self);
+/**
+ * vala_panel_proc_table_step:
+ * @self: a #ValaPanelProcTable
+ * @batch: number of processes to read
+ * @top: (out caller-allocates): result, filled when pass is over
+ *
+ * Reads next @batch processes, starting a new pass if none is in progress.
+ *
+ * Returns: %TRUE if pass is over and @top is filled
+ */
+bool vala_panel_proc_table_step(ValaPanelProcTable *self, uint batch, ValaPanelProcTop *top);
+
+/*
+ * Worker thread which runs passes over a #ValaPanelProcTable, batch by
+ * batch with pauses between them, and publishes a fresh #ValaPanelProcTop
+ * after every pass.
+ */
+typedef struct _ValaPanelProcScanner ValaPanelProcScanner;
+
+ValaPanelProcScanner *vala_panel_proc_scanner_start(const char *proc_root);
+/* Blocks until current batch is over, then frees @self */
+void vala_panel_proc_scanner_stop(ValaPanelProcScanner *self);
+/**
+ * vala_panel_proc_scanner_take:
+ * @self: a #ValaPanelProcScanner
+ *
+ * Takes latest result, without locking. Results which were published and
+ * not taken are dropped by the scanner.
+ *
+ * Returns: (transfer full) (nullable): result published since previous call
+ */
+ValaPanelProcTop *vala_panel_proc_scanner_take(ValaPanelProcScanner *self);
+
+G_END_DECLS
+
+#endif // PROCTABLE_H
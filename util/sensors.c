@@ -0,0 +1,229 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sensors.h"
+
+#define SENSOR_BUFFER_SIZE 32 /* Holds any number sysfs prints */
+#define MAX_CPUS 8192         /* As NR_CPUS of biggest kernel configs */
+
+/*
+ * Scanning
+ */
+
+/* Reads an attribute which is needed only once, like a limit or a label */
+static char *read_attribute(const char *dir, const char *name)
+{
+	g_autofree char *path = g_build_filename(dir, name, NULL);
+	char *contents        = NULL;
+	if (!g_file_get_contents(path, &contents, NULL, NULL))
+		return NULL;
+	return g_strstrip(contents);
+}
+
+static gint64 read_attribute_int(const char *dir, const char *name, gint64 fallback)
+{
+	g_autofree char *contents = read_attribute(dir, name);
+	gint64 value;
+	if (contents == NULL || !vala_panel_proc_parse_int(contents, strlen(contents), &value))
+		return fallback;
+	return value;
+}
+
+/* Fills paths of cpufreq directories, indexed by CPU number, with gaps left NULL */
+static void scan_cpus(const char *root, GPtrArray *paths)
+{
+	g_autofree char *cpu_dir = g_build_filename(root, "devices", "system", "cpu", NULL);
+	g_autoptr(GDir) dir      = g_dir_open(cpu_dir, 0, NULL);
+	const char *name;
+	while (dir != NULL && (name = g_dir_read_name(dir)) != NULL)
+	{
+		char *end;
+		if (!g_str_has_prefix(name, "cpu") || !g_ascii_isdigit(name[3]))
+			continue;
+		guint64 cpu = g_ascii_strtoull(name + 3, &end, 10);
+		if (*end != '\0' || cpu >= MAX_CPUS)
+			continue;
+		char *path = g_build_filename(cpu_dir, name, "cpufreq", NULL);
+		if (!g_file_test(path, G_FILE_TEST_IS_DIR))
+		{
+			g_free(path);
+			continue;
+		}
+		if (cpu >= paths->len)
+			g_ptr_array_set_size(paths, (int)cpu + 1);
+		g_free(paths->pdata[cpu]);
+		paths->pdata[cpu] = path;
+	}
+}
+
+static int compare_names(const void *a, const void *b)
+{
+	return g_strcmp0(*(const char *const *)a, *(const char *const *)b);
+}
+
+static int compare_uints(const void *a, const void *b)
+{
+	uint x = *(const uint *)a, y = *(const uint *)b;
+	return (x > y) - (x < y);
+}
+
+/* Appends every tempN_input of one chip, in order of N */
+static void scan_chip(const char *chip_dir, const char *fallback_name, GArray *temps,
+                      GPtrArray *paths)
+{
+	g_autofree char *chip = read_attribute(chip_dir, "name");
+	g_autoptr(GArray) inputs = g_array_new(false, false, sizeof(uint));
+	g_autoptr(GDir) dir      = g_dir_open(chip_dir, 0, NULL);
+	const char *name;
+	while (dir != NULL && (name = g_dir_read_name(dir)) != NULL)
+	{
+		char *end;
+		if (!g_str_has_prefix(name, "temp") || !g_ascii_isdigit(name[4]))
+			continue;
+		uint input = (uint)g_ascii_strtoull(name + 4, &end, 10);
+		if (!g_strcmp0(end, "_input"))
+			g_array_append_val(inputs, input);
+	}
+	g_array_sort(inputs, compare_uints);
+	for (uint i = 0; i < inputs->len; i++)
+	{
+		uint input                  = g_array_index(inputs, uint, i);
+		g_autofree char *label_name = g_strdup_printf("temp%u_label", input);
+		g_autofree char *crit_name  = g_strdup_printf("temp%u_crit", input);
+		g_autofree char *label      = read_attribute(chip_dir, label_name);
+		ValaPanelTempSample temp    = { 0 };
+		gint64 critical             = read_attribute_int(chip_dir, crit_name, 0);
+		const char *prefix          = chip != NULL ? chip : fallback_name;
+		/* Unlabeled inputs are told apart by number */
+		if (label != NULL)
+			g_snprintf(temp.label, sizeof(temp.label), "%s %s", prefix, label);
+		else
+			g_snprintf(temp.label, sizeof(temp.label), "%s temp%u", prefix, input);
+		temp.critical = VALA_PANEL_SENSOR_DEFAULT_CRITICAL;
+		if (critical > 0)
+			temp.critical = critical / 1000.0;
+		g_array_append_val(temps, temp);
+		g_ptr_array_add(paths, g_strdup_printf("%s/temp%u_input", chip_dir, input));
+	}
+}
+
+static void scan_hwmon(const char *root, GArray *temps, GPtrArray *paths)
+{
+	g_autofree char *class_dir = g_build_filename(root, "class", "hwmon", NULL);
+	g_autoptr(GDir) dir        = g_dir_open(class_dir, 0, NULL);
+	g_autoptr(GPtrArray) chips = g_ptr_array_new_with_free_func(g_free);
+	const char *name;
+	while (dir != NULL && (name = g_dir_read_name(dir)) != NULL)
+		g_ptr_array_add(chips, g_strdup(name));
+	/* Directory order is arbitrary, sensors should keep their places between scans */
+	g_ptr_array_sort(chips, compare_names);
+	for (uint i = 0; i < chips->len; i++)
+	{
+		const char *chip          = g_ptr_array_index(chips, i);
+		g_autofree char *chip_dir = g_build_filename(class_dir, chip, NULL);
+		scan_chip(chip_dir, chip, temps, paths);
+	}
+}
+
+/*
+ * Sensors
+ */
+
+bool vala_panel_sensors_open(ValaPanelSensors *self, const char *root)
+{
+	g_autoptr(GPtrArray) freq_paths = g_ptr_array_new_with_free_func(g_free);
+	g_autoptr(GPtrArray) temp_paths = g_ptr_array_new_with_free_func(g_free);
+	GArray *temps = g_array_new(false, true, sizeof(ValaPanelTempSample));
+	scan_cpus(root, freq_paths);
+	scan_hwmon(root, temps, temp_paths);
+	if (freq_paths->len == 0 && temps->len == 0)
+	{
+		g_array_unref(temps);
+		return false;
+	}
+	self->n_freqs = freq_paths->len;
+	self->n_temps = temps->len;
+	self->freqs   = g_new0(ValaPanelFreqSample, self->n_freqs);
+	self->temps   = (ValaPanelTempSample *)(void *)g_array_free(temps, false);
+	self->files   = g_new0(ValaPanelProcFile, self->n_freqs + self->n_temps);
+	for (uint i = 0; i < self->n_freqs; i++)
+	{
+		const char *cpufreq = g_ptr_array_index(freq_paths, i);
+		self->files[i].fd   = -1;
+		if (cpufreq == NULL)
+			continue;
+		g_autofree char *path = g_build_filename(cpufreq, "scaling_cur_freq", NULL);
+		vala_panel_proc_file_open(&self->files[i], path, SENSOR_BUFFER_SIZE, false);
+		self->freqs[i].max_khz = (guint64)MAX(read_attribute_int(cpufreq,
+		                                                         "cpuinfo_max_freq",
+		                                                         0),
+		                                      0);
+	}
+	for (uint i = 0; i < self->n_temps; i++)
+	{
+		ValaPanelProcFile *file = &self->files[self->n_freqs + i];
+		file->fd                = -1;
+		vala_panel_proc_file_open(file,
+		                          g_ptr_array_index(temp_paths, i),
+		                          SENSOR_BUFFER_SIZE,
+		                          false);
+	}
+	return true;
+}
+
+bool vala_panel_sensors_read(ValaPanelSensors *self)
+{
+	bool ok = true;
+	for (uint i = 0; i < self->n_freqs; i++)
+	{
+		ValaPanelProcFile *file = &self->files[i];
+		gint64 khz              = 0;
+		/* Offline CPUs refuse reads, and come back with the same file */
+		if (file->fd >= 0 && vala_panel_proc_file_read(file))
+			vala_panel_proc_parse_int(file->buf, file->len, &khz);
+		self->freqs[i].khz = (guint64)MAX(khz, 0);
+	}
+	for (uint i = 0; i < self->n_temps; i++)
+	{
+		ValaPanelProcFile *file = &self->files[self->n_freqs + i];
+		gint64 millidegrees;
+		if (file->fd < 0)
+			continue;
+		/* Sleeping devices fail reads for a while, removed ones for good */
+		if (!vala_panel_proc_file_read(file))
+			ok = ok && errno != ENODEV;
+		else if (vala_panel_proc_parse_int(file->buf, file->len, &millidegrees))
+			self->temps[i].celsius = millidegrees / 1000.0;
+	}
+	return ok;
+}
+
+void vala_panel_sensors_close(ValaPanelSensors *self)
+{
+	for (uint i = 0; self->files != NULL && i < self->n_freqs + self->n_temps; i++)
+		vala_panel_proc_file_close(&self->files[i]);
+	g_clear_pointer(&self->files, g_free);
+	g_clear_pointer(&self->freqs, g_free);
+	g_clear_pointer(&self->temps, g_free);
+	self->n_freqs = 0;
+	self->n_temps = 0;
+}
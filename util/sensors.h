@@ -0,0 +1,86 @@
+/*
+ * vala-panel
+ * Copyright (C) 2018 Konstantin Pugin <ria.freelander@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SENSORS_H
+#define SENSORS_H
+
+#include <glib.h>
+#include <stdbool.h>
+
+#include "procfs.h"
+
+G_BEGIN_DECLS
+
+#define VALA_PANEL_SENSOR_LABEL_SIZE 48
+#define VALA_PANEL_SENSOR_DEFAULT_CRITICAL 100.0 /* Celsius, if sensor does not tell */
+
+/* Clock of one CPU, from cpufreq */
+typedef struct
+{
+	guint64 khz;     /* scaling_cur_freq, zero if CPU has no cpufreq or is offline */
+	guint64 max_khz; /* cpuinfo_max_freq */
+} ValaPanelFreqSample;
+
+/* One hwmon temperature input */
+typedef struct
+{
+	char label[VALA_PANEL_SENSOR_LABEL_SIZE]; /* Chip, then input, like "coretemp Core 0" */
+	double celsius;
+	double critical; /* Celsius */
+} ValaPanelTempSample;
+
+/*
+ * CPU clock and temperature files found under a sysfs root, like /sys. All
+ * of them are opened on scan and stay open, so a read is one pread() per
+ * file instead of an open/read/close triple per file on every tick.
+ *
+ * Limits and labels do not change, they are read only once on scan.
+ */
+typedef struct
+{
+	ValaPanelProcFile *files; /* Clock files by CPU number, then temperature inputs */
+	ValaPanelFreqSample *freqs;
+	uint n_freqs; /* Highest CPU number with cpufreq, plus one */
+	ValaPanelTempSample *temps;
+	uint n_temps;
+} ValaPanelSensors;
+
+/**
+ * vala_panel_sensors_open:
+ * @self: sensors to scan
+ * @root: sysfs mount point, or a fixture tree which looks like it
+ *
+ * Returns: %FALSE if there is neither cpufreq nor any hwmon temperature,
+ * then @self stays closed
+ */
+bool vala_panel_sensors_open(ValaPanelSensors *self, const char *root);
+/**
+ * vala_panel_sensors_read:
+ * @self: open sensors
+ *
+ * Rereads every file in place. CPUs which went offline read as zero.
+ *
+ * Returns: %FALSE if some temperature input went away, then sensors should
+ * be scanned again
+ */
+bool vala_panel_sensors_read(ValaPanelSensors *self);
+void vala_panel_sensors_close(ValaPanelSensors *self);
+
+G_END_DECLS
+
+#endif // SENSORS_H
@@ -22,6 +22,8 @@
 #include "boxed-wrapper.h"
 #include "constants.h"
 #include "glistmodel-filter.h"
+#include "history.h"
 #include "misc.h"
+#include "procfs.h"
 
 #endif